@@ -65,21 +65,27 @@ namespace org {
                 class DefaultErrorStrategy;
                 class DiagnosticErrorListener;
                 class FailedPredicateException;
+                class IncrementalReparser;
+                class IncrementalTokenStream;
                 class InputMismatchException;
                 class IntStream;
                 class InterpreterRuleContext;
                 class Lexer;
                 class LexerInterpreter;
                 class LexerNoViableAltException;
+                class LexerSnapshot;
                 class ListTokenSource;
                 class NoViableAltException;
                 class Parser;
                 class ParserInterpreter;
                 class ParserRuleContext;
                 class ProxyErrorListener;
+                class ReadAheadCharStream;
+                class ReadAheadTokenSource;
                 class RecognitionException;
                 template<typename T1, typename T2> class Recognizer;
                 class RuleContext;
+                class RuleMemoTable;
                 class Token;
                 template<typename Symbol> class TokenFactory;
                 class TokenSource;
@@ -108,6 +114,7 @@ namespace org {
                     class ObjectEqualityComparator;
                     template<typename T> class OrderedHashSet;
                     class ParseCancellationException;
+                    template<typename T> class RingBuffer;
                     class TestRig;
                     class Utils;
                 }
@@ -117,6 +124,7 @@ namespace org {
                     class ATNConfigSet;
                     class ATNDeserializationOptions;
                     class ATNDeserializer;
+                    class ATNImage;
                     class ATNSerializer;
                     class ATNSimulator;
                     class ATNState;
@@ -129,12 +137,16 @@ namespace org {
                     class BasicState;
                     class BlockEndState;
                     class BlockStartState;
+                    class ClosureBusySet;
                     class DecisionState;
                     class EmptyPredictionContext;
                     class EpsilonTransition;
                     class LL1Analyzer;
                     class LexerATNConfig;
+                    class LexerATNConfigPool;
                     class LexerATNSimulator;
+                    class LexerAction;
+                    class LexerActionExecutor;
                     class LoopEndState;
                     class NotSetTransition;
                     class OrderedATNConfigSet;
@@ -143,6 +155,8 @@ namespace org {
                     class PlusLoopbackState;
                     class PrecedencePredicateTransition;
                     class PredicateTransition;
+                    class PredictionBudget;
+                    class PredictionBudgetExceededException;
                     class PredictionContext;
                     class PredictionContextCache;
                     enum class PredictionMode;
@@ -162,8 +176,11 @@ namespace org {
                 }
                 namespace dfa {
                     class DFA;
+                    class DFAEdgeMap;
+                    class DFAEvictionPolicy;
                     class DFASerializer;
                     class DFAState;
+                    class LexerDFATable;
                     class LexerDFASerializer;
                 }
                 namespace tree {
@@ -176,6 +193,7 @@ namespace org {
                     template<typename T> class ParseTreeVisitor;
                     class ParseTreeWalker;
                     class RuleNode;
+                    class StreamingParseListener;
                     class SyntaxTree;
                     class TerminalNode;
                     class TerminalNodeImpl;
@@ -171,15 +171,24 @@ namespace org {
                         p = index; // just jump; don't update stream state (line, ...)
                         return;
                     }
-                    // seek forward, consume until p hits index
-                    while (p < index && index < n) {
-                        consume();
+                    // seek forward; consume() does nothing but advance p
+                    if (index < n) {
+                        p = index;
                     }
                 }
 
-                std::wstring ANTLRInputStream::getText(Interval *interval) {
-                    int start = interval->a;
-                    int stop = interval->b;
+                const wchar_t *ANTLRInputStream::getBuffer(size_t *available) {
+                    if (p >= n) {
+                        *available = 0;
+                        return nullptr;
+                    }
+                    *available = n - p;
+                    return data.data() + p;
+                }
+
+                std::wstring ANTLRInputStream::getText(Interval interval) {
+                    int start = interval.a;
+                    int stop = interval.b;
                     if (stop >= n) {
                         stop = n - 1;
                     }
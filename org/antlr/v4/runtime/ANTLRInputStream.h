@@ -129,7 +129,9 @@ namespace org {
                     /// </summary>
                     virtual void seek(int index) override;
 
-                    virtual std::wstring getText(misc::Interval *interval) override;
+                    virtual std::wstring getText(misc::Interval interval) override;
+
+                    virtual const wchar_t *getBuffer(size_t *available) override;
 
                     virtual std::string getSourceName() override;
 
@@ -5,6 +5,7 @@
 #include "StringBuilder.h"
 
 #include <assert.h>
+#include <sstream>
 
 /*
  * [The "BSD license"]
@@ -349,26 +350,30 @@ namespace org {
                     return getText(misc::Interval::of(0,size() - 1));
                 }
 
-                std::wstring BufferedTokenStream::getText(misc::Interval *interval) {
-                    int start = interval->a;
-                    int stop = interval->b;
+                std::wstring BufferedTokenStream::getText(misc::Interval interval) {
+                    std::wstringstream buf;
+                    getText(interval, buf);
+                    return buf.str();
+                }
+
+                void BufferedTokenStream::getText(misc::Interval interval, std::wostream &out) {
+                    int start = interval.a;
+                    int stop = interval.b;
                     if (start < 0 || stop < 0) {
-                        return L"";
+                        return;
                     }
                     lazyInit();
-                    if (stop >= tokens.size()) {
-                        stop = tokens.size() - 1;
+                    if (stop >= (int)tokens.size()) {
+                        stop = (int)tokens.size() - 1;
                     }
 
-                    StringBuilder *buf = new StringBuilder();
                     for (int i = start; i <= stop; i++) {
                         Token *t = tokens[i];
                         if (t->getType() == Token::_EOF) {
                             break;
                         }
-                        buf->append(t->getText());
+                        out << t->getText();
                     }
-                    return buf->toString();
                 }
 
                 std::wstring BufferedTokenStream::getText(RuleContext *ctx) {
@@ -10,6 +10,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <iostream>
 
 /*
  * [The "BSD license"]
@@ -220,7 +221,13 @@ namespace org {
                     virtual std::string getSourceName() override;
                     virtual std::wstring getText() override;
 
-                    virtual std::wstring getText(misc::Interval *interval) override;
+                    virtual std::wstring getText(misc::Interval interval) override;
+
+                    /// <summary>
+                    /// Write the text of the tokens in interval to out one token at a time
+                    ///  instead of concatenating them into a string first.
+                    /// </summary>
+                    virtual void getText(misc::Interval interval, std::wostream &out);
 
                     virtual std::wstring getText(RuleContext *ctx) override;
 
@@ -5,6 +5,11 @@ namespace org {
         namespace v4 {
             namespace runtime {
 
+                const wchar_t *CharStream::getBuffer(size_t *available) {
+                    *available = 0;
+                    return nullptr;
+                }
+
             }
         }
     }
@@ -1,6 +1,8 @@
 ﻿#pragma once
 
+#include <cstddef>
 #include "IntStream.h"
+#include "Interval.h"
 #include "Declarations.h"
 
 /*
@@ -57,7 +59,19 @@ namespace org {
                     /// <exception cref="UnsupportedOperationException"> if the stream does not support
                     /// getting the text of the specified interval </exception>
                 public:
-                    virtual std::wstring getText(misc::Interval *interval) = 0;
+                    virtual std::wstring getText(misc::Interval interval) = 0;
+
+                    /// <summary>
+                    /// Gives direct access to the characters from <seealso cref="#index"/> on,
+                    /// for streams that hold them in memory. The lexer uses this to scan long
+                    /// runs of characters without a call per character.
+                    /// </summary>
+                    /// <param name="available"> receives the number of characters readable
+                    /// through the returned pointer </param>
+                    /// <returns> the character at <seealso cref="#index"/>, or {@code null} if the
+                    /// stream has no such buffer or is at EOF. The pointer is only valid until
+                    /// the stream is next modified. </returns>
+                    virtual const wchar_t *getBuffer(size_t *available);
 
                     virtual ~CharStream() = 0;
                 };
@@ -0,0 +1,152 @@
+﻿#include "IncrementalReparser.h"
+#include "IncrementalTokenStream.h"
+#include "Parser.h"
+#include "ParserRuleContext.h"
+#include "ANTLRErrorStrategy.h"
+#include "ATN.h"
+#include "RuleStartState.h"
+#include "StreamingParseListener.h"
+
+#include <algorithm>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                IncrementalReparser::IncrementalReparser(Parser *parser, IncrementalTokenStream *tokens, RuleInvoker invokeRule) : parser(parser), tokens(tokens), invokeRule(invokeRule) {
+                }
+
+                ParserRuleContext *IncrementalReparser::reparse(ParserRuleContext *root, CharStream *input, int editStart, int removedLength, int insertedLength) {
+                    misc::Interval damaged = tokens->relex(input, editStart, removedLength, insertedLength);
+
+                    ParserRuleContext *result = nullptr;
+                    std::vector<ParserRuleContext*> path = enclosingPath(root, damaged.a, damaged.b);
+                    for (std::vector<ParserRuleContext*>::reverse_iterator it = path.rbegin(); it != path.rend(); ++it) {
+                        if (canReparse(*it) && reparseRule(*it)) {
+                            result = root;
+                            break;
+                        }
+                    }
+                    if (result == nullptr) {
+                        result = reparseAll(root);
+                    }
+
+                    tokens->releaseRetiredTokens();
+                    return result;
+                }
+
+                std::vector<ParserRuleContext*> IncrementalReparser::enclosingPath(ParserRuleContext *root, int a, int b) {
+                    std::vector<ParserRuleContext*> path;
+                    ParserRuleContext *ctx = encloses(root, a, b) ? root : nullptr;
+                    while (ctx != nullptr) {
+                        path.push_back(ctx);
+                        ParserRuleContext *next = nullptr;
+                        for (tree::ParseTree *child : ctx->children) {
+                            ParserRuleContext *childCtx = dynamic_cast<ParserRuleContext*>(child);
+                            if (childCtx != nullptr && encloses(childCtx, a, b)) {
+                                next = childCtx;
+                                break;
+                            }
+                        }
+                        ctx = next;
+                    }
+                    return path;
+                }
+
+                bool IncrementalReparser::encloses(ParserRuleContext *ctx, int a, int b) {
+                    // a token of margin on either side covers the parser's own lookahead
+                    // at the boundaries of the relexed region
+                    return ctx->start != nullptr && ctx->stop != nullptr && tokens->isLive(ctx->start) && tokens->isLive(ctx->stop) && ctx->start->getTokenIndex() < a && ctx->stop->getTokenIndex() > b;
+                }
+
+                bool IncrementalReparser::canReparse(ParserRuleContext *ctx) {
+                    if (ctx->getParent() == nullptr || ctx->invokingState < 0) {
+                        return false;
+                    }
+                    return !parser->getATN()->ruleToStartState[ctx->getRuleIndex()]->isPrecedenceRule;
+                }
+
+                bool IncrementalReparser::reparseRule(ParserRuleContext *ctx) {
+                    ParserRuleContext *parent = ctx->getParent();
+                    Token *stop = ctx->stop;
+
+                    tokens->seek(ctx->start->getTokenIndex());
+                    parser->getErrorHandler()->reset(parser);
+                    parser->setContext(parent);
+                    parser->setState(ctx->invokingState);
+
+                    // the attempt may be thrown away, so its errors are only reported
+                    // once it is spliced in
+                    parser->holdSyntaxErrors();
+                    ParserRuleContext *result;
+                    try {
+                        result = invokeRule(ctx->getRuleIndex());
+                    } catch (...) {
+                        parser->releaseSyntaxErrors(false);
+                        parser->setContext(nullptr);
+                        throw;
+                    }
+                    parser->setContext(nullptr);
+
+                    // a rule adds its context to the parent's children when it is entered
+                    if (!parent->children.empty() && parent->children.back() == result) {
+                        parent->removeLastChild();
+                    }
+
+                    if (result->stop != stop || result->exception != nullptr) {
+                        parser->releaseSyntaxErrors(false);
+                        tree::StreamingParseListener::release(result);
+                        return false;
+                    }
+
+                    parser->releaseSyntaxErrors(true);
+
+                    std::replace(parent->children.begin(), parent->children.end(), static_cast<tree::ParseTree*>(ctx), static_cast<tree::ParseTree*>(result));
+                    tree::StreamingParseListener::release(ctx);
+                    return true;
+                }
+
+                ParserRuleContext *IncrementalReparser::reparseAll(ParserRuleContext *root) {
+                    int ruleIndex = root->getRuleIndex();
+                    parser->setContext(nullptr);
+                    parser->reset();
+                    ParserRuleContext *result = invokeRule(ruleIndex);
+                    tree::StreamingParseListener::release(root);
+                    return result;
+                }
+
+            }
+        }
+    }
+}
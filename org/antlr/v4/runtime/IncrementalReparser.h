@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                /// <summary>
+                /// Updates a parse tree after an edit to the text it was parsed from,
+                ///  reparsing only the smallest rule that encloses the change.
+                /// <p/>
+                /// The tokens are brought up to date by <seealso cref="IncrementalTokenStream#relex"/>.
+                ///  The reparser then walks down from the root to the deepest rule
+                ///  context whose start and stop tokens both survived the edit and lie
+                ///  strictly outside the relexed tokens, and runs that rule again from
+                ///  its start token with the same parent context and invoking state it
+                ///  was entered with the first time. If the new subtree ends on the
+                ///  same token as the old one, it takes the old one's place among its
+                ///  parent's children and every other subtree is kept as is. Otherwise
+                ///  the next enclosing rule is tried, up to the root.
+                /// <p/>
+                /// Rules are invoked through a <seealso cref="RuleInvoker"/> since the runtime
+                ///  cannot call a generated rule method by index; for a generated parser
+                ///  it is a switch over the rule indexes calling the matching method.
+                ///  Left-recursive rules are never reparsed on their own: re-entering one
+                ///  needs the precedence it was invoked with, which the context does not
+                ///  record, so the enclosing rule is reparsed instead.
+                /// <p/>
+                /// The parser must be reading from the same stream that is handed in
+                ///  here. Decisions taken in the enclosing rules before the reparsed
+                ///  rule was entered are not revisited; a grammar whose choice of
+                ///  alternative depends on tokens inside a rule it then invokes may need
+                ///  a full parse.
+                /// </summary>
+                class IncrementalReparser {
+                public:
+                    typedef std::function<ParserRuleContext*(int ruleIndex)> RuleInvoker;
+
+                protected:
+                    Parser *const parser;
+                    IncrementalTokenStream *const tokens;
+                    const RuleInvoker invokeRule;
+
+                public:
+                    IncrementalReparser(Parser *parser, IncrementalTokenStream *tokens, RuleInvoker invokeRule);
+
+                    virtual ~IncrementalReparser() {}
+
+                    /// <summary>
+                    /// Relexes the token stream for the edit described as in
+                    ///  <seealso cref="IncrementalTokenStream#relex"/> and updates {@code root}
+                    ///  to match. Returns the root of the updated tree, which is
+                    ///  {@code root} itself unless the whole input had to be parsed again.
+                    ///  Replaced subtrees and tokens are deleted.
+                    /// </summary>
+                    virtual ParserRuleContext *reparse(ParserRuleContext *root, CharStream *input, int editStart, int removedLength, int insertedLength);
+
+                protected:
+                    /// <summary>
+                    /// Returns the rule contexts from the root down to the deepest one
+                    ///  whose span strictly encloses the tokens {@code a..b}.
+                    /// </summary>
+                    virtual std::vector<ParserRuleContext*> enclosingPath(ParserRuleContext *root, int a, int b);
+
+                    virtual bool encloses(ParserRuleContext *ctx, int a, int b);
+
+                    virtual bool canReparse(ParserRuleContext *ctx);
+
+                    /// <summary>
+                    /// Parses {@code ctx}'s rule again and splices the result in place of
+                    ///  {@code ctx}. Returns {@code false}, leaving the tree unchanged, if
+                    ///  the new subtree doesn't end where the old one did. Syntax errors
+                    ///  are held back during the attempt and reported only if it is kept.
+                    /// </summary>
+                    virtual bool reparseRule(ParserRuleContext *ctx);
+
+                    virtual ParserRuleContext *reparseAll(ParserRuleContext *root);
+                };
+
+            }
+        }
+    }
+}
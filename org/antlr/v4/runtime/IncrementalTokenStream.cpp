@@ -0,0 +1,181 @@
+﻿#include "IncrementalTokenStream.h"
+#include "Lexer.h"
+#include "LexerATNSimulator.h"
+#include "CommonToken.h"
+#include "CharStream.h"
+
+#include <algorithm>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                IncrementalTokenStream::IncrementalTokenStream(Lexer *lexer) : CommonTokenStream(lexer), lexer(lexer) {
+                }
+
+                IncrementalTokenStream::IncrementalTokenStream(Lexer *lexer, int channel) : CommonTokenStream(lexer, channel), lexer(lexer) {
+                }
+
+                IncrementalTokenStream::~IncrementalTokenStream() {
+                    releaseRetiredTokens();
+                }
+
+                int IncrementalTokenStream::fetch(int n) {
+                    if (fetchedEOF) {
+                        return 0;
+                    }
+
+                    for (int i = 0; i < n; i++) {
+                        snapshots.push_back(lexer->snapshot());
+                        lexer->getInterpreter()->clearLookahead();
+                        Token *t = lexer->nextToken();
+                        // deciding where a token ends always takes a look at the char after it
+                        lookaheadEnds.push_back(std::max(lexer->getInterpreter()->getLookaheadEnd(), t->getStopIndex() + 1));
+
+                        if (dynamic_cast<WritableToken*>(t) != nullptr) {
+                            (static_cast<WritableToken*>(t))->setTokenIndex(tokens.size());
+                        }
+                        tokens.push_back(t);
+                        if (t->getType() == Token::_EOF) {
+                            fetchedEOF = true;
+                            return i + 1;
+                        }
+                    }
+
+                    return n;
+                }
+
+                size_t IncrementalTokenStream::firstDamaged(int editStart) {
+                    // the token the edit falls into, or the one right after it ...
+                    std::vector<LexerSnapshot>::iterator it = std::upper_bound(snapshots.begin(), snapshots.end(), editStart, [](int index, const LexerSnapshot &s) {
+                        return index < s.charIndex;
+                    });
+                    size_t first = it == snapshots.begin() ? 0 : (size_t)(it - snapshots.begin()) - 1;
+
+                    // ... moved back over every token whose lookahead reached into it
+                    while (first > 0 && lookaheadEnds[first - 1] >= editStart) {
+                        first--;
+                    }
+                    return first;
+                }
+
+                misc::Interval IncrementalTokenStream::relex(CharStream *input, int editStart, int removedLength, int insertedLength) {
+                    fill();
+
+                    const int delta = insertedLength - removedLength;
+                    const int insertedEnd = editStart + insertedLength;
+                    const size_t first = firstDamaged(editStart);
+
+                    std::vector<Token*> freshTokens;
+                    std::vector<LexerSnapshot> freshSnapshots;
+                    std::vector<int> freshLookaheadEnds;
+
+                    lexer->restore(input, snapshots[first]);
+                    size_t resume = tokens.size();
+                    int lineDelta = 0;
+                    size_t k = first;
+                    while (true) {
+                        LexerSnapshot here = lexer->snapshot();
+
+                        // past the edit the text is the old text shifted by delta; meeting a
+                        // known token boundary in the same state means the rest matches too
+                        if (here.charIndex >= insertedEnd) {
+                            int oldIndex = here.charIndex - delta;
+                            while (k < snapshots.size() && snapshots[k].charIndex < oldIndex) {
+                                k++;
+                            }
+                            if (k < snapshots.size() && snapshots[k].charIndex == oldIndex && snapshots[k].hasSameState(here)) {
+                                resume = k;
+                                lineDelta = here.line - snapshots[k].line;
+                                break;
+                            }
+                        }
+
+                        lexer->getInterpreter()->clearLookahead();
+                        Token *t = lexer->nextToken();
+                        freshSnapshots.push_back(here);
+                        freshLookaheadEnds.push_back(std::max(lexer->getInterpreter()->getLookaheadEnd(), t->getStopIndex() + 1));
+                        freshTokens.push_back(t);
+                        if (t->getType() == Token::_EOF) {
+                            break;
+                        }
+                    }
+
+                    for (size_t i = resume; i < tokens.size(); i++) {
+                        CommonToken *t = dynamic_cast<CommonToken*>(tokens[i]);
+                        if (t != nullptr) {
+                            t->setStartIndex(t->getStartIndex() + delta);
+                            t->setStopIndex(t->getStopIndex() + delta);
+                            t->setLine(t->getLine() + lineDelta);
+                        }
+                        snapshots[i].charIndex += delta;
+                        snapshots[i].line += lineDelta;
+                        lookaheadEnds[i] += delta;
+                    }
+
+                    retired.insert(retired.end(), tokens.begin() + first, tokens.begin() + resume);
+                    tokens.erase(tokens.begin() + first, tokens.begin() + resume);
+                    tokens.insert(tokens.begin() + first, freshTokens.begin(), freshTokens.end());
+                    snapshots.erase(snapshots.begin() + first, snapshots.begin() + resume);
+                    snapshots.insert(snapshots.begin() + first, freshSnapshots.begin(), freshSnapshots.end());
+                    lookaheadEnds.erase(lookaheadEnds.begin() + first, lookaheadEnds.begin() + resume);
+                    lookaheadEnds.insert(lookaheadEnds.begin() + first, freshLookaheadEnds.begin(), freshLookaheadEnds.end());
+
+                    for (size_t i = first; i < tokens.size(); i++) {
+                        if (dynamic_cast<WritableToken*>(tokens[i]) != nullptr) {
+                            (static_cast<WritableToken*>(tokens[i]))->setTokenIndex((int)i);
+                        }
+                    }
+
+                    fetchedEOF = true;
+                    p = -1;
+                    return misc::Interval((int)first, (int)(first + freshTokens.size()) - 1);
+                }
+
+                bool IncrementalTokenStream::isLive(Token *t) {
+                    int i = t->getTokenIndex();
+                    return i >= 0 && i < (int)tokens.size() && tokens[i] == t;
+                }
+
+                void IncrementalTokenStream::releaseRetiredTokens() {
+                    for (Token *t : retired) {
+                        delete t;
+                    }
+                    retired.clear();
+                }
+
+            }
+        }
+    }
+}
@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "CommonTokenStream.h"
+#include "LexerSnapshot.h"
+#include "Interval.h"
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                /// <summary>
+                /// A <seealso cref="CommonTokenStream"/> over a <seealso cref="Lexer"/> that can
+                ///  follow an edit to its text without tokenizing everything again.
+                /// <p/>
+                /// While buffering it remembers, for every token, the lexer state the
+                ///  token was started from and how far the lexer looked ahead to end
+                ///  it. <seealso cref="#relex"/> restarts the lexer at the first token whose
+                ///  lookahead reached the edit and stops as soon as it arrives, past the
+                ///  edit, at a token boundary it already knows in the same lexer state;
+                ///  from there on the old tokens are kept, their positions moved by the
+                ///  size of the edit. Token objects outside the damaged region therefore
+                ///  survive the edit, which is what lets <seealso cref="IncrementalReparser"/>
+                ///  keep the parse trees built on them.
+                /// </summary>
+                class IncrementalTokenStream : public CommonTokenStream {
+                protected:
+                    Lexer *const lexer;
+
+                    /// <summary>
+                    /// The lexer state before each buffered token, indexed like
+                    ///  <seealso cref="#tokens"/>. </summary>
+                    std::vector<LexerSnapshot> snapshots;
+
+                    /// <summary>
+                    /// The furthest char index examined while matching each buffered
+                    ///  token, including anything skipped in front of it. </summary>
+                    std::vector<int> lookaheadEnds;
+
+                    /// <summary>
+                    /// Tokens replaced by <seealso cref="#relex"/> but possibly still referenced
+                    ///  from a parse tree. </summary>
+                    std::vector<Token*> retired;
+
+                public:
+                    IncrementalTokenStream(Lexer *lexer);
+
+                    IncrementalTokenStream(Lexer *lexer, int channel);
+
+                    virtual ~IncrementalTokenStream();
+
+                    /// <summary>
+                    /// Brings the buffer up to date with {@code input}, which must be the
+                    ///  current text with {@code removedLength} chars at {@code editStart}
+                    ///  replaced by {@code insertedLength} new ones. The stream is filled
+                    ///  from the old text first if it had not reached EOF yet, so the old
+                    ///  char stream must still be alive when this is called; afterwards
+                    ///  it is no longer used.
+                    /// <p/>
+                    /// Returns the token indexes, in the updated buffer, of the tokens
+                    ///  lexed again. The interval is empty ({@code b < a}) if no token
+                    ///  changed. Tokens before it are untouched; tokens after it are the
+                    ///  same objects as before with their char positions, lines and
+                    ///  token indexes shifted.
+                    /// </summary>
+                    virtual misc::Interval relex(CharStream *input, int editStart, int removedLength, int insertedLength);
+
+                    /// <summary>
+                    /// Returns {@code true} if {@code t} is still part of the buffer, i.e.
+                    ///  was not replaced by <seealso cref="#relex"/>.
+                    /// </summary>
+                    virtual bool isLive(Token *t);
+
+                    /// <summary>
+                    /// Deletes the tokens replaced by previous calls to <seealso cref="#relex"/>.
+                    ///  Call once no parse tree refers to them any more.
+                    /// </summary>
+                    virtual void releaseRetiredTokens();
+
+                protected:
+                    virtual int fetch(int n) override;
+
+                    /// <summary>
+                    /// Returns the index of the first token that has to be lexed again
+                    ///  after an edit at {@code editStart}.
+                    /// </summary>
+                    virtual size_t firstDamaged(int editStart);
+                };
+
+            }
+        }
+    }
+}
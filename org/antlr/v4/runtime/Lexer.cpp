@@ -290,6 +290,30 @@ namespace org {
                     return tokens;
                 }
 
+                LexerSnapshot Lexer::snapshot() {
+                    return LexerSnapshot(_input->index(), getLine(), getCharPositionInLine(), _mode, _modeStack);
+                }
+
+                void Lexer::restore(CharStream *input, const LexerSnapshot &snapshot) {
+                    // tokens keep a pointer to the shared source pair, so swapping the
+                    // stream in place retargets every token handed out so far
+                    _input = input;
+                    _tokenFactorySourcePair->second = input;
+                    _input->seek(snapshot.charIndex);
+
+                    _token = nullptr; // owned by whoever buffered it
+                    _type = Token::INVALID_TYPE;
+                    _channel = Token::DEFAULT_CHANNEL;
+                    _text = L"";
+                    _hitEOF = false;
+                    _mode = snapshot.mode;
+                    _modeStack = snapshot.modeStack;
+
+                    getInterpreter()->reset();
+                    setLine(snapshot.line);
+                    setCharPositionInLine(snapshot.charPositionInLine);
+                }
+
                 void Lexer::recover(LexerNoViableAltException *e) {
                     if (_input->LA(1) != IntStream::_EOF) {
                         // skip a char and try again
@@ -4,6 +4,7 @@
 #include "Recognizer.h"
 #include "Token.h"
 #include "TokenSource.h"
+#include "LexerSnapshot.h"
 #include "stringconverter.h"
 
 #include <iostream>
@@ -238,6 +239,22 @@ namespace org {
                     /// </summary>
                     virtual std::vector<Token*> getAllTokens();
 
+                    /// <summary>
+                    /// Captures the state the next call to <seealso cref="#nextToken"/> starts
+                    ///  from. Only meaningful between tokens.
+                    /// </summary>
+                    virtual LexerSnapshot snapshot();
+
+                    /// <summary>
+                    /// Resumes tokenizing {@code input} from {@code snapshot}, as if the
+                    ///  lexer had just returned the token before it. {@code input} may be a
+                    ///  different stream from the one the snapshot was taken on, typically
+                    ///  the edited text; tokens already created over the old stream read
+                    ///  their text from {@code input} afterwards. The caller keeps
+                    ///  ownership of both streams.
+                    /// </summary>
+                    virtual void restore(CharStream *input, const LexerSnapshot &snapshot);
+
                     virtual void recover(LexerNoViableAltException *e);
 
                     virtual void notifyListeners(LexerNoViableAltException *e);
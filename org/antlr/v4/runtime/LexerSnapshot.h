@@ -0,0 +1,72 @@
+﻿#pragma once
+
+#include <vector>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                /// <summary>
+                /// Everything a <seealso cref="Lexer"/> needs to resume tokenizing at a token
+                ///  boundary: where it is in the char stream, the line and column the
+                ///  next token starts from, and the mode it is in. Taken with
+                ///  <seealso cref="Lexer#snapshot"/> and put back with <seealso cref="Lexer#restore"/>.
+                /// </summary>
+                class LexerSnapshot {
+                public:
+                    int charIndex;
+                    int line;
+                    int charPositionInLine;
+                    int mode;
+                    std::vector<int> modeStack;
+
+                    LexerSnapshot();
+
+                    LexerSnapshot(int charIndex, int line, int charPositionInLine, int mode, const std::vector<int> &modeStack);
+
+                    /// <summary>
+                    /// Returns {@code true} if a lexer resumed from either snapshot would
+                    ///  tokenize identical text identically: same mode, same mode stack and
+                    ///  same column. The char index and line are allowed to differ; they
+                    ///  only shift the tokens that follow.
+                    /// </summary>
+                    virtual bool hasSameState(const LexerSnapshot &other) const;
+                };
+
+            }
+        }
+    }
+}
@@ -26,6 +26,9 @@
 #include "IntervalSet.h"
 #include "RuleStartState.h"
 #include "DefaultErrorStrategy.h"
+#include "RuleMemoTable.h"
+#include "BailErrorStrategy.h"
+#include "RecognitionException.h"
 
 
 /*
@@ -138,6 +141,9 @@ namespace org {
                     setTrace(false);
                     _precedenceStack.clear();
                     _precedenceStack.push_back(0);
+                    if (_ruleMemo != nullptr) {
+                        _ruleMemo->clear();
+                    }
                     atn::ATNSimulator *interpreter = getInterpreter();
                     if (interpreter != nullptr) {
                         interpreter->reset();
@@ -200,6 +206,14 @@ namespace org {
                     return std::find(getParseListeners().begin(), getParseListeners().end(), TrimToSizeListener::INSTANCE) != getParseListeners().end();
                 }
 
+                void Parser::setRuleMemoTable(RuleMemoTable *memo) {
+                    _ruleMemo = memo;
+                }
+
+                RuleMemoTable *Parser::getRuleMemoTable() {
+                    return _ruleMemo;
+                }
+
                 std::vector<tree::ParseTreeListener*> Parser::getParseListeners() {
                     std::vector<tree::ParseTreeListener*> listeners = _parseListeners;
                     if (listeners.empty()) {
@@ -336,6 +350,12 @@ template<typename T1>
                 }
 
                 void Parser::notifyErrorListeners(Token *offendingToken, const std::wstring &msg, RecognitionException *e) {
+                    if (_holdingSyntaxErrors) {
+                        HeldSyntaxError error = { offendingToken, msg, e };
+                        _heldSyntaxErrors.push_back(error);
+                        return;
+                    }
+
                     _syntaxErrors++;
                     int line = -1;
                     int charPositionInLine = -1;
@@ -346,6 +366,22 @@ template<typename T1>
                     listener->syntaxError(this, offendingToken, line, charPositionInLine, msg, e);
                 }
 
+                void Parser::holdSyntaxErrors() {
+                    _holdingSyntaxErrors = true;
+                    _heldSyntaxErrors.clear();
+                }
+
+                void Parser::releaseSyntaxErrors(bool report) {
+                    std::vector<HeldSyntaxError> held;
+                    held.swap(_heldSyntaxErrors);
+                    _holdingSyntaxErrors = false;
+                    if (report) {
+                        for (const HeldSyntaxError &error : held) {
+                            notifyErrorListeners(error.offendingToken, error.msg, error.e);
+                        }
+                    }
+                }
+
                 org::antlr::v4::runtime::Token *Parser::consume() {
                     Token *o = getCurrentToken();
                     if (o->getType() != EOF) {
@@ -394,6 +430,9 @@ template<typename T1>
 
                 void Parser::exitRule() {
                     _ctx->stop = _input->LT(-1);
+                    if (_ruleMemo != nullptr && _ctx->exception != nullptr) {
+                        memoizeRule(_ctx, 0);
+                    }
                     // trigger event on _ctx, before it reverts to parent
                     if (_parseListeners.size() > 0) {
                         triggerExitRuleEvent();
@@ -402,6 +441,27 @@ template<typename T1>
                     _ctx = static_cast<ParserRuleContext*>(_ctx->parent);
                 }
 
+                void Parser::memoizeRule(ParserRuleContext *ctx, int precedence) {
+                    if (isContextFreeFailure(ctx)) {
+                        _ruleMemo->recordFailure(ctx->getRuleIndex(), ctx->start->getTokenIndex(), precedence);
+                    }
+                }
+
+                bool Parser::isContextFreeFailure(ParserRuleContext *ctx) {
+                    // a bail-out sets the exception on every context it cancels
+                    if (dynamic_cast<BailErrorStrategy*>(_errHandler) != nullptr) {
+                        return false;
+                    }
+
+                    // a rule that can't match the empty string never looks past its own
+                    // end before it has consumed a token, so rejecting its first token
+                    // doesn't depend on where it was called from
+                    if (ctx->exception->getOffendingToken() != ctx->start) {
+                        return false;
+                    }
+                    return !getATN()->nextTokens(getATN()->ruleToStartState[ctx->getRuleIndex()])->contains(Token::EPSILON);
+                }
+
                 void Parser::enterOuterAlt(ParserRuleContext *localctx, int altNum) {
                     // if we have new localctx, make sure we replace existing ctx
                     // that is previous child of parse tree
@@ -447,10 +507,22 @@ template<typename T1>
                 }
 
                 void Parser::unrollRecursionContexts(ParserRuleContext *_parentctx) {
-                    _precedenceStack.pop_back();
                     _ctx->stop = _input->LT(-1);
+                    if (_ruleMemo != nullptr && _ctx->exception != nullptr) {
+                        memoizeRule(_ctx, _precedenceStack.back());
+                    }
+                    _precedenceStack.pop_back();
                     ParserRuleContext *retctx = _ctx; // save current ctx (return value)
 
+                    // hook into tree before the exit event, so that listeners find retctx
+                    // among its parent's children as they do for a rule left by exitRule
+                    retctx->parent = _parentctx;
+
+                    if (_buildParseTrees && _parentctx != nullptr) {
+                        // add return ctx into invoking rule's tree
+                        _parentctx->addChild(retctx);
+                    }
+
                     // unroll so _ctx is as it was before call to recursive method
                     if (_parseListeners.size() > 0) {
                         while (_ctx != _parentctx) {
@@ -460,14 +532,6 @@ template<typename T1>
                     } else {
                         _ctx = _parentctx;
                     }
-
-                    // hook into tree
-                    retctx->parent = _parentctx;
-
-                    if (_buildParseTrees && _parentctx != nullptr) {
-                        // add return ctx into invoking rule's tree
-                        _parentctx->addChild(retctx);
-                    }
                 }
 
                 org::antlr::v4::runtime::ParserRuleContext *Parser::getInvokingContext(int ruleIndex) {
@@ -489,6 +553,14 @@ template<typename T1>
                     _ctx = ctx;
                 }
 
+                int Parser::getPrecedence() {
+                    if (_precedenceStack.empty()) {
+                        return -1;
+                    }
+
+                    return _precedenceStack.back();
+                }
+
                 bool Parser::precpred(RuleContext *localctx, int precedence) {
                     return precedence >= _precedenceStack.back();
                 }
@@ -591,7 +663,7 @@ template<typename T1>
                         bool seenOne = false;
                         for (int d = 0; d < _interp->decisionToDFA->length; d++) {
                             DFA *dfa = _interp->_decisionToDFA[d];
-                            if (!dfa->states->isEmpty()) {
+                            if (!dfa->states->empty()) {
                                 if (seenOne) {
                                     std::cout << std::endl;
                                 }
@@ -629,6 +701,8 @@ template<typename T1>
                     _precedenceStack.push_back(0);
                     _buildParseTrees = true;
                     _syntaxErrors = 0;
+                    _holdingSyntaxErrors = false;
+                    _ruleMemo = nullptr;
                 }
             }
         }
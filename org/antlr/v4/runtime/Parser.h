@@ -148,6 +148,27 @@ namespace org {
                     /// </summary>
                     int _syntaxErrors;
 
+                    /// <summary>
+                    /// A syntax error reported while errors are held back. </summary>
+                    struct HeldSyntaxError {
+                        Token *offendingToken;
+                        std::wstring msg;
+                        RecognitionException *e;
+                    };
+
+                    /// <summary>
+                    /// Whether <seealso cref="#notifyErrorListeners"/> queues reports in
+                    /// {@code _heldSyntaxErrors} instead of counting and dispatching them. </summary>
+                    /// <seealso cref= #holdSyntaxErrors </seealso>
+                    bool _holdingSyntaxErrors;
+                    std::vector<HeldSyntaxError> _heldSyntaxErrors;
+
+                    /// <summary>
+                    /// Where rule failures are recorded, or {@code null} (the default) to
+                    /// not record them. </summary>
+                    /// <seealso cref= #setRuleMemoTable </seealso>
+                    RuleMemoTable *_ruleMemo;
+
                 public:
                     Parser(TokenStream *input);
 
@@ -229,6 +250,16 @@ namespace org {
                     /// using the default <seealso cref="Parser.TrimToSizeListener"/> during the parse process. </returns>
                     virtual bool getTrimParseTree();
 
+                    /// <summary>
+                    /// Records rule invocations that fail in {@code memo}, which full-context
+                    /// prediction then uses to skip rules known to fail at a position. The
+                    /// table is cleared by <seealso cref="#reset"/>. The parser does not own
+                    /// it; pass {@code null} to stop recording.
+                    /// </summary>
+                    virtual void setRuleMemoTable(RuleMemoTable *memo);
+
+                    virtual RuleMemoTable *getRuleMemoTable();
+
                     virtual std::vector<tree::ParseTreeListener*> getParseListeners();
 
                     /// <summary>
@@ -356,6 +387,22 @@ namespace org {
 
                     virtual void notifyErrorListeners(Token *offendingToken, const std::wstring &msg, RecognitionException *e);
 
+                    /// <summary>
+                    /// Starts holding back syntax errors: until <seealso cref="#releaseSyntaxErrors"/>
+                    ///  is called, reports are queued instead of reaching the error listeners
+                    ///  or the <seealso cref="#getNumberOfSyntaxErrors"/> count. This lets a
+                    ///  speculative parse be thrown away without leaving diagnostics behind.
+                    /// </summary>
+                    virtual void holdSyntaxErrors();
+
+                    /// <summary>
+                    /// Stops holding back syntax errors and, if {@code report} is set,
+                    ///  reports the queued ones in order as if they were reported now;
+                    ///  otherwise they are dropped. Their tokens and exceptions must still
+                    ///  be alive.
+                    /// </summary>
+                    virtual void releaseSyntaxErrors(bool report);
+
                     /// <summary>
                     /// Consume and return the <seealso cref="#getCurrentToken current symbol"/>.
                     /// <p/>
@@ -391,6 +438,19 @@ namespace org {
 
                     virtual void exitRule();
 
+                protected:
+                    /// <summary>
+                    /// Records in <seealso cref="#_ruleMemo"/> that {@code ctx} failed, unless
+                    ///  the failure may depend on its context. </summary>
+                    virtual void memoizeRule(ParserRuleContext *ctx, int precedence);
+
+                    /// <summary>
+                    /// Returns {@code true} if the error that ended {@code ctx} would have
+                    ///  ended its rule at that token wherever it had been invoked from.
+                    /// </summary>
+                    virtual bool isContextFreeFailure(ParserRuleContext *ctx);
+
+                public:
                     virtual void enterOuterAlt(ParserRuleContext *localctx, int altNum);
 
                     /// @deprecated Use
@@ -412,6 +472,13 @@ namespace org {
 
                     virtual void setContext(ParserRuleContext *ctx);
 
+                    /// <summary>
+                    /// Get the precedence level for the top-most precedence rule.
+                    /// </summary>
+                    /// <returns> The precedence level for the top-most precedence rule, or -1 if
+                    /// the parser context is not nested within a precedence rule. </returns>
+                    virtual int getPrecedence();
+
                     virtual bool precpred(RuleContext *localctx, int precedence) override;
 
                     virtual bool inContext(const std::wstring &context);
@@ -152,7 +152,7 @@ namespace org {
                     }
 
                     atn::Transition *transition = p->transition(edge - 1);
-                    switch (transition->getSerializationType()) {
+                    switch (transition->serializationType) {
                         case atn::Transition::EPSILON:
                             if (pushRecursionContextStates[p->stateNumber] == 1 && !(dynamic_cast<atn::LoopEndState*>(transition->target) != nullptr)) {
                             InterpreterRuleContext *ctx = new InterpreterRuleContext(_parentContextStack->front()->first, _parentContextStack->front()->second, _ctx->getRuleIndex());
@@ -170,7 +170,7 @@ namespace org {
                         case atn::Transition::RANGE:
                         case atn::Transition::SET:
                         case atn::Transition::NOT_SET:
-                            if (!transition->matches(_input->LA(1), Token::MIN_USER_TOKEN_TYPE, 65535)) {
+                            if (!transition->matchesSymbol(_input->LA(1), Token::MIN_USER_TOKEN_TYPE, 65535)) {
                                 _errHandler->recoverInline(this);
                             }
                             matchWildcard();
@@ -211,7 +211,7 @@ namespace org {
                     return (int)children.size() > 0 ? (int)children.size() : 0;
                 }
 
-                misc::Interval *ParserRuleContext::getSourceInterval() {
+                misc::Interval ParserRuleContext::getSourceInterval() {
                     if (start == nullptr || stop == nullptr) {
                         return misc::Interval::INVALID;
                     }
@@ -155,7 +155,7 @@ namespace org {
                     std::vector<T> getRuleContexts(void *ctxType);
 
                     virtual int getChildCount() override;
-                    virtual misc::Interval *getSourceInterval() override;
+                    virtual misc::Interval getSourceInterval() override;
 
                     virtual Token *getStart();
                     virtual Token *getStop();
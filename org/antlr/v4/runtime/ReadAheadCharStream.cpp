@@ -0,0 +1,95 @@
+﻿#include "ReadAheadCharStream.h"
+#include "IntStream.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                const size_t ReadAheadCharStream::DEFAULT_CAPACITY;
+                const size_t ReadAheadCharStream::READ_BLOCK_SIZE;
+
+                ReadAheadCharStream::ReadAheadCharStream(std::istream *input, size_t capacity, int bufferSize) : UnbufferedCharStream(bufferSize), source(input), buffer(capacity) {
+                    producer = std::thread(&ReadAheadCharStream::produce, this);
+                    try {
+                        fill(1); // prime
+                    } catch (...) {
+                        // the destructor will not run, so stop the producer before leaving
+                        buffer.close();
+                        producer.join();
+                        throw;
+                    }
+                }
+
+                ReadAheadCharStream::~ReadAheadCharStream() {
+                    buffer.close();
+                    if (producer.joinable()) {
+                        producer.join();
+                    }
+                }
+
+                void ReadAheadCharStream::produce() {
+                    try {
+                        char block[READ_BLOCK_SIZE];
+                        bool open = true;
+                        while (open && *source) {
+                            source->read(block, sizeof(block));
+                            std::streamsize count = source->gcount();
+                            for (std::streamsize i = 0; i < count && open; i++) {
+                                open = buffer.push(static_cast<wchar_t>(static_cast<unsigned char>(block[i])));
+                            }
+                        }
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    buffer.close();
+                }
+
+                int ReadAheadCharStream::nextChar() {
+                    wchar_t c;
+                    if (buffer.pop(c)) {
+                        return c;
+                    }
+                    if (error != nullptr) {
+                        std::exception_ptr e = error;
+                        error = nullptr;
+                        std::rethrow_exception(e);
+                    }
+                    return IntStream::_EOF;
+                }
+
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <istream>
+#include <thread>
+#include <exception>
+
+#include "UnbufferedCharStream.h"
+#include "RingBuffer.h"
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                /// <summary>
+                /// An <seealso cref="UnbufferedCharStream"/> whose characters are read from
+                /// {@code input} by a background thread, in blocks, up to {@code capacity}
+                /// characters ahead of the lexer. Marks and the sliding window behave as in
+                /// the base class; the read-ahead itself is bounded by the ring buffer.
+                /// <p/>
+                /// As in the base class, each byte read becomes one character. The stream
+                /// must not be used by anything else while this object exists.
+                /// </summary>
+                class ReadAheadCharStream : public UnbufferedCharStream {
+                public:
+                    static const size_t DEFAULT_CAPACITY = 64 * 1024;
+                    static const size_t READ_BLOCK_SIZE = 4096;
+
+                protected:
+                    std::istream *const source;
+                    misc::RingBuffer<wchar_t> buffer;
+
+                private:
+                    std::exception_ptr error;
+                    std::thread producer;
+
+                public:
+                    ReadAheadCharStream(std::istream *input, size_t capacity = DEFAULT_CAPACITY, int bufferSize = 256);
+
+                    /// <summary>
+                    /// Stops the producer and waits for the read it is in to complete.
+                    /// </summary>
+                    virtual ~ReadAheadCharStream();
+
+                protected:
+                    virtual int nextChar() override;
+
+                private:
+                    void produce();
+                };
+
+            }
+        }
+    }
+}
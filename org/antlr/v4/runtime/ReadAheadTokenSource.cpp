@@ -0,0 +1,113 @@
+﻿#include "ReadAheadTokenSource.h"
+#include "Token.h"
+#include "WritableToken.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                const size_t ReadAheadTokenSource::DEFAULT_CAPACITY;
+
+                ReadAheadTokenSource::ReadAheadTokenSource(TokenSource *source, size_t capacity) : source(source), input(source->getInputStream()), sourceName(source->getSourceName()), tokenFactory(source->getTokenFactory()), buffer(capacity) {
+                    last.token = nullptr;
+                    last.line = source->getLine();
+                    last.charPositionInLine = source->getCharPositionInLine();
+                    producer = std::thread(&ReadAheadTokenSource::produce, this);
+                }
+
+                ReadAheadTokenSource::~ReadAheadTokenSource() {
+                    buffer.close();
+                    if (producer.joinable()) {
+                        producer.join();
+                    }
+                }
+
+                void ReadAheadTokenSource::produce() {
+                    try {
+                        while (true) {
+                            Token *t = source->nextToken();
+                            WritableToken *writable = dynamic_cast<WritableToken*>(t);
+                            if (writable != nullptr) {
+                                writable->setText(t->getText());
+                            }
+                            Item item = { t, source->getLine(), source->getCharPositionInLine() };
+                            if (!buffer.push(item) || t->getType() == Token::_EOF) {
+                                break;
+                            }
+                        }
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    buffer.close();
+                }
+
+                Token *ReadAheadTokenSource::nextToken() {
+                    Item item;
+                    if (buffer.pop(item)) {
+                        last = item;
+                        return item.token;
+                    }
+                    if (error != nullptr) {
+                        std::exception_ptr e = error;
+                        error = nullptr;
+                        std::rethrow_exception(e);
+                    }
+                    return last.token; // EOF
+                }
+
+                int ReadAheadTokenSource::getLine() {
+                    return last.line;
+                }
+
+                int ReadAheadTokenSource::getCharPositionInLine() {
+                    return last.charPositionInLine;
+                }
+
+                CharStream *ReadAheadTokenSource::getInputStream() {
+                    return input;
+                }
+
+                std::string ReadAheadTokenSource::getSourceName() {
+                    return sourceName;
+                }
+
+                TokenFactory<CommonToken *> *ReadAheadTokenSource::getTokenFactory() {
+                    return tokenFactory;
+                }
+
+            }
+        }
+    }
+}
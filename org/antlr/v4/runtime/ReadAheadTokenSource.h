@@ -0,0 +1,115 @@
+﻿#pragma once
+
+#include <string>
+#include <thread>
+#include <exception>
+
+#include "TokenSource.h"
+#include "RingBuffer.h"
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                /// <summary>
+                /// Runs another <seealso cref="TokenSource"/>, normally a <seealso cref="Lexer"/>, on a
+                /// background thread that stays up to {@code capacity} tokens ahead of the
+                /// consumer. Wrapping the lexer of an <seealso cref="UnbufferedTokenStream"/> this
+                /// way overlaps lexing with parsing while keeping memory bounded: the
+                /// stream's own window still only grows while a mark is held.
+                /// <p/>
+                /// Once constructed, the wrapped source belongs to the producer thread
+                /// until it has returned EOF; don't call into it, or the char stream
+                /// under it, from elsewhere. The producer therefore records the source's
+                /// line and column after each token for <seealso cref="#getLine"/> and
+                /// <seealso cref="#getCharPositionInLine"/>, and fixes the text of each
+                /// <seealso cref="WritableToken"/> so that getText() doesn't read the char
+                /// stream on the consumer's side. The input stream, source name and token
+                /// factory are taken once, before the producer starts. An exception thrown
+                /// by the source is rethrown from <seealso cref="#nextToken"/> once the tokens
+                /// before it have been consumed.
+                /// </summary>
+                class ReadAheadTokenSource : public TokenSource {
+                public:
+                    static const size_t DEFAULT_CAPACITY = 1024;
+
+                protected:
+                    /// <summary>
+                    /// A token and the source's position right after it. </summary>
+                    struct Item {
+                        Token *token;
+                        int line;
+                        int charPositionInLine;
+                    };
+
+                    TokenSource *const source;
+                    CharStream *const input;
+                    const std::string sourceName;
+                    TokenFactory<CommonToken *> *const tokenFactory;
+                    misc::RingBuffer<Item> buffer;
+
+                    /// <summary>
+                    /// The last token returned by <seealso cref="#nextToken"/>, repeated once
+                    ///  the buffer is drained after EOF, and the position after it. </summary>
+                    Item last;
+
+                private:
+                    std::exception_ptr error;
+                    std::thread producer;
+
+                public:
+                    ReadAheadTokenSource(TokenSource *source, size_t capacity = DEFAULT_CAPACITY);
+
+                    /// <summary>
+                    /// Stops the producer and waits for it to finish the token it is on.
+                    /// </summary>
+                    virtual ~ReadAheadTokenSource();
+
+                    virtual Token *nextToken() override;
+                    virtual int getLine() override;
+                    virtual int getCharPositionInLine() override;
+                    virtual CharStream *getInputStream() override;
+                    virtual std::string getSourceName() override;
+                    virtual TokenFactory<CommonToken *> *getTokenFactory() override;
+
+                private:
+                    void produce();
+                };
+
+            }
+        }
+    }
+}
@@ -154,6 +154,11 @@ namespace org {
                 }
                 
                 
+                template<typename T1, typename T2>
+                bool Recognizer<T1, T2>::isPurePredicate(int ruleIndex, int predIndex) {
+                    return false;
+                }
+                
                 template<typename T1, typename T2>
                 bool Recognizer<T1, T2>::precpred(RuleContext *localctx, int precedence) {
                     return true;
@@ -165,6 +165,15 @@ namespace org {
                     // that the ATN interp needs to execute
                     virtual bool sempred(RuleContext *_localctx, int ruleIndex, int actionIndex);
 
+                    /// <summary>
+                    /// Declares whether the context independent predicate {@code predIndex}
+                    ///  of rule {@code ruleIndex} is pure: its value depends on nothing but
+                    ///  the input at the position it is evaluated, so prediction may reuse
+                    ///  an earlier result at the same token. Predicates that consult state
+                    ///  changed by actions must not be declared pure. None are by default.
+                    /// </summary>
+                    virtual bool isPurePredicate(int ruleIndex, int predIndex);
+
                     virtual bool precpred(RuleContext *localctx, int precedence);
 
                     virtual void action(RuleContext *_localctx, int ruleIndex, int actionIndex);
@@ -71,7 +71,7 @@ namespace org {
                     return invokingState == -1;
                 }
 
-                misc::Interval *RuleContext::getSourceInterval() {
+                misc::Interval RuleContext::getSourceInterval() {
                     return misc::Interval::INVALID;
                 }
 
@@ -94,7 +94,7 @@ namespace org {
 
                     // satisfy the ParseTree / SyntaxTree interface
 
-                    virtual misc::Interval *getSourceInterval() override;
+                    virtual misc::Interval getSourceInterval() override;
 
                     virtual RuleContext *getRuleContext() override;
                     virtual RuleContext *getParent() override;
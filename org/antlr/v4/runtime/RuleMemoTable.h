@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <unordered_set>
+#include <cstddef>
+#include <cstdint>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+
+                /// <summary>
+                /// Remembers rule invocations that failed, keyed by rule index, start
+                ///  token index and precedence. Opt in with
+                ///  <seealso cref="Parser#setRuleMemoTable"/>; the parser fills the table as
+                ///  rules return and clears it in <seealso cref="Parser#reset"/>, so nothing
+                ///  from one pass, such as the SLL stage of a two-stage parse, reaches
+                ///  the next.
+                /// <p/>
+                /// Full-context prediction consults the table: a rule that can't match
+                ///  at a token index can't match there during prediction either, so
+                ///  configurations entering it are dropped instead of being simulated
+                ///  up to the token where they die. Only failures that hold whatever
+                ///  the rule was called from are recorded, namely a rule that rejected
+                ///  its first token and can't match the empty string. An error further
+                ///  into a rule may be down to the alternative its caller's context
+                ///  led prediction to, and a <seealso cref="BailErrorStrategy"/> bail-out says
+                ///  nothing about the contexts it unwinds, so neither is recorded.
+                /// <p/>
+                /// Successful invocations aren't recorded. Where a rule stopped depends
+                ///  on the context it was called from, and a prediction configuration
+                ///  can't be moved past the tokens a rule matched while the rest of its
+                ///  set stays behind, so no consumer could use them. Grammars whose
+                ///  predicates depend on state other than the input should not use the
+                ///  table.
+                /// </summary>
+                class RuleMemoTable {
+                protected:
+                    std::unordered_set<uint64_t> failures;
+
+                public:
+                    /// <summary>
+                    /// Lookups that found a failure, and lookups that didn't. </summary>
+                    size_t hits;
+                    size_t misses;
+
+                    RuleMemoTable();
+
+                    virtual ~RuleMemoTable() {}
+
+                    /// <summary>
+                    /// Records that rule {@code ruleIndex} invoked at {@code startIndex} with
+                    ///  {@code precedence} failed.
+                    /// </summary>
+                    virtual void recordFailure(int ruleIndex, int startIndex, int precedence);
+
+                    /// <summary>
+                    /// Returns {@code true} if rule {@code ruleIndex} invoked at
+                    ///  {@code startIndex} with {@code precedence} is known to fail.
+                    /// </summary>
+                    virtual bool hasFailed(int ruleIndex, int startIndex, int precedence);
+
+                    virtual size_t size();
+
+                    virtual void clear();
+
+                private:
+                    static uint64_t key(int ruleIndex, int startIndex, int precedence);
+                };
+
+            }
+        }
+    }
+}
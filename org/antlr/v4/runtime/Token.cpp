@@ -4,6 +4,10 @@ namespace org {
     namespace antlr {
         namespace v4 {
             namespace runtime {
+
+                Token::~Token() {
+                }
+
             }
         }
     }
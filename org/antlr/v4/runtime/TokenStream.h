@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "IntStream.h"
+#include "Interval.h"
 #include "Declarations.h"
 
 /*
@@ -100,7 +101,7 @@ namespace org {
                     /// stream.
                     /// </returns>
                     /// <exception cref="NullPointerException"> if {@code interval} is {@code null} </exception>
-                    virtual std::wstring getText(misc::Interval *interval) = 0;
+                    virtual std::wstring getText(misc::Interval interval) = 0;
 
                     /// <summary>
                     /// Return the text of all tokens in the stream. This method behaves like the
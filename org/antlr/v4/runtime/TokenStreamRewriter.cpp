@@ -1,5 +1,9 @@
 ﻿#include "TokenStreamRewriter.h"
 #include "Interval.h"
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <sstream>
 
 namespace org {
     namespace antlr {
@@ -7,72 +11,58 @@ namespace org {
             namespace runtime {
                 using org::antlr::v4::runtime::misc::Interval;
 
-                TokenStreamRewriter::RewriteOperation::RewriteOperation(TokenStreamRewriter *outerInstance, int index) : outerInstance(outerInstance) {
-
-                    InitializeInstanceFields();
-                    this->index = index;
-                }
-
-                TokenStreamRewriter::RewriteOperation::RewriteOperation(TokenStreamRewriter *outerInstance, int index, const std::wstring& text) : outerInstance(outerInstance) {
-
-                    InitializeInstanceFields();
-                    this->index = index;
-                    this->text = text;
+                TokenStreamRewriter::RewriteOperation::RewriteOperation(TokenStreamRewriter *outerInstance, int index) : outerInstance(outerInstance), instructionIndex(0), index(index) {
                 }
 
-                int TokenStreamRewriter::RewriteOperation::execute(std::wstring *buf) {
-                    return index;
+                TokenStreamRewriter::RewriteOperation::RewriteOperation(TokenStreamRewriter *outerInstance, int index, const std::wstring& text) : outerInstance(outerInstance), instructionIndex(0), index(index), text(text) {
                 }
 
                 std::wstring TokenStreamRewriter::RewriteOperation::toString() {
-                    std::wstring opName = getClass()->getName();
-                    int index = opName.find(L'$');
-                    opName = opName.substr(index + 1, opName.length() - (index + 1));
-                    return L"<" + opName + L"@" + outerInstance->tokens->get(index)->getText() + L":\"" + text + L"\">";
-                }
-
-                void TokenStreamRewriter::RewriteOperation::InitializeInstanceFields() {
-                    instructionIndex = 0;
-                    index = 0;
+                    return L"<" + getOpName() + L"@" + outerInstance->tokens->get(index)->getText() + L":\"" + text + L"\">";
                 }
 
-                TokenStreamRewriter::InsertBeforeOp::InsertBeforeOp(TokenStreamRewriter *outerInstance, int index, const std::wstring& text) : RewriteOperation(outerInstance, index, text), outerInstance(outerInstance) {
+                std::wstring TokenStreamRewriter::RewriteOperation::getOpName() {
+                    return L"RewriteOperation";
                 }
 
-                int TokenStreamRewriter::InsertBeforeOp::execute(std::wstring *buf) {
-                    buf->append(text);
-                    if (outerInstance->tokens->get(index)->getType() != Token::EOF) {
-                        buf->append(outerInstance->tokens->get(index)->getText());
-                    }
-                    return index + 1;
+                TokenStreamRewriter::InsertBeforeOp::InsertBeforeOp(TokenStreamRewriter *outerInstance, int index, const std::wstring& text) : RewriteOperation(outerInstance, index, text) {
                 }
 
-                TokenStreamRewriter::ReplaceOp::ReplaceOp(TokenStreamRewriter *outerInstance, int from, int to, const std::wstring& text) : RewriteOperation(outerInstance, from,text), outerInstance(outerInstance) {
-
-                    InitializeInstanceFields();
-                    lastIndex = to;
+                std::wstring TokenStreamRewriter::InsertBeforeOp::getOpName() {
+                    return L"InsertBeforeOp";
                 }
 
-                int TokenStreamRewriter::ReplaceOp::execute(std::wstring *buf) {
-                    buf->append(text);
-                    return lastIndex + 1;
+                TokenStreamRewriter::ReplaceOp::ReplaceOp(TokenStreamRewriter *outerInstance, int from, int to, const std::wstring& text, bool isDelete) : RewriteOperation(outerInstance, from, text), lastIndex(to), isDelete(isDelete) {
                 }
 
                 std::wstring TokenStreamRewriter::ReplaceOp::toString() {
-                    if (text.empty()) {
+                    if (isDelete) {
                         return std::wstring(L"<DeleteOp@") + outerInstance->tokens->get(index)->getText() + std::wstring(L"..") + outerInstance->tokens->get(lastIndex)->getText() + std::wstring(L">");
                     }
                     return std::wstring(L"<ReplaceOp@") + outerInstance->tokens->get(index)->getText() + std::wstring(L"..") + outerInstance->tokens->get(lastIndex)->getText() + std::wstring(L":\"") + text + std::wstring(L"\">");
                 }
 
-                void TokenStreamRewriter::ReplaceOp::InitializeInstanceFields() {
-                    lastIndex = 0;
+                TokenStreamRewriter::Program::Program() {
+                    instructions.reserve(PROGRAM_INIT_SIZE);
+                }
+
+                TokenStreamRewriter::Program::~Program() {
+                    clear();
+                }
+
+                void TokenStreamRewriter::Program::clear() {
+                    for (auto op : instructions) {
+                        delete op;
+                    }
+                    instructions.clear();
+                    inserts.clear();
+                    replaces.clear();
                 }
 
-const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
+                const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
 
-                TokenStreamRewriter::TokenStreamRewriter(TokenStream *tokens) : tokens(tokens), programs(std::unordered_map<std::wstring, std::vector<RewriteOperation*>>()), lastRewriteTokenIndexes(std::unordered_map<std::wstring, int>()) {
-                    programs->put(DEFAULT_PROGRAM_NAME, VectorHelper::VectorWithReservedSize<RewriteOperation*>(PROGRAM_INIT_SIZE));
+                TokenStreamRewriter::TokenStreamRewriter(TokenStream *tokens) : tokens(tokens) {
+                    programs[DEFAULT_PROGRAM_NAME];
                 }
 
                 org::antlr::v4::runtime::TokenStream *TokenStreamRewriter::getTokenStream() {
@@ -84,9 +74,31 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                 }
 
                 void TokenStreamRewriter::rollback(const std::wstring &programName, int instructionIndex) {
-                    std::vector<RewriteOperation*> is = programs->get(programName);
-                    if (is.size() > 0) {
-                        programs->put(programName, is.subList(MIN_TOKEN_INDEX,instructionIndex));
+                    std::map<std::wstring, Program>::iterator found = programs.find(programName);
+                    if (found == programs.end()) {
+                        return;
+                    }
+                    Program &program = found->second;
+                    size_t keep = (size_t)std::max(instructionIndex, (int)MIN_TOKEN_INDEX);
+                    if (keep >= program.instructions.size()) {
+                        return;
+                    }
+                    for (size_t i = keep; i < program.instructions.size(); i++) {
+                        delete program.instructions[i];
+                    }
+                    program.instructions.resize(keep);
+
+                    // rebuild the reduced form from the surviving instructions; they were
+                    // all accepted once already, so replaying them cannot throw
+                    program.inserts.clear();
+                    program.replaces.clear();
+                    for (auto op : program.instructions) {
+                        ReplaceOp *rop = dynamic_cast<ReplaceOp*>(op);
+                        if (rop != nullptr) {
+                            reduceReplace(program, rop);
+                        } else {
+                            reduceInsert(program, static_cast<InsertBeforeOp*>(op));
+                        }
                     }
                 }
 
@@ -128,10 +140,16 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                 }
 
                 void TokenStreamRewriter::insertBefore(const std::wstring &programName, int index, const std::wstring& text) {
-                    RewriteOperation *op = new InsertBeforeOp(this, index,text);
-                    std::vector<RewriteOperation*> rewrites = getProgram(programName);
-                    op->instructionIndex = rewrites.size();
-                    rewrites.push_back(op);
+                    InsertBeforeOp *op = new InsertBeforeOp(this, index,text);
+                    Program &program = getProgram(programName);
+                    try {
+                        reduceInsert(program, op);
+                    } catch (...) {
+                        delete op;
+                        throw;
+                    }
+                    op->instructionIndex = (int)program.instructions.size();
+                    program.instructions.push_back(op);
                 }
 
                 void TokenStreamRewriter::replace(int index, const std::wstring& text) {
@@ -151,13 +169,7 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                 }
 
                 void TokenStreamRewriter::replace(const std::wstring &programName, int from, int to, const std::wstring& text) {
-                    if (from > to || from < 0 || to < 0 || to >= tokens->size()) {
-                        throw IllegalArgumentException(std::wstring(L"replace: range invalid: ") + from + std::wstring(L"..") + to + std::wstring(L"(size=") + tokens->size() + std::wstring(L")"));
-                    }
-                    RewriteOperation *op = new ReplaceOp(this, from, to, text);
-                    std::vector<RewriteOperation*> rewrites = getProgram(programName);
-                    op->instructionIndex = rewrites.size();
-                    rewrites.push_back(op);
+                    addReplace(programName, from, to, text, false);
                 }
 
                 void TokenStreamRewriter::replace(const std::wstring &programName, Token *from, Token *to, const std::wstring& text) {
@@ -181,11 +193,27 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                 }
 
                 void TokenStreamRewriter::delete_Renamed(const std::wstring &programName, int from, int to) {
-                    replace(programName,from,to,nullptr);
+                    addReplace(programName, from, to, L"", true);
                 }
 
                 void TokenStreamRewriter::delete_Renamed(const std::wstring &programName, Token *from, Token *to) {
-                    replace(programName,from,to,nullptr);
+                    delete_Renamed(programName, from->getTokenIndex(), to->getTokenIndex());
+                }
+
+                void TokenStreamRewriter::addReplace(const std::wstring &programName, int from, int to, const std::wstring& text, bool isDelete) {
+                    if (from > to || from < 0 || to < 0 || to >= tokens->size()) {
+                        throw IllegalArgumentException(std::wstring(L"replace: range invalid: ") + std::to_wstring(from) + std::wstring(L"..") + std::to_wstring(to) + std::wstring(L"(size=") + std::to_wstring(tokens->size()) + std::wstring(L")"));
+                    }
+                    ReplaceOp *op = new ReplaceOp(this, from, to, text, isDelete);
+                    Program &program = getProgram(programName);
+                    try {
+                        reduceReplace(program, op);
+                    } catch (...) {
+                        delete op;
+                        throw;
+                    }
+                    op->instructionIndex = (int)program.instructions.size();
+                    program.instructions.push_back(op);
                 }
 
                 int TokenStreamRewriter::getLastRewriteTokenIndex() {
@@ -193,43 +221,42 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                 }
 
                 int TokenStreamRewriter::getLastRewriteTokenIndex(const std::wstring &programName) {
-                    int I = lastRewriteTokenIndexes->get(programName);
-                    if (I == nullptr) {
+                    std::map<std::wstring, int>::const_iterator found = lastRewriteTokenIndexes.find(programName);
+                    if (found == lastRewriteTokenIndexes.end()) {
                         return -1;
                     }
-                    return I;
+                    return found->second;
                 }
 
                 void TokenStreamRewriter::setLastRewriteTokenIndex(const std::wstring &programName, int i) {
-                    lastRewriteTokenIndexes->put(programName, i);
+                    lastRewriteTokenIndexes[programName] = i;
                 }
 
-                std::vector<TokenStreamRewriter::RewriteOperation*> TokenStreamRewriter::getProgram(const std::wstring &name) {
-                    std::vector<TokenStreamRewriter::RewriteOperation*> is = programs->get(name);
-                    if (is.empty()) {
-                        is = initializeProgram(name);
-                    }
-                    return is;
+                TokenStreamRewriter::Program &TokenStreamRewriter::getProgram(const std::wstring &name) {
+                    return programs[name];
                 }
 
-                std::vector<TokenStreamRewriter::RewriteOperation*> TokenStreamRewriter::initializeProgram(const std::wstring &name) {
-                    std::vector<TokenStreamRewriter::RewriteOperation*> is = VectorHelper::VectorWithReservedSize<RewriteOperation*>(PROGRAM_INIT_SIZE);
-                    programs->put(name, is);
-                    return is;
+                std::wstring TokenStreamRewriter::getText() {
+                    return getText(DEFAULT_PROGRAM_NAME, Interval(0, tokens->size() - 1));
                 }
 
-                std::wstring TokenStreamRewriter::getText() {
-                    return getText(DEFAULT_PROGRAM_NAME, Interval::of(0,tokens->size() - 1));
+                void TokenStreamRewriter::getText(std::wostream &out) {
+                    getText(DEFAULT_PROGRAM_NAME, Interval(0, tokens->size() - 1), out);
                 }
 
-                std::wstring TokenStreamRewriter::getText(Interval *interval) {
+                std::wstring TokenStreamRewriter::getText(Interval interval) {
                     return getText(DEFAULT_PROGRAM_NAME, interval);
                 }
 
-                std::wstring TokenStreamRewriter::getText(const std::wstring &programName, Interval *interval) {
-                    std::vector<TokenStreamRewriter::RewriteOperation*> rewrites = programs->get(programName);
-                    int start = interval->a;
-                    int stop = interval->b;
+                std::wstring TokenStreamRewriter::getText(const std::wstring &programName, Interval interval) {
+                    std::wstringstream buf;
+                    getText(programName, interval, buf);
+                    return buf.str();
+                }
+
+                void TokenStreamRewriter::getText(const std::wstring &programName, Interval interval, std::wostream &out) {
+                    int start = interval.a;
+                    int stop = interval.b;
 
                     // ensure start/end are in range
                     if (stop > tokens->size() - 1) {
@@ -239,29 +266,35 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                         start = 0;
                     }
 
-                    if (rewrites.empty() || rewrites.empty()) {
-                        return tokens->getText(interval); // no instructions to execute
-                    }
-                    StringBuilder *buf = new StringBuilder();
-
-                    // First, optimize instruction stream
-                    Map<int, TokenStreamRewriter::RewriteOperation*> *indexToOp = reduceToSingleOperationPerIndex(rewrites);
+                    // with no instructions the walk below just copies the tokens, which
+                    // still streams them rather than asking the token stream for one big string
+                    Program &program = getProgram(programName);
 
-                    // Walk buffer, executing instructions and emitting tokens
+                    // Walk buffer, executing instructions and emitting tokens.  Both maps are
+                    // ordered by token index, so we just advance a cursor into each.
+                    std::map<int, std::wstring>::const_iterator insert = program.inserts.lower_bound(start);
+                    std::map<int, Program::Replacement>::const_iterator replace = program.replaces.lower_bound(start);
                     int i = start;
                     while (i <= stop && i < tokens->size()) {
-                        RewriteOperation *op = indexToOp->get(i);
-                        indexToOp->remove(i); // remove so any left have index size-1
+                        while (insert != program.inserts.end() && insert->first < i) {
+                            ++insert;
+                        }
+                        while (replace != program.replaces.end() && replace->first < i) {
+                            ++replace;
+                        }
+                        if (replace != program.replaces.end() && replace->first == i) {
+                            out << replace->second.text;
+                            i = replace->second.lastIndex + 1; // skip replaced tokens
+                            continue;
+                        }
+                        if (insert != program.inserts.end() && insert->first == i) {
+                            out << insert->second;
+                        }
                         Token *t = tokens->get(i);
-                        if (op == nullptr) {
-                            // no operation at that index, just dump token
-                            if (t->getType() != Token::EOF) {
-                                buf->append(t->getText());
-                            }
-                            i++; // move to next token
-                        } else {
-                            i = op->execute(buf); // execute operation and skip
+                        if (t->getType() != Token::_EOF) {
+                            out << t->getText();
                         }
+                        i++; // move to next token
                     }
 
                     // include stuff after end if it's last index in buffer
@@ -270,158 +303,83 @@ const std::wstring TokenStreamRewriter::DEFAULT_PROGRAM_NAME = L"default";
                     if (stop == tokens->size() - 1) {
                         // Scan any remaining operations after last token
                         // should be included (they will be inserts).
-                        for (auto op : indexToOp) {
-                            if (op->second->index >= tokens->size() - 1) {
-                                buf->append(op->second->text);
-                            }
+                        for (insert = program.inserts.lower_bound(i); insert != program.inserts.end(); ++insert) {
+                            out << insert->second;
                         }
                     }
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                    return buf->toString();
                 }
 
-                Map<int, TokenStreamRewriter::RewriteOperation*> *TokenStreamRewriter::reduceToSingleOperationPerIndex(std::vector<TokenStreamRewriter::RewriteOperation*> &rewrites) {
-                                //		System.out.println("rewrites="+rewrites);
-
-                    // WALK REPLACES
-                    for (TokenStreamRewriter::RewriteOperation *op : rewrites) {
-                        if (op == nullptr) {
-                            continue;
+                void TokenStreamRewriter::reduceInsert(Program &program, InsertBeforeOp *iop) {
+                    // look for a replace whose range holds iop.index
+                    std::map<int, Program::Replacement>::iterator replace = program.replaces.upper_bound(iop->index);
+                    if (replace != program.replaces.begin()) {
+                        --replace;
+                        if (replace->first == iop->index) {
+                            // R.x-y.v I.x.u -> R.x-y.uv
+                            replace->second.text = iop->text + replace->second.text;
+                            replace->second.insertText = iop->text + replace->second.insertText;
+                            replace->second.isDelete = false;
+                            return;
                         }
-                        if (!(dynamic_cast<ReplaceOp*>(op) != nullptr)) {
-                            continue;
-                        }
-                        ReplaceOp *rop = static_cast<ReplaceOp*>(rewrites[i]);
-                        // Wipe prior inserts within range
-//JAVA TO C++ CONVERTER TODO TASK: Java wildcard generics are not converted to C++:
-//ORIGINAL LINE: java.util.List<? extends InsertBeforeOp> inserts = getKindOfOps(rewrites, InsertBeforeOp.class, i);
-                        std::vector<? extends InsertBeforeOp> inserts = getKindOfOps(rewrites, InsertBeforeOp::typeid, i);
-                        for (auto iop : inserts) {
-                            if (iop.index == rop->index) {
-                                // E.g., insert before 2, delete 2..2; update replace
-                                // text to include insert before, kill insert
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                                delete rewrites[iop.instructionIndex];
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                                rop->text = iop.text->toString() + (rop->text != nullptr?rop->text->toString():L"");
-                            } else if (iop.index > rop->index && iop.index <= rop->lastIndex) {
-                                // delete insert as it's a no-op.
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                                delete rewrites[iop.instructionIndex];
-                            }
-                        }
-                        // Drop any prior replaces contained within
-//JAVA TO C++ CONVERTER TODO TASK: Java wildcard generics are not converted to C++:
-//ORIGINAL LINE: java.util.List<? extends ReplaceOp> prevReplaces = getKindOfOps(rewrites, ReplaceOp.class, i);
-                        std::vector<? extends ReplaceOp> prevReplaces = getKindOfOps(rewrites, ReplaceOp::typeid, i);
-                        for (auto prevRop : prevReplaces) {
-                            if (prevRop.index >= rop->index && prevRop.lastIndex <= rop->lastIndex) {
-                                // delete replace as it's a no-op.
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                                delete rewrites[prevRop.instructionIndex];
-                                continue;
-                            }
-                            // throw exception unless disjoint or identical
-                            bool disjoint = prevRop.lastIndex < rop->index || prevRop.index > rop->lastIndex;
-                            bool same = prevRop.index == rop->index && prevRop.lastIndex == rop->lastIndex;
-                            // Delete special case of replace (text==null):
-                            // D.i-j.u D.x-y.v	| boundaries overlap	combine to max(min)..max(right)
-                            if (prevRop.text == nullptr && rop->text == nullptr && !disjoint) {
-                                //System.out.println("overlapping deletes: "+prevRop+", "+rop);
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                                delete rewrites[prevRop.instructionIndex]; // kill first delete
-                                rop->index = std::min(prevRop.index, rop->index);
-                                rop->lastIndex = std::max(prevRop.lastIndex, rop->lastIndex);
-                                std::cout << std::wstring(L"new rop ") << rop << std::endl;
-                            } else if (!disjoint && !same) {
-                                throw IllegalArgumentException(std::wstring(L"replace op boundaries of ") + rop + std::wstring(L" overlap with previous ") + prevRop);
-                            }
+                        if (iop->index <= replace->second.lastIndex) {
+                            throw IllegalArgumentException(std::wstring(L"insert op ") + iop->toString() + std::wstring(L" within boundaries of previous replace ") + std::to_wstring(replace->first) + std::wstring(L"..") + std::to_wstring(replace->second.lastIndex));
                         }
                     }
 
-                    // WALK INSERTS
-                    for (int i = 0; i < rewrites.size(); i++) {
-                        RewriteOperation *op = rewrites[i];
-                        if (op == nullptr) {
-                            continue;
-                        }
-                        if (!(dynamic_cast<InsertBeforeOp*>(op) != nullptr)) {
-                            continue;
-                        }
-                        InsertBeforeOp *iop = static_cast<InsertBeforeOp*>(rewrites[i]);
-                        // combine current insert with prior if any at same index
-//JAVA TO C++ CONVERTER TODO TASK: Java wildcard generics are not converted to C++:
-//ORIGINAL LINE: java.util.List<? extends InsertBeforeOp> prevInserts = getKindOfOps(rewrites, InsertBeforeOp.class, i);
-                        std::vector<? extends InsertBeforeOp> prevInserts = getKindOfOps(rewrites, InsertBeforeOp::typeid, i);
-                        for (auto prevIop : prevInserts) {
-                            if (prevIop.index == iop->index) { // combine objects
-                                // convert to strings...we're in process of toString'ing
-                                // whole token buffer so no lazy eval issue with any templates
-                                iop->text = catOpText(iop->text,prevIop.text);
-                                // delete redundant prior insert
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                                delete rewrites[prevIop.instructionIndex];
-                            }
-                        }
-                        // look for replaces where iop.index is in range; error
-//JAVA TO C++ CONVERTER TODO TASK: Java wildcard generics are not converted to C++:
-//ORIGINAL LINE: java.util.List<? extends ReplaceOp> prevReplaces = getKindOfOps(rewrites, ReplaceOp.class, i);
-                        std::vector<? extends ReplaceOp> prevReplaces = getKindOfOps(rewrites, ReplaceOp::typeid, i);
-                        for (auto rop : prevReplaces) {
-                            if (iop->index == rop->index) {
-                                rop->text = catOpText(iop->text,rop->text);
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                                delete rewrites[i]; // delete current insert
-                                continue;
-                            }
-                            if (iop->index >= rop->index && iop->index <= rop->lastIndex) {
-                                throw IllegalArgumentException(std::wstring(L"insert op ") + iop + std::wstring(L" within boundaries of previous ") + rop);
-                            }
+                    // combine with any prior insert at the same index; newest text goes first
+                    std::wstring &text = program.inserts[iop->index];
+                    text = iop->text + text;
+                }
+
+                void TokenStreamRewriter::reduceReplace(Program &program, ReplaceOp *rop) {
+                    int from = rop->index;
+                    int to = rop->lastIndex;
+
+                    // an insert at the left boundary is folded into the replacement text,
+                    // which also stops a delete from being a pure delete; so is one already
+                    // folded into a prior replace from the same index that this one covers
+                    std::wstring insertText;
+                    std::map<int, std::wstring>::iterator leftInsert = program.inserts.find(rop->index);
+                    if (leftInsert != program.inserts.end()) {
+                        insertText = leftInsert->second;
+                    } else {
+                        std::map<int, Program::Replacement>::iterator covered = program.replaces.find(rop->index);
+                        if (covered != program.replaces.end() && covered->second.lastIndex <= to) {
+                            insertText = covered->second.insertText;
                         }
                     }
-                    // System.out.println("rewrites after="+rewrites);
-                    Map<int, TokenStreamRewriter::RewriteOperation*> *m = std::unordered_map<int, TokenStreamRewriter::RewriteOperation*>();
-                    for (TokenStreamRewriter::RewriteOperation *op : rewrites) {
-                        if (op == nullptr) { // ignore deleted ops
-                            continue;
-                        }
-                        if (m->get(op->index) != nullptr) {
-                            throw Error(L"should only be one op per index");
+                    bool isDelete = rop->isDelete && insertText.empty() && leftInsert == program.inserts.end();
+
+                    // find the prior replaces that overlap from..to; only the first can
+                    // start before from since the ranges are disjoint
+                    std::map<int, Program::Replacement>::iterator first = program.replaces.upper_bound(from);
+                    if (first != program.replaces.begin()) {
+                        std::map<int, Program::Replacement>::iterator previous = std::prev(first);
+                        if (previous->second.lastIndex >= from) {
+                            first = previous;
                         }
-                        m->put(op->index, op);
                     }
-                    //System.out.println("index to op: "+m);
-                    return m;
-                }
-
-                std::wstring TokenStreamRewriter::catOpText(void *a, void *b) {
-                    std::wstring x = L"";
-                    std::wstring y = L"";
-                    if (a != nullptr) {
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                        x = a->toString();
-                    }
-                    if (b != nullptr) {
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                        y = b->toString();
-                    }
-                    return x + y;
-                }
-
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ template equivalent to generic constraints:
-template<typename T, typename T1> where T : RewriteOperation where T1 : RewriteOperation
-                std::vector<? extends T> TokenStreamRewriter::getKindOfOps(std::vector<T1> rewrites, Class *kind, int before) {
-                    std::vector<T> ops = std::vector<T>();
-                    for (int i = 0; i < before && i < rewrites.size(); i++) {
-                        TokenStreamRewriter::RewriteOperation *op = rewrites[i];
-                        if (op == nullptr) { // ignore deleted
-                            continue;
+                    std::map<int, Program::Replacement>::iterator last = first;
+                    for (; last != program.replaces.end() && last->first <= to; ++last) {
+                        const Program::Replacement &prevRop = last->second;
+                        if (last->first >= from && prevRop.lastIndex <= to) {
+                            continue; // contained; dropped below
                         }
-                        if (kind->isInstance(op)) {
-                            ops.push_back(kind->cast(op));
+                        if (prevRop.isDelete && isDelete) {
+                            // overlapping deletes combine to min(left)..max(right)
+                            from = std::min(from, last->first);
+                            to = std::max(to, prevRop.lastIndex);
+                            continue;
                         }
+                        throw IllegalArgumentException(std::wstring(L"replace op boundaries of ") + rop->toString() + std::wstring(L" overlap with previous replace ") + std::to_wstring(last->first) + std::wstring(L"..") + std::to_wstring(prevRop.lastIndex));
                     }
-                    return ops;
+
+                    // no errors; now commit the change
+                    Program::Replacement replacement = { to, insertText + rop->text, isDelete, insertText };
+                    // wipe prior inserts within range
+                    program.inserts.erase(program.inserts.lower_bound(rop->index), program.inserts.upper_bound(rop->lastIndex));
+                    program.replaces.erase(first, last);
+                    program.replaces[from] = replacement;
                 }
             }
         }
@@ -5,10 +5,8 @@
 #include "misc/Interval.h"
 #include <map>
 #include <string>
-#include <unordered_map>
 #include <vector>
 #include <iostream>
-#include "vectorhelper.h"
 
 /*
  * [The "BSD license"]
@@ -108,64 +106,111 @@ namespace org {
                 /// 
                 ///  If you don't use named rewrite streams, a "default" stream is used as
                 ///  the first example shows.
+                /// 
+                ///  Each program keeps its edits normalized as they are issued: inserts and
+                ///  replaced ranges live in maps ordered by token index, so an edit costs
+                ///  O(log n) in the number of edits and getText() is a single forward walk
+                ///  over the tokens that writes straight to the output stream.
                 /// </summary>
                 class TokenStreamRewriter {
                 public:
                     class RewriteOperation {
-                                private:
-                                    TokenStreamRewriter *const outerInstance;
+                    protected:
+                        TokenStreamRewriter *const outerInstance;
 
                         /// <summary>
                         /// What index into rewrites List are we? </summary>
-                    protected:
+                    public:
+                        int instructionIndex;
+
                         /// <summary>
                         /// Token buffer index. </summary>
                         int index;
                         std::wstring text;
 
+                    protected:
                         RewriteOperation(TokenStreamRewriter *outerInstance, int index);
 
                         RewriteOperation(TokenStreamRewriter *outerInstance, int index, const std::wstring& text);
-                        /// <summary>
-                        /// Execute the rewrite operation by possibly adding to the buffer.
-                        ///  Return the index of the next token to operate on.
-                        /// </summary>
-                    public:
-                        int instructionIndex;
 
-                        virtual int execute(std::wstring *buf);
+                    public:
+                        virtual ~RewriteOperation() {}
 
                         virtual std::wstring toString();
-                        
-                    private:
-                        void InitializeInstanceFields();
+
+                    protected:
+                        virtual std::wstring getOpName();
                     };
 
                 public:
                     class InsertBeforeOp : public RewriteOperation {
-                                private:
-                                    TokenStreamRewriter *const outerInstance;
-
                     public:
                         InsertBeforeOp(TokenStreamRewriter *outerInstance, int index, const std::wstring& text);
 
-                        virtual int execute(std::wstring *buf) override;
+                    protected:
+                        virtual std::wstring getOpName() override;
                     };
 
+                    /// <summary>
+                    /// I'm going to try replacing range from x..y with (y-x)+1 ReplaceOp
+                    ///  instructions.
+                    /// </summary>
                 public:
                     class ReplaceOp : public RewriteOperation {
-                                private:
-                                    TokenStreamRewriter *const outerInstance;
-
-                    protected:
-                        int lastIndex;
                     public:
-                        ReplaceOp(TokenStreamRewriter *outerInstance, int from, int to, const std::wstring& text);
-                        virtual int execute(std::wstring *buf) override;
+                        int lastIndex;
+
+                        /// <summary>
+                        /// True for delete(), which is a replace with no text at all (null
+                        ///  text in the Java runtime). Overlapping deletes are merged.
+                        /// </summary>
+                        bool isDelete;
+
+                        ReplaceOp(TokenStreamRewriter *outerInstance, int from, int to, const std::wstring& text, bool isDelete = false);
+
                         virtual std::wstring toString() override;
+                    };
+
+                    /// <summary>
+                    /// A rewrite program: the instructions as issued, plus the same edits
+                    ///  reduced to at most one operation per token index.
+                    /// </summary>
+                    class Program {
+                    public:
+                        struct Replacement {
+                            int lastIndex;
+
+                            /// <summary>
+                            /// Replacement text, led by any insertText. </summary>
+                            std::wstring text;
+                            bool isDelete;
+
+                            /// <summary>
+                            /// Text of inserts at the first index that were folded into this
+                            ///  replacement; a later replace from the same index that covers
+                            ///  this one keeps it.
+                            /// </summary>
+                            std::wstring insertText;
+                        };
+
+                        /// <summary>
+                        /// Instructions in the order they were issued; replayed by rollback(). </summary>
+                        std::vector<RewriteOperation*> instructions;
+
+                        /// <summary>
+                        /// Token index -> text to insert before that token. </summary>
+                        std::map<int, std::wstring> inserts;
+
+                        /// <summary>
+                        /// First token index -> replaced range.  Ranges are disjoint. </summary>
+                        std::map<int, Replacement> replaces;
+
+                        Program();
+                        Program(const Program &other) = delete;
+                        Program &operator = (const Program &other) = delete;
+                        ~Program();
 
-                    private:
-                        void InitializeInstanceFields();
+                        void clear();
                     };
 
                 public:
@@ -173,12 +218,6 @@ namespace org {
                     static const int PROGRAM_INIT_SIZE = 100;
                     static const int MIN_TOKEN_INDEX = 0;
 
-                    // Define the rewrite operation hierarchy
-
-                    /// <summary>
-                    /// I'm going to try replacing range from x..y with (y-x)+1 ReplaceOp
-                    ///  instructions.
-                    /// </summary>
                     /// <summary>
                     /// Our source stream </summary>
                 protected:
@@ -187,17 +226,19 @@ namespace org {
                     /// <summary>
                     /// You may have multiple, named streams of rewrite operations.
                     ///  I'm calling these things "programs."
-                    ///  Maps String (name) -> rewrite (List)
+                    ///  Maps String (name) -> rewrite program
                     /// </summary>
-                    std::map<std::wstring, std::vector<RewriteOperation*>> *const programs;
+                    std::map<std::wstring, Program> programs;
 
                     /// <summary>
                     /// Map String (program name) -> Integer index </summary>
-                    std::map<std::wstring, int> *const lastRewriteTokenIndexes;
+                    std::map<std::wstring, int> lastRewriteTokenIndexes;
 
                 public:
                     TokenStreamRewriter(TokenStream *tokens);
 
+                    virtual ~TokenStreamRewriter() {}
+
                     TokenStream *getTokenStream();
 
                     virtual void rollback(int instructionIndex);
@@ -205,7 +246,8 @@ namespace org {
                     /// <summary>
                     /// Rollback the instruction stream for a program so that
                     ///  the indicated instruction (via instructionIndex) is no
-                    ///  longer in the stream.  UNTESTED!
+                    ///  longer in the stream.  The remaining instructions are replayed
+                    ///  to rebuild the program's index, so this is O(n log n).
                     /// </summary>
                     virtual void rollback(const std::wstring &programName, int instructionIndex);
 
@@ -262,10 +304,7 @@ namespace org {
 
                     virtual void setLastRewriteTokenIndex(const std::wstring &programName, int i);
 
-                    virtual std::vector<RewriteOperation*> getProgram(const std::wstring &name);
-
-                private:
-                    std::vector<RewriteOperation*> initializeProgram(const std::wstring &name);
+                    virtual Program &getProgram(const std::wstring &name);
 
                     /// <summary>
                     /// Return the text from the original tokens altered per the
@@ -274,6 +313,10 @@ namespace org {
                 public:
                     virtual std::wstring getText();
 
+                    /// <summary>
+                    /// Write the rewritten text of the whole buffer to out. </summary>
+                    virtual void getText(std::wostream &out);
+
                     /// <summary>
                     /// Return the text associated with the tokens in the interval from the
                     ///  original token stream but with the alterations given to this rewriter.
@@ -284,9 +327,15 @@ namespace org {
                     ///  insertBefore on the first token, you would get that insertion.
                     ///  The same is true if you do an insertAfter the stop token.
                     /// </summary>
-                    virtual std::wstring getText(Interval *interval);
+                    virtual std::wstring getText(Interval interval);
 
-                    virtual std::wstring getText(const std::wstring &programName, Interval *interval);
+                    virtual std::wstring getText(const std::wstring &programName, Interval interval);
+
+                    /// <summary>
+                    /// Same as getText(programName, interval) but writes the rewritten text
+                    ///  to out as it walks the tokens instead of building a string.
+                    /// </summary>
+                    virtual void getText(const std::wstring &programName, Interval interval, std::wostream &out);
 
                     /// <summary>
                     /// We need to combine operations and report invalid operations (like
@@ -314,40 +363,23 @@ namespace org {
                     ///  I.i.u = insert u before op @ index i
                     ///  R.x-y.u = replace x-y indexed tokens with u
                     /// 
-                    ///  First we need to examine replaces.  For any replace op:
-                    /// 
-                    /// 		1. wipe out any insertions before op within that range.
-                    ///		2. Drop any replace op before that is contained completely within
-                    ///         that range.
-                    ///		3. Throw exception upon boundary overlap with any previous replace.
-                    /// 
-                    ///  Then we can deal with inserts:
-                    /// 
-                    /// 		1. for any inserts to same index, combine even if not adjacent.
-                    /// 		2. for any prior replace with same left boundary, combine this
-                    ///         insert with replace and delete this replace.
-                    /// 		3. throw exception if index in same range as previous replace
-                    /// 
-                    ///  Don't actually delete; make op null in list. Easier to walk list.
-                    ///  Later we can throw as we add to index -> op map.
+                    ///  These rules are applied as each operation arrives, against the
+                    ///  already reduced program, so an ERROR case throws
+                    ///  IllegalArgumentException from the insert/replace call itself and
+                    ///  leaves the program unchanged.
                     /// 
                     ///  Note that I.2 R.2-2 will wipe out I.2 even though, technically, the
                     ///  inserted stuff would be before the replace range.  But, if you
                     ///  add tokens in front of a method body '{' and then delete the method
                     ///  body, I think the stuff before the '{' you added should disappear too.
-                    /// 
-                    ///  Return a map from token index to operation.
                     /// </summary>
                 protected:
-                    virtual std::unordered_map<int, RewriteOperation*> *reduceToSingleOperationPerIndex(std::vector<RewriteOperation*> &rewrites);
+                    virtual void reduceInsert(Program &program, InsertBeforeOp *iop);
 
-                    virtual std::wstring catOpText(void *a, void *b);
-
-                    /// <summary>
-                    /// Get all operations before an index of a particular kind </summary>
-                    template <typename T>
-                    std::vector<RewriteOperation> getKindOfOps(std::vector<RewriteOperation> rewrites, T *kind, int before);
+                    virtual void reduceReplace(Program &program, ReplaceOp *rop);
 
+                private:
+                    void addReplace(const std::wstring &programName, int from, int to, const std::wstring& text, bool isDelete);
                 };
 
             }
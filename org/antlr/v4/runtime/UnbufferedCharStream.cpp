@@ -197,24 +197,24 @@ namespace org {
                     return name;
                 }
 
-                std::wstring UnbufferedCharStream::getText(misc::Interval *interval) {
-                    if (interval->a < 0 || interval->b < interval->a - 1) {
+                std::wstring UnbufferedCharStream::getText(misc::Interval interval) {
+                    if (interval.a < 0 || interval.b < interval.a - 1) {
                         throw IllegalArgumentException(std::wstring(L"invalid interval"));
                     }
 
                     int bufferStartIndex = getBufferStartIndex();
                     if (n > 0 && data[n - 1] == WCHAR_MAX) {
-                        if (interval->a + interval->length() > bufferStartIndex + n) {
+                        if (interval.a + interval.length() > bufferStartIndex + n) {
                             throw IllegalArgumentException(std::wstring(L"the interval extends past the end of the stream"));
                         }
                     }
 
-                    if (interval->a < bufferStartIndex || interval->b >= bufferStartIndex + n) {
-                        throw UnsupportedOperationException(std::wstring(L"interval ") + interval->toString() + std::wstring(L" outside buffer: ") + std::to_wstring(bufferStartIndex) + std::wstring(L"..") + std::to_wstring(bufferStartIndex + n - 1));
+                    if (interval.a < bufferStartIndex || interval.b >= bufferStartIndex + n) {
+                        throw UnsupportedOperationException(std::wstring(L"interval ") + interval.toString() + std::wstring(L" outside buffer: ") + std::to_wstring(bufferStartIndex) + std::wstring(L"..") + std::to_wstring(bufferStartIndex + n - 1));
                     }
                     // convert from absolute to local index
-                    int i = interval->a - bufferStartIndex;
-                    return std::wstring(data, i, interval->length());
+                    int i = interval.a - bufferStartIndex;
+                    return std::wstring(data, i, interval.length());
                 }
 
                 int UnbufferedCharStream::getBufferStartIndex() {
@@ -177,7 +177,7 @@ namespace org {
 
                     virtual std::string getSourceName() override;
 
-                    virtual std::wstring getText(misc::Interval *interval) override;
+                    virtual std::wstring getText(misc::Interval interval) override;
 
                 protected:
                     int getBufferStartIndex();
@@ -261,14 +261,14 @@ namespace org {
 				}
                 
 				template<typename T>
-                std::wstring UnbufferedTokenStream<T>::getText(misc::Interval *interval)  {
+                std::wstring UnbufferedTokenStream<T>::getText(misc::Interval interval)  {
 					int bufferStartIndex = getBufferStartIndex();
 					int bufferStopIndex = bufferStartIndex + tokens.size() - 1;
                     
-					int start = interval->a;
-					int stop = interval->b;
+					int start = interval.a;
+					int stop = interval.b;
 					if (start < bufferStartIndex || stop > bufferStopIndex) {
-						throw new UnsupportedOperationException(std::wstring(L"interval ") + interval->toString() + std::wstring(L" not in token buffer window: ") + std::to_wstring(bufferStartIndex) + std::wstring(L"..") + std::to_wstring(bufferStopIndex));
+						throw new UnsupportedOperationException(std::wstring(L"interval ") + interval.toString() + std::wstring(L" not in token buffer window: ") + std::to_wstring(bufferStartIndex) + std::wstring(L"..") + std::to_wstring(bufferStopIndex));
 					}
                     
 					int a = start - bufferStartIndex;
@@ -156,7 +156,7 @@ namespace org {
 
                     virtual std::string getSourceName() override;
 
-                    virtual std::wstring getText(misc::Interval *interval) ;
+                    virtual std::wstring getText(misc::Interval interval) ;
 
                 protected:
                     int getBufferStartIndex();
@@ -71,6 +71,23 @@ namespace org {
                     
                     }
 
+                    void ATN::defineLexerAction(int actionIndex, LexerActionExecutor *executor) {
+                        if (actionIndex < 0) {
+                            throw IllegalArgumentException(L"Invalid action index.");
+                        }
+                        if ((size_t)actionIndex >= lexerActions.size()) {
+                            lexerActions.resize(actionIndex + 1, nullptr);
+                        }
+                        lexerActions[actionIndex] = executor;
+                    }
+
+                    LexerActionExecutor *ATN::getLexerActionExecutor(int actionIndex) {
+                        if (actionIndex < 0 || (size_t)actionIndex >= lexerActions.size()) {
+                            return nullptr;
+                        }
+                        return lexerActions[actionIndex];
+                    }
+
                     void ATN::removeState(ATNState *state) {
                         delete states.at(state->stateNumber);// just free mem, don't shift states in list
                         states.at(state->stateNumber) = nullptr;
@@ -107,6 +107,13 @@ namespace org {
 
                         const std::vector<TokensStartState*> * modeToStartState;
 
+                        /// <summary>
+                        /// For lexer ATNs, the commands behind each action index, registered by
+                        /// the generated lexer through <seealso cref="#defineLexerAction"/>. Action
+                        /// indexes without an entry are run through <seealso cref="Recognizer#action"/>.
+                        /// </summary>
+                        std::vector<LexerActionExecutor*> lexerActions;
+
                         /// <summary>
                         /// Used for runtime deserialization of ATNs from strings </summary>
                         ATN(ATNType grammarType, int maxTokenType);
@@ -128,6 +135,17 @@ namespace org {
 
                         virtual void addState(ATNState *state);
 
+                        /// <summary>
+                        /// Makes {@code executor} the commands for lexer action {@code actionIndex}.
+                        /// Must be called before the first token is matched, since accept states
+                        /// pick up their executor when they are added to the DFA.
+                        /// </summary>
+                        virtual void defineLexerAction(int actionIndex, LexerActionExecutor *executor);
+
+                        /// <summary>
+                        /// The executor registered for {@code actionIndex}, or {@code null}. </summary>
+                        virtual LexerActionExecutor *getLexerActionExecutor(int actionIndex);
+
                         virtual void removeState(ATNState *state);
 
                         virtual int defineDecisionState(DecisionState *s);
@@ -92,15 +92,15 @@ namespace org {
                             return false;
                         }
 
-                        return this->state->stateNumber == other->state->stateNumber && this->alt == other->alt && (this->context == other->context || (this->context != nullptr && this->context->equals(other->context))) && this->semanticContext->equals(other->semanticContext);
+                        return this->state->stateNumber == other->state->stateNumber && this->alt == other->alt && (this->context == other->context || (this->context != nullptr && this->context->equals(other->context))) && this->semanticContext == other->semanticContext;
                     }
 
                     int ATNConfig::hashCode() {
                         int hashCode = misc::MurmurHash::initialize(7);
                         hashCode = misc::MurmurHash::update(hashCode, state->stateNumber);
                         hashCode = misc::MurmurHash::update(hashCode, alt);
-                        hashCode = misc::MurmurHash::update(hashCode, context);
-                        hashCode = misc::MurmurHash::update(hashCode, semanticContext);
+                        hashCode = misc::MurmurHash::update(hashCode, context != nullptr ? context->hashCode() : 0);
+                        hashCode = misc::MurmurHash::update(hashCode, semanticContext->hashCode());
                         hashCode = misc::MurmurHash::finish(hashCode, 4);
                         return hashCode;
                     }
@@ -98,6 +98,8 @@ namespace org {
 
                         ATNConfig(ATNConfig *c, ATNState *state, PredictionContext *context, SemanticContext *semanticContext);
 
+                        virtual ~ATNConfig() {}
+
                         /// <summary>
                         /// An ATN configuration is equal to another if both have
                         ///  the same state, they predict the same alternative, and
@@ -6,8 +6,11 @@
 #include "SemanticContext.h"
 #include "PredictionContext.h"
 #include "StringBuilder.h"
+#include "MurmurHash.h"
 
 #include <functional>
+#include <algorithm>
+#include <cstring>
 
 /*
  * [The "BSD license"]
@@ -94,7 +97,7 @@ namespace org {
                         if (a == nullptr || b == nullptr) {
                             return false;
                         }
-                        return a->state->stateNumber == b->state->stateNumber && a->alt == b->alt && a->semanticContext->equals(b->semanticContext);
+                        return a->state->stateNumber == b->state->stateNumber && a->alt == b->alt && a->semanticContext == b->semanticContext;
                     }
 
                     ATNConfigSet::ATNConfigSet(bool fullCtx) : fullCtx(fullCtx), configs(*new std::vector<ATNConfig*>(/*7*/)) {
@@ -103,9 +106,13 @@ namespace org {
                     }
 
                     ATNConfigSet::ATNConfigSet() : fullCtx(nullptr), configs(*new std::vector<ATNConfig*>(/*7*/)) {
+                        InitializeInstanceFields();
+                        configLookup = new ConfigHashSet();
                     }
 
                     ATNConfigSet::ATNConfigSet(ATNConfigSet *old) : fullCtx(nullptr), configs(*new std::vector<ATNConfig*>(/*7*/)) {
+                        InitializeInstanceFields();
+                        configLookup = new ConfigHashSet();
                         this->addAll<ATNConfigSet*>(old);
                         this->uniqueAlt = old->uniqueAlt;
                         this->conflictingAlts = old->conflictingAlts;
@@ -129,12 +136,8 @@ namespace org {
                         }
                         ATNConfig *existing = configLookup->getOrAdd(config);
                         if (existing == config) { // we added this new one
-                            cachedHashCode = -1;
-#ifdef TODO
-                            I really don't get why this is failing
-                            configs.insert(configs.back(), config); // track order here
-#endif
-                            
+                            configs.push_back(config); // track order here
+                            hashSum += (unsigned int)config->hashCode();
                             return true;
                         }
                         // a previous (s,i,pi,_), merge with it and save result
@@ -144,7 +147,9 @@ namespace org {
                         // since only way to create new graphs is "call rule" and here. We
                         // cache at both places.
                         existing->reachesIntoOuterContext = std::max(existing->reachesIntoOuterContext, config->reachesIntoOuterContext);
+                        hashSum -= (unsigned int)existing->hashCode();
                         existing->context = merged; // replace context; no need to alt mapping
+                        hashSum += (unsigned int)existing->hashCode();
                         return true;
                     }
 
@@ -207,46 +212,44 @@ namespace org {
 
                                         //		System.out.print("equals " + this + ", " + o+" = ");
                         ATNConfigSet *other = static_cast<ATNConfigSet*>(o);
-                        
+                        if (configs.size() != other->configs.size() || hashSum != other->hashSum) {
+                            return false;
+                        }
+
                         bool configEquals = true;
                         
-                        if (configs.size() == other->configs.size()) {
-                            for (int i = 0; i < configs.size(); i++) {
-                                if (other->configs.size() < i) {
-                                    configEquals = false;
-                                    break;
+                        if (isFrozen() && other->isFrozen()) {
+                            // equal sets of the same DFA usually share their cached contexts
+                            if (!frozen.empty() && memcmp(frozen.data(), other->frozen.data(), frozen.size() * sizeof(FrozenConfig)) != 0) {
+                                for (std::vector<FrozenConfig>::size_type i = 0; i < frozen.size(); i++) {
+                                    const FrozenConfig &a = frozen[i];
+                                    const FrozenConfig &b = other->frozen[i];
+                                    if (a.state != b.state || a.alt != b.alt || a.semanticContext != b.semanticContext || !(a.context == b.context || (a.context != nullptr && a.context->equals(b.context)))) {
+                                        configEquals = false;
+                                        break;
+                                    }
                                 }
-                                if (configs.at(i) != other->configs.at(i)) {
+                            }
+                        } else {
+                            for (std::vector<ATNConfig*>::size_type i = 0; i < configs.size(); i++) {
+                                if (!configs[i]->equals(other->configs[i])) {
                                     configEquals = false;
                                     break;
                                 }
                             }
-                        } else {
-                            configEquals = false;
                         }
                         
-                        bool same = configs.size() > 0 && configEquals && this->fullCtx == other->fullCtx && this->uniqueAlt == other->uniqueAlt && this->conflictingAlts == other->conflictingAlts && this->hasSemanticContext == other->hasSemanticContext && this->dipsIntoOuterContext == other->dipsIntoOuterContext; // includes stack context
+                        bool same = configs.size() > 0 && configEquals && this->fullCtx == other->fullCtx && this->uniqueAlt == other->uniqueAlt && (this->conflictingAlts == other->conflictingAlts || (this->conflictingAlts != nullptr && other->conflictingAlts != nullptr && *this->conflictingAlts == *other->conflictingAlts)) && this->hasSemanticContext == other->hasSemanticContext && this->dipsIntoOuterContext == other->dipsIntoOuterContext; // includes stack context
 
                                         //		System.out.println(same);
                         return same;
                     }
 
                     int ATNConfigSet::hashCode() {
-#ifdef TODO
-                        std::hash<std::vector<ATNConfig*>> bar;
-                        std::hash<int> foo;
-                        
-                        if (isReadonly()) {
-                            if (cachedHashCode == -1) {
-                                cachedHashCode = configs.hashCode();
-                            }
-
-                            return cachedHashCode;
-                        }
-
-                        return configs.hashCode();
-#endif
-                        return 0;
+                        int hashCode = misc::MurmurHash::initialize();
+                        hashCode = misc::MurmurHash::update(hashCode, (int)hashSum);
+                        hashCode = misc::MurmurHash::update(hashCode, (int)configs.size());
+                        return misc::MurmurHash::finish(hashCode, 2);
                     }
 
                     int ATNConfigSet::size() {
@@ -287,7 +290,7 @@ namespace org {
                             throw new IllegalStateException(L"This set is readonly");
                         }
                         configs.clear();
-                        cachedHashCode = -1;
+                        hashSum = 0;
                         configLookup->clear();
                     }
 
@@ -301,6 +304,43 @@ namespace org {
                         review memory managment, delete was autogenerated here
 #endif
                         delete configLookup; // can't mod, no need for lookup cache
+                        configLookup = nullptr;
+
+                        if (readonly) {
+                            freeze();
+                        } else {
+                            frozen.clear();
+                        }
+                    }
+
+                    void ATNConfigSet::freeze() {
+                        frozen.clear();
+                        frozen.reserve(configs.size());
+                        for (ATNConfig *config : configs) {
+                            FrozenConfig f;
+                            memset(&f, 0, sizeof(f));
+                            f.state = config->state->stateNumber;
+                            f.alt = config->alt;
+                            f.semanticContext = config->semanticContext;
+                            f.context = config->context;
+                            frozen.push_back(f);
+                        }
+
+                        // (s, i, pi) is unique within a set and semantic contexts are
+                        // interned, so equal sets sort the same way
+                        std::sort(frozen.begin(), frozen.end(), [](const FrozenConfig &a, const FrozenConfig &b) {
+                            if (a.state != b.state) {
+                                return a.state < b.state;
+                            }
+                            if (a.alt != b.alt) {
+                                return a.alt < b.alt;
+                            }
+                            return std::less<SemanticContext*>()(a.semanticContext, b.semanticContext);
+                        });
+                    }
+
+                    bool ATNConfigSet::isFrozen() {
+                        return !frozen.empty() || (readonly && configs.empty());
                     }
 
                     std::wstring ATNConfigSet::toString() {
@@ -360,7 +400,7 @@ namespace org {
                         uniqueAlt = 0;
                         hasSemanticContext = false;
                         dipsIntoOuterContext = false;
-                        cachedHashCode = -1;
+                        hashSum = 0;
                     }
                 }
             }
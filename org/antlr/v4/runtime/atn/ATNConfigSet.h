@@ -144,8 +144,29 @@ namespace org {
                         /// </summary>
                         const bool fullCtx;
 
+                        /// <summary>
+                        /// The part of a frozen configuration that equality looks at. Packed
+                        ///  without padding so whole arrays can be compared with memcmp. </summary>
+                        struct FrozenConfig {
+                            int state;
+                            int alt;
+                            SemanticContext *semanticContext;
+                            PredictionContext *context;
+                        };
+
                     private:
-                        int cachedHashCode;
+                        /// <summary>
+                        /// Sum of the hash codes of the configurations, kept up to date by
+                        ///  <seealso cref="#add"/>. A sum doesn't depend on the order configurations
+                        ///  were added in and lets a merge swap one hash for another.
+                        /// </summary>
+                        unsigned int hashSum;
+
+                        /// <summary>
+                        /// The configurations sorted by {@code (s, i, pi)}, built by
+                        ///  <seealso cref="#freeze"/>; empty while the set can change.
+                        /// </summary>
+                        std::vector<FrozenConfig> frozen;
 
                     public:
                         ATNConfigSet(bool fullCtx);
@@ -153,6 +174,8 @@ namespace org {
 
                         ATNConfigSet(ATNConfigSet *old); //this(old.fullCtx);
 
+                        virtual ~ATNConfigSet() {}
+
                         virtual bool add(ATNConfig *config);
 
                         /// <summary>
@@ -202,6 +225,16 @@ namespace org {
 
                         virtual void setReadonly(bool readonly);
 
+                        /// <summary>
+                        /// Packs the configurations into a sorted array so that
+                        ///  <seealso cref="#equals"/> against another frozen set is a size check, a
+                        ///  hash check and, usually, a single memcmp. Called by
+                        ///  <seealso cref="#setReadonly"/>; a set can't be frozen and still change.
+                        /// </summary>
+                        virtual void freeze();
+
+                        virtual bool isFrozen();
+
                         virtual std::wstring toString();
 
                         // satisfy interface
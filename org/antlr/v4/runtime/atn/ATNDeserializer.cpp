@@ -1,4 +1,5 @@
 ﻿#include "ATNDeserializer.h"
+#include "ATNImage.h"
 #include "ATNDeserializationOptions.h"
 #include "Declarations.h"
 #include "ATNState.h"
@@ -278,8 +279,183 @@ namespace org {
                             p += 6;
                         }
 
+                        linkStates(atn);
+
+                        //
+                        // DECISIONS
+                        //
+                        int ndecisions = toInt(data[p++]);
+                        for (int i = 1; i <= ndecisions; i++) {
+                            int s = toInt(data[p++]);
+                            DecisionState *decState = static_cast<DecisionState*>(atn->states[s]);
+                            // TODO: decisionToState was originally declared as const in ATN
+                            atn->decisionToState.push_back(decState);
+                            decState->decision = i - 1;
+                        }
+
+                        finalizeATN(atn);
+
+                        return atn;
+                    }
+
+                    ATN *ATNDeserializer::deserialize(const ATNImage &image) {
+                        const ATNImage::Header &header = image.header();
+                        ATN *atn = new ATN((ATNType)header.grammarType, header.maxTokenType);
+
+                        //
+                        // STATES
+                        //
+                        const ATNImage::State *states = image.states();
+                        atn->states.reserve(header.nstates);
+                        for (uint32_t i = 0; i < header.nstates; i++) {
+                            const ATNImage::State &record = states[i];
+                            ATNState *s = stateFactory(record.type, record.ruleIndex);
+                            if (s != nullptr) {
+                                // only the tokens start state of a lexer belongs to no rule
+                                checkCondition(record.ruleIndex >= (record.type == ATNState::TOKEN_START ? -1 : 0) && record.ruleIndex < (int64_t)header.nrules, L"state rule index out of range");
+                                s->transitions.reserve(record.nedges);
+                            } else {
+                                checkCondition(record.nedges == 0 && record.link < 0 && record.flags == 0, L"invalid state has edges, a link or flags");
+                            }
+                            atn->addState(s);
+                        }
+
+                        for (uint32_t i = 0; i < header.nstates; i++) {
+                            const ATNImage::State &record = states[i];
+                            if (record.link >= 0) {
+                                checkCondition((uint32_t)record.link < header.nstates, L"state link out of range");
+                                ATNState *link = atn->states[record.link];
+                                switch (record.type) {
+                                    case ATNState::LOOP_END:
+                                        checkCondition(link != nullptr, L"loop end state links to an invalid state");
+                                        static_cast<LoopEndState*>(atn->states[i])->loopBackState = link;
+                                        break;
+                                    case ATNState::BLOCK_START:
+                                    case ATNState::PLUS_BLOCK_START:
+                                    case ATNState::STAR_BLOCK_START:
+                                        checkCondition(states[record.link].type == ATNState::BLOCK_END, L"block start state links to a state that is not a block end");
+                                        static_cast<BlockStartState*>(atn->states[i])->endState = static_cast<BlockEndState*>(link);
+                                        break;
+                                    default:
+                                        checkCondition(false, L"state link on a state that takes none");
+                                }
+                            }
+
+                            checkCondition((record.flags & ~(ATNImage::NON_GREEDY | ATNImage::PRECEDENCE_RULE)) == 0, L"unknown state flags");
+
+                            if ((record.flags & ATNImage::NON_GREEDY) != 0) {
+                                DecisionState *decState = dynamic_cast<DecisionState*>(atn->states[i]);
+                                checkCondition(decState != nullptr, L"non-greedy flag on a state that is not a decision state");
+                                decState->nonGreedy = true;
+                            }
+
+                            if ((record.flags & ATNImage::PRECEDENCE_RULE) != 0) {
+                                checkCondition(record.type == ATNState::RULE_START, L"precedence flag on a state that is not a rule start state");
+                                static_cast<RuleStartState*>(atn->states[i])->isPrecedenceRule = true;
+                            }
+                        }
+
+                        //
+                        // RULES
+                        //
+                        const ATNImage::Rule *rules = image.rules();
+                        uint32_t nrules = header.nrules;
+                        atn->ruleToStartState.reserve(nrules);
+                        if (atn->grammarType == ATNType::LEXER) {
+                            atn->ruleToTokenType = new int[nrules];
+                            atn->ruleToActionIndex = new int[nrules];
+                        }
+
+                        for (uint32_t i = 0; i < nrules; i++) {
+                            checkCondition((uint32_t)rules[i].startState < header.nstates, L"rule start state out of range");
+                            checkCondition(states[rules[i].startState].type == ATNState::RULE_START, L"rule start state is not a rule start state");
+                            atn->ruleToStartState.push_back(static_cast<RuleStartState*>(atn->states[rules[i].startState]));
+                            if (atn->grammarType == ATNType::LEXER) {
+                                atn->ruleToTokenType[i] = rules[i].tokenType;
+                                atn->ruleToActionIndex[i] = rules[i].actionIndex;
+                            }
+                        }
+
+                        atn->ruleToStopState = new RuleStopState*[nrules]();
+                        for (ATNState *state : atn->states) {
+                            if (state == nullptr || state->getStateType() != ATNState::RULE_STOP) {
+                                continue;
+                            }
+
+                            RuleStopState *stopState = static_cast<RuleStopState*>(state);
+                            atn->ruleToStopState[state->ruleIndex] = stopState;
+                            atn->ruleToStartState[state->ruleIndex]->stopState = stopState;
+                        }
+                        for (uint32_t i = 0; i < nrules; i++) {
+                            checkCondition(atn->ruleToStopState[i] != nullptr, L"rule has no stop state");
+                        }
+
+                        //
+                        // MODES
+                        //
+                        std::vector<TokensStartState*> *modes = new std::vector<TokensStartState*>();
+                        modes->reserve(header.nmodes);
+                        for (uint32_t i = 0; i < header.nmodes; i++) {
+                            checkCondition((uint32_t)image.modes()[i] < header.nstates, L"mode start state out of range");
+                            checkCondition(states[image.modes()[i]].type == ATNState::TOKEN_START, L"mode start state is not a tokens start state");
+                            modes->push_back(static_cast<TokensStartState*>(atn->states[image.modes()[i]]));
+                        }
+                        delete atn->modeToStartState;
+                        atn->modeToStartState = modes;
+
+                        //
+                        // SETS
+                        //
+                        std::vector<misc::IntervalSet*> sets;
+                        sets.reserve(header.nsets);
+                        for (uint32_t i = 0; i < header.nsets; i++) {
+                            const ATNImage::Set &record = image.sets()[i];
+                            checkCondition((uint64_t)record.firstInterval + record.nintervals <= header.nintervals, L"set intervals out of range");
+                            const misc::Interval *first = image.intervals() + record.firstInterval;
+                            sets.push_back(new misc::IntervalSet(std::vector<misc::Interval>(first, first + record.nintervals)));
+                        }
+
+                        //
+                        // EDGES
+                        //
+                        const ATNImage::Edge *edges = image.edges();
+                        for (uint32_t i = 0; i < header.nstates; i++) {
+                            const ATNImage::State &record = states[i];
+                            checkCondition((uint64_t)record.firstEdge + record.nedges <= header.nedges, L"state edges out of range");
+                            for (uint32_t e = record.firstEdge; e < record.firstEdge + record.nedges; e++) {
+                                const ATNImage::Edge &edge = edges[e];
+                                checkCondition((uint32_t)edge.target < header.nstates, L"edge target out of range");
+                                checkCondition(atn->states[edge.target] != nullptr, L"edge targets an invalid state");
+                                atn->states[i]->addTransition(edgeFactory(atn, edge.type, (int)i, edge.target, edge.arg1, edge.arg2, edge.arg3, sets));
+                            }
+                        }
+
+                        linkStates(atn);
+
+                        //
+                        // DECISIONS
+                        //
+                        atn->decisionToState.reserve(header.ndecisions);
+                        for (uint32_t i = 0; i < header.ndecisions; i++) {
+                            checkCondition((uint32_t)image.decisions()[i] < header.nstates, L"decision state out of range");
+                            DecisionState *decState = dynamic_cast<DecisionState*>(atn->states[image.decisions()[i]]);
+                            checkCondition(decState != nullptr, L"decision state is not a decision state");
+                            atn->decisionToState.push_back(decState);
+                            decState->decision = (int)i;
+                        }
+
+                        finalizeATN(atn);
+
+                        return atn;
+                    }
+
+                    void ATNDeserializer::linkStates(ATN *atn) {
                         // edges for rule stop states can be derived, so they aren't serialized
                         for (ATNState *state : atn->states) {
+                            if (state == nullptr) {
+                                continue;
+                            }
+
                             for (int i = 0; i < state->getNumberOfTransitions(); i++) {
                                 Transition *t = state->transition(i);
                                 if (!(dynamic_cast<RuleTransition*>(t) != nullptr)) {
@@ -326,18 +502,10 @@ namespace org {
                                 }
                             }
                         }
+                    }
 
-                        //
-                        // DECISIONS
-                        //
-                        int ndecisions = toInt(data[p++]);
-                        for (int i = 1; i <= ndecisions; i++) {
-                            int s = toInt(data[p++]);
-                            DecisionState *decState = static_cast<DecisionState*>(atn->states[s]);
-                            // TODO: decisionToState was originally declared as const in ATN
-                            atn->decisionToState.push_back(decState);
-                            decState->decision = i - 1;
-                        }
+                    void ATNDeserializer::finalizeATN(ATN *atn) {
+                        markPrecedenceDecisions(atn);
 
                         if (deserializationOptions->isVerifyATN()) {
                             verifyATN(atn);
@@ -377,11 +545,14 @@ namespace org {
                                             continue;
                                         }
 
+                                        checkCondition(state->getNumberOfTransitions() > 0, L"star loop entry state has no transitions");
                                         ATNState *maybeLoopEndState = state->transition(state->getNumberOfTransitions() - 1)->target;
                                         if (!(dynamic_cast<LoopEndState*>(maybeLoopEndState) != nullptr)) {
                                             continue;
                                         }
 
+                                        checkCondition(maybeLoopEndState->getNumberOfTransitions() > 0, L"loop end state has no transitions");
+
                                         if (maybeLoopEndState->epsilonOnlyTransitions && dynamic_cast<RuleStopState*>(maybeLoopEndState->transition(0)->target) != nullptr) {
                                             endState = state;
                                             break;
@@ -432,8 +603,28 @@ namespace org {
                                 verifyATN(atn);
                             }
                         }
+                    }
 
-                        return atn;
+                    void ATNDeserializer::markPrecedenceDecisions(ATN *atn) {
+                        for (ATNState *state : atn->states) {
+                            if (dynamic_cast<StarLoopEntryState*>(state) == nullptr) {
+                                continue;
+                            }
+
+                            // We analyze the ATN to determine if this ATN decision state is the
+                            // decision for the closure block that determines whether a
+                            // precedence rule should continue or complete.
+                            if (atn->ruleToStartState[state->ruleIndex]->isPrecedenceRule) {
+                                checkCondition(state->getNumberOfTransitions() > 0, L"star loop entry state has no transitions");
+                                ATNState *maybeLoopEndState = state->transition(state->getNumberOfTransitions() - 1)->target;
+                                if (dynamic_cast<LoopEndState*>(maybeLoopEndState) != nullptr) {
+                                    checkCondition(maybeLoopEndState->getNumberOfTransitions() > 0, L"loop end state has no transitions");
+                                    if (maybeLoopEndState->epsilonOnlyTransitions && dynamic_cast<RuleStopState*>(maybeLoopEndState->transition(0)->target) != nullptr) {
+                                        static_cast<StarLoopEntryState*>(state)->precedenceRuleDecision = true;
+                                    }
+                                }
+                            }
+                        }
                     }
 
                     void ATNDeserializer::verifyATN(ATN *atn) {
@@ -538,6 +729,7 @@ namespace org {
                                     return new RangeTransition(target, arg1, arg2);
                                 }
                             case Transition::RULE :
+                                checkCondition(arg1 >= 0 && (size_t)arg1 < atn->states.size() && dynamic_cast<RuleStartState*>(atn->states[arg1]) != nullptr, L"rule edge does not lead to a rule start state");
                                 return new RuleTransition(static_cast<RuleStartState*>(atn->states[arg1]), arg2, arg3, target);
                             case Transition::PREDICATE :
                                 return new PredicateTransition(target, arg1, arg2, arg3 != 0);
@@ -552,8 +744,10 @@ namespace org {
                             case Transition::ACTION :
                                 return new ActionTransition(target, arg1, arg2, arg3 != 0);
                             case Transition::SET :
+                                checkCondition(arg1 >= 0 && (size_t)arg1 < sets.size(), L"set index out of range");
                                 return new SetTransition(target, sets[arg1]);
                             case Transition::NOT_SET :
+                                checkCondition(arg1 >= 0 && (size_t)arg1 < sets.size(), L"set index out of range");
                                 return new NotSetTransition(target, sets[arg1]);
                             case Transition::WILDCARD :
                                 return new WildcardTransition(target);
@@ -100,6 +100,39 @@ namespace org {
                     public:
                         virtual ATN *deserialize(wchar_t data[]);
 
+                        /// <summary>
+                        /// Builds an ATN from a binary image in one pass over its flat arrays.
+                        /// Unlike the character form nothing has to be decoded: record fields
+                        /// are read in place, so {@code image} may view a memory mapped file.
+                        /// The deserialization options apply as for the character form.
+                        /// <p/>
+                        /// Every index, link and flag in the image is checked against the
+                        /// counts in its header and the types of the states involved before it
+                        /// is used, and an image that doesn't hold together is rejected.
+                        /// </summary>
+                        virtual ATN *deserialize(const ATNImage &image);
+
+                    protected:
+                        /// <summary>
+                        /// Adds the derived rule stop state edges and connects block end and
+                        ///  loop states to their start states, once all edges are present.
+                        /// </summary>
+                        virtual void linkStates(ATN *atn);
+
+                        /// <summary>
+                        /// Verifies the ATN and generates rule bypass transitions as the
+                        ///  deserialization options ask, once the decisions are known.
+                        /// </summary>
+                        virtual void finalizeATN(ATN *atn);
+
+                        /// <summary>
+                        /// Analyze the <seealso cref="StarLoopEntryState"/> states in the specified ATN to set
+                        /// the <seealso cref="StarLoopEntryState#precedenceRuleDecision"/> field to the
+                        /// correct value.
+                        /// </summary>
+                        /// <param name="atn"> The ATN. </param>
+                        virtual void markPrecedenceDecisions(ATN *atn);
+
                     public:
                         virtual void verifyATN(ATN *atn);
 
@@ -0,0 +1,209 @@
+﻿#include "ATNImage.h"
+#include "Exceptions.h"
+
+#include <fstream>
+#include <iterator>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    static_assert(sizeof(ATNImage::Header) == 13 * 4, "ATNImage::Header must not contain padding");
+                    static_assert(sizeof(ATNImage::State) == 6 * 4, "ATNImage::State must not contain padding");
+                    static_assert(sizeof(ATNImage::Edge) == 5 * 4, "ATNImage::Edge must not contain padding");
+                    static_assert(sizeof(ATNImage::Rule) == 3 * 4, "ATNImage::Rule must not contain padding");
+                    static_assert(sizeof(ATNImage::Set) == 2 * 4, "ATNImage::Set must not contain padding");
+                    static_assert(sizeof(misc::Interval) == 2 * 4, "intervals are stored as misc::Interval");
+
+                    ATNImage::ATNImage(const void *data, size_t length) : mapping(nullptr) {
+                        attach(data, length);
+                    }
+
+                    ATNImage::ATNImage(std::vector<char> image) : mapping(nullptr), copy(std::move(image)) {
+                        attach(copy.data(), copy.size());
+                    }
+
+                    ATNImage *ATNImage::map(const std::string &path) {
+#ifdef _WIN32
+                        std::ifstream in(path, std::ios::binary);
+                        if (!in) {
+                            throw IOException(L"cannot open ATN image");
+                        }
+                        std::vector<char> image((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                        return new ATNImage(std::move(image));
+#else
+                        int fd = ::open(path.c_str(), O_RDONLY);
+                        if (fd < 0) {
+                            throw IOException(L"cannot open ATN image");
+                        }
+                        struct stat st;
+                        if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+                            ::close(fd);
+                            throw IOException(L"cannot read ATN image");
+                        }
+                        size_t length = (size_t)st.st_size;
+                        void *p = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+                        ::close(fd);
+                        if (p == MAP_FAILED) {
+                            throw IOException(L"cannot map ATN image");
+                        }
+
+                        ATNImage *image;
+                        try {
+                            image = new ATNImage(p, length);
+                        } catch (...) {
+                            ::munmap(p, length);
+                            throw;
+                        }
+                        image->mapping = p;
+                        return image;
+#endif
+                    }
+
+                    ATNImage::~ATNImage() {
+#ifndef _WIN32
+                        if (mapping != nullptr) {
+                            ::munmap(mapping, length);
+                        }
+#endif
+                    }
+
+                    size_t ATNImage::sizeOf(const Header &header) {
+                        return sizeof(Header)
+                            + header.nstates * sizeof(State)
+                            + header.nedges * sizeof(Edge)
+                            + header.nrules * sizeof(Rule)
+                            + header.nmodes * sizeof(int32_t)
+                            + header.nsets * sizeof(Set)
+                            + header.nintervals * sizeof(misc::Interval)
+                            + header.ndecisions * sizeof(int32_t);
+                    }
+
+                    void ATNImage::attach(const void *data, size_t length) {
+                        if (((uintptr_t)data & 3) != 0) {
+                            throw IllegalArgumentException(L"ATN image is not 4-byte aligned");
+                        }
+                        if (length < sizeof(Header)) {
+                            throw IllegalArgumentException(L"ATN image is truncated");
+                        }
+
+                        const Header *h = static_cast<const Header*>(data);
+                        if (h->magic != MAGIC) {
+                            throw IllegalArgumentException(L"not an ATN image");
+                        }
+                        if (h->byteOrder != BYTE_ORDER_MARK) {
+                            throw IllegalArgumentException(L"ATN image was written on a machine with a different byte order");
+                        }
+                        if (h->version != VERSION) {
+                            throw IllegalArgumentException(L"unsupported ATN image version");
+                        }
+                        // 64-bit arithmetic: the counts are untrusted and must not wrap
+                        uint64_t expected = sizeof(Header)
+                            + (uint64_t)h->nstates * sizeof(State)
+                            + (uint64_t)h->nedges * sizeof(Edge)
+                            + (uint64_t)h->nrules * sizeof(Rule)
+                            + (uint64_t)h->nmodes * sizeof(int32_t)
+                            + (uint64_t)h->nsets * sizeof(Set)
+                            + (uint64_t)h->nintervals * sizeof(misc::Interval)
+                            + (uint64_t)h->ndecisions * sizeof(int32_t);
+                        if (expected != h->size || expected > length) {
+                            throw IllegalArgumentException(L"ATN image is truncated");
+                        }
+
+                        this->data = static_cast<const char*>(data);
+                        this->length = length;
+
+                        const char *p = this->data + sizeof(Header);
+                        _states = reinterpret_cast<const State*>(p);
+                        p += h->nstates * sizeof(State);
+                        _edges = reinterpret_cast<const Edge*>(p);
+                        p += h->nedges * sizeof(Edge);
+                        _rules = reinterpret_cast<const Rule*>(p);
+                        p += h->nrules * sizeof(Rule);
+                        _modes = reinterpret_cast<const int32_t*>(p);
+                        p += h->nmodes * sizeof(int32_t);
+                        _sets = reinterpret_cast<const Set*>(p);
+                        p += h->nsets * sizeof(Set);
+                        _intervals = reinterpret_cast<const misc::Interval*>(p);
+                        p += h->nintervals * sizeof(misc::Interval);
+                        _decisions = reinterpret_cast<const int32_t*>(p);
+                    }
+
+                    const ATNImage::Header &ATNImage::header() const {
+                        return *reinterpret_cast<const Header*>(data);
+                    }
+
+                    const ATNImage::State *ATNImage::states() const {
+                        return _states;
+                    }
+
+                    const ATNImage::Edge *ATNImage::edges() const {
+                        return _edges;
+                    }
+
+                    const ATNImage::Rule *ATNImage::rules() const {
+                        return _rules;
+                    }
+
+                    const int32_t *ATNImage::modes() const {
+                        return _modes;
+                    }
+
+                    const ATNImage::Set *ATNImage::sets() const {
+                        return _sets;
+                    }
+
+                    const misc::Interval *ATNImage::intervals() const {
+                        return _intervals;
+                    }
+
+                    const int32_t *ATNImage::decisions() const {
+                        return _decisions;
+                    }
+
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,195 @@
+﻿#pragma once
+
+#include "Declarations.h"
+#include "Interval.h"
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    /// <summary>
+                    /// A read-only view of an ATN in the binary image format written by
+                    /// <seealso cref="ATNSerializer#serializeImage"/>.
+                    /// <p/>
+                    /// The image is a header followed by flat arrays of fixed-size records
+                    /// (states, edges, rules, mode start states, sets, intervals and decision
+                    /// states), every field a native 32-bit integer, so the records can be
+                    /// used in place straight out of a memory mapped file. Nothing is decoded
+                    /// or copied when the view is created; only the header is checked.
+                    /// <seealso cref="ATNDeserializer#deserialize(const ATNImage&)"/> turns a
+                    /// view into an <seealso cref="ATN"/> in a single pass over the arrays.
+                    /// <p/>
+                    /// The edges of a state are stored contiguously, in transition order.
+                    /// Rule stop state edges are derived on load and never stored. Token
+                    /// types and action indexes are stored as they are, {@code -1} included.
+                    /// </summary>
+                    class ATNImage {
+                    public:
+                        static const uint32_t MAGIC = 0x4E544142; // "BATN" in a little endian file
+                        static const uint32_t VERSION = 1;
+                        static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+                        /// <summary>
+                        /// Flags of a <seealso cref="State"/> record. </summary>
+                        static const uint32_t NON_GREEDY = 1;
+                        static const uint32_t PRECEDENCE_RULE = 2;
+
+                        struct Header {
+                            uint32_t magic;
+                            uint32_t version;
+                            uint32_t byteOrder;
+                            /// <summary>
+                            /// Total size of the image in bytes, header included. </summary>
+                            uint32_t size;
+                            int32_t grammarType;
+                            int32_t maxTokenType;
+                            uint32_t nstates;
+                            uint32_t nedges;
+                            uint32_t nrules;
+                            uint32_t nmodes;
+                            uint32_t nsets;
+                            uint32_t nintervals;
+                            uint32_t ndecisions;
+                        };
+
+                        struct State {
+                            int32_t type;
+                            int32_t ruleIndex;
+                            /// <summary>
+                            /// Loop back state of a loop end state, end state of a block
+                            ///  start state, otherwise -1. </summary>
+                            int32_t link;
+                            uint32_t flags;
+                            uint32_t firstEdge;
+                            uint32_t nedges;
+                        };
+
+                        /// <summary>
+                        /// The arguments mean what they mean in the character serialization,
+                        ///  minus its encoding tricks: a rule edge targets its follow state
+                        ///  with the rule start state in arg1, and a set edge has the set
+                        ///  index in arg1.
+                        /// </summary>
+                        struct Edge {
+                            int32_t type;
+                            int32_t target;
+                            int32_t arg1;
+                            int32_t arg2;
+                            int32_t arg3;
+                        };
+
+                        struct Rule {
+                            int32_t startState;
+                            int32_t tokenType;
+                            int32_t actionIndex;
+                        };
+
+                        struct Set {
+                            uint32_t firstInterval;
+                            uint32_t nintervals;
+                        };
+
+                    private:
+                        const char *data;
+                        size_t length;
+                        void *mapping;
+                        std::vector<char> copy;
+
+                        const State *_states;
+                        const Edge *_edges;
+                        const Rule *_rules;
+                        const int32_t *_modes;
+                        const Set *_sets;
+                        const misc::Interval *_intervals;
+                        const int32_t *_decisions;
+
+                    public:
+                        /// <summary>
+                        /// Creates a view over an image owned by the caller, which must stay
+                        ///  alive and unchanged for as long as the view is in use. The data
+                        ///  must be 4-byte aligned.
+                        /// </summary>
+                        /// <exception cref="IllegalArgumentException"> if the header is not a
+                        ///  valid image header of this version and byte order, or the image
+                        ///  is truncated. </exception>
+                        ATNImage(const void *data, size_t length);
+
+                        /// <summary>
+                        /// Creates a view over a private copy of {@code image}. </summary>
+                        ATNImage(std::vector<char> image);
+
+                        /// <summary>
+                        /// Maps the image file at {@code path} read-only into memory. Pages of
+                        ///  the same file are shared between all processes that map it. Where
+                        ///  memory mapping is not available the file is read instead.
+                        /// </summary>
+                        /// <exception cref="IOException"> if the file cannot be opened or
+                        ///  mapped. </exception>
+                        static ATNImage *map(const std::string &path);
+
+                        virtual ~ATNImage();
+
+                        const Header &header() const;
+                        const State *states() const;
+                        const Edge *edges() const;
+                        const Rule *rules() const;
+                        const int32_t *modes() const;
+                        const Set *sets() const;
+                        const misc::Interval *intervals() const;
+                        const int32_t *decisions() const;
+
+                        /// <summary>
+                        /// The number of bytes an image with the counts of {@code header}
+                        ///  occupies. </summary>
+                        static size_t sizeOf(const Header &header);
+
+                    private:
+                        ATNImage(const ATNImage&) = delete;
+                        ATNImage &operator=(const ATNImage&) = delete;
+
+                        void attach(const void *data, size_t length);
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -3,6 +3,7 @@
 
 #include "ATNSerializer.h"
 #include "ATNDeserializer.h"
+#include "ATNImage.h"
 #include "IntervalSet.h"
 #include "ATNState.h"
 #include "DecisionState.h"
@@ -179,25 +180,25 @@ std::vector<int>* ATNSerializer::serialize() {
   data->push_back(nsets);
   for (auto set : sets) {
     bool containsEof = set->contains(Token::_EOF);
-    if (containsEof && set->getIntervals().at(0)->b == Token::_EOF) {
+    if (containsEof && set->getIntervals().at(0).b == Token::_EOF) {
       data->push_back(set->getIntervals().size() - 1);
     } else {
       data->push_back(set->getIntervals().size());
     }
 
     data->push_back(containsEof ? 1 : 0);
-    for (misc::Interval *I : set->getIntervals()) {
-      if (I->a == Token::_EOF) {
-        if (I->b == Token::_EOF) {
+    for (const misc::Interval &I : set->getIntervals()) {
+      if (I.a == Token::_EOF) {
+        if (I.b == Token::_EOF) {
           continue;
         } else {
           data->push_back(0);
         }
       } else {
-        data->push_back(I->a);
+        data->push_back(I.a);
       }
 
-      data->push_back(I->b);
+      data->push_back(I.b);
     }
   }
 
@@ -309,6 +310,173 @@ std::vector<int>* ATNSerializer::serialize() {
   return data;
 }
 
+std::vector<char> ATNSerializer::serializeImage() {
+  ATNImage::Header header = ATNImage::Header();
+  header.magic = ATNImage::MAGIC;
+  header.version = ATNImage::VERSION;
+  header.byteOrder = ATNImage::BYTE_ORDER_MARK;
+  header.grammarType = static_cast<int32_t>(atn->grammarType);
+  header.maxTokenType = atn->maxTokenType;
+
+  std::vector<ATNImage::State> states;
+  std::vector<ATNImage::Edge> edges;
+  std::unordered_map<misc::IntervalSet *, int> setIndices;
+  std::vector<misc::IntervalSet *> sets;
+
+  states.reserve(atn->states.size());
+  for (ATNState *s : atn->states) {
+    ATNImage::State record = ATNImage::State();
+    record.link = -1;
+    record.firstEdge = (uint32_t)edges.size();
+    if (s == nullptr) {  // might be optimized away
+      record.type = ATNState::INVALID_TYPE;
+      record.ruleIndex = -1;
+      states.push_back(record);
+      continue;
+    }
+
+    record.type = s->getStateType();
+    record.ruleIndex = s->ruleIndex;
+    if (record.type == ATNState::LOOP_END) {
+      record.link = (static_cast<LoopEndState *>(s))->loopBackState->stateNumber;
+    } else if (dynamic_cast<BlockStartState *>(s) != nullptr) {
+      record.link = (static_cast<BlockStartState *>(s))->endState->stateNumber;
+    }
+
+    if (dynamic_cast<DecisionState *>(s) != nullptr &&
+        (static_cast<DecisionState *>(s))->nonGreedy) {
+      record.flags |= ATNImage::NON_GREEDY;
+    }
+
+    if (dynamic_cast<RuleStartState *>(s) != nullptr &&
+        (static_cast<RuleStartState *>(s))->isPrecedenceRule) {
+      record.flags |= ATNImage::PRECEDENCE_RULE;
+    }
+
+    // the deserializer derives rule stop state edges, as for the char form
+    if (record.type != ATNState::RULE_STOP) {
+      for (int i = 0; i < s->getNumberOfTransitions(); i++) {
+        Transition *t = s->transition(i);
+        if (atn->states[t->target->stateNumber] == nullptr) {
+          throw IllegalStateException(
+              L"Cannot serialize a transition to a removed state.");
+        }
+
+        ATNImage::Edge edge = ATNImage::Edge();
+        edge.type = t->getSerializationType();
+        edge.target = t->target->stateNumber;
+        switch (edge.type) {
+          case Transition::RULE: {
+            RuleTransition *rt = static_cast<RuleTransition *>(t);
+            edge.target = rt->followState->stateNumber;
+            edge.arg1 = rt->target->stateNumber;
+            edge.arg2 = rt->ruleIndex;
+            edge.arg3 = rt->precedence;
+            break;
+          }
+          case Transition::PRECEDENCE:
+            edge.arg1 = (static_cast<PrecedencePredicateTransition *>(t))->precedence;
+            break;
+          case Transition::PREDICATE: {
+            PredicateTransition *pt = static_cast<PredicateTransition *>(t);
+            edge.arg1 = pt->ruleIndex;
+            edge.arg2 = pt->predIndex;
+            edge.arg3 = pt->isCtxDependent ? 1 : 0;
+            break;
+          }
+          case Transition::RANGE:
+            edge.arg1 = (static_cast<RangeTransition *>(t))->from;
+            edge.arg2 = (static_cast<RangeTransition *>(t))->to;
+            break;
+          case Transition::ATOM:
+            edge.arg1 = (static_cast<AtomTransition *>(t))->_label;
+            break;
+          case Transition::ACTION: {
+            ActionTransition *at = static_cast<ActionTransition *>(t);
+            edge.arg1 = at->ruleIndex;
+            edge.arg2 = at->actionIndex;
+            edge.arg3 = at->isCtxDependent ? 1 : 0;
+            break;
+          }
+          case Transition::SET:
+          case Transition::NOT_SET: {
+            misc::IntervalSet *set = (static_cast<SetTransition *>(t))->set;
+            auto it = setIndices.find(set);
+            if (it == setIndices.end()) {
+              it = setIndices.emplace(set, (int)sets.size()).first;
+              sets.push_back(set);
+            }
+            edge.arg1 = it->second;
+            break;
+          }
+        }
+        edges.push_back(edge);
+      }
+    }
+
+    record.nedges = (uint32_t)edges.size() - record.firstEdge;
+    states.push_back(record);
+  }
+
+  std::vector<ATNImage::Rule> rules;
+  rules.reserve(atn->ruleToStartState.size());
+  for (size_t r = 0; r < atn->ruleToStartState.size(); r++) {
+    ATNImage::Rule rule = ATNImage::Rule();
+    rule.startState = atn->ruleToStartState[r]->stateNumber;
+    if (atn->grammarType == ATNType::LEXER) {
+      rule.tokenType = atn->ruleToTokenType[r];
+      rule.actionIndex = atn->ruleToActionIndex[r];
+    }
+    rules.push_back(rule);
+  }
+
+  std::vector<int32_t> modes;
+  for (const auto &modeStartState : *atn->modeToStartState) {
+    modes.push_back(modeStartState->stateNumber);
+  }
+
+  std::vector<ATNImage::Set> setRecords;
+  std::vector<misc::Interval> intervals;
+  for (misc::IntervalSet *set : sets) {
+    ATNImage::Set record;
+    record.firstInterval = (uint32_t)intervals.size();
+    record.nintervals = (uint32_t)set->getIntervals().size();
+    intervals.insert(intervals.end(), set->getIntervals().begin(),
+                     set->getIntervals().end());
+    setRecords.push_back(record);
+  }
+
+  std::vector<int32_t> decisions;
+  for (DecisionState *decStartState : atn->decisionToState) {
+    decisions.push_back(decStartState->stateNumber);
+  }
+
+  header.nstates = (uint32_t)states.size();
+  header.nedges = (uint32_t)edges.size();
+  header.nrules = (uint32_t)rules.size();
+  header.nmodes = (uint32_t)modes.size();
+  header.nsets = (uint32_t)setRecords.size();
+  header.nintervals = (uint32_t)intervals.size();
+  header.ndecisions = (uint32_t)decisions.size();
+  header.size = (uint32_t)ATNImage::sizeOf(header);
+
+  std::vector<char> image;
+  image.reserve(header.size);
+  auto append = [&image](const void *p, size_t n) {
+    image.insert(image.end(), static_cast<const char *>(p),
+                 static_cast<const char *>(p) + n);
+  };
+  append(&header, sizeof(header));
+  append(states.data(), states.size() * sizeof(ATNImage::State));
+  append(edges.data(), edges.size() * sizeof(ATNImage::Edge));
+  append(rules.data(), rules.size() * sizeof(ATNImage::Rule));
+  append(modes.data(), modes.size() * sizeof(int32_t));
+  append(setRecords.data(), setRecords.size() * sizeof(ATNImage::Set));
+  append(intervals.data(), intervals.size() * sizeof(misc::Interval));
+  append(decisions.data(), decisions.size() * sizeof(int32_t));
+  return image;
+}
+
 std::wstring ATNSerializer::decode(wchar_t data[]) {
   data = data->clone();
   // don't adjust the first value since that's the version number
@@ -529,6 +697,10 @@ std::wstring ATNSerializer::getDecoded(ATN *atn,
   return (new ATNSerializer(atn, tokenNames))->decode(data);
 }
 
+std::vector<char> ATNSerializer::getSerializedAsImage(ATN *atn) {
+  return ATNSerializer(atn).serializeImage();
+}
+
 void ATNSerializer::serializeUUID(std::vector<int> *data, UUID *uuid) {
   serializeLong(data, uuid->getLeastSignificantBits());
   serializeLong(data, uuid->getMostSignificantBits());
@@ -83,6 +83,15 @@ class ATNSerializer {
   /// </summary>
   virtual std::vector<int> *serialize();
 
+  /// <summary>
+  /// Serialize the ATN into the binary image format read by
+  /// <seealso cref="ATNImage"/>: a header followed by flat, fixed-size state,
+  /// edge, rule, mode, set, interval and decision records. Fields are native
+  /// 32-bit integers, so an image is only valid on machines with the byte
+  /// order of the one that wrote it; the header records which one that is.
+  /// </summary>
+  virtual std::vector<char> serializeImage();
+
   virtual std::wstring decode(wchar_t data[]);
 
   virtual std::wstring getTokenName(int t);
@@ -96,6 +105,8 @@ class ATNSerializer {
 
   static wchar_t *getSerializedAsChars(ATN *atn);
 
+  static std::vector<char> getSerializedAsImage(ATN *atn);
+
   static std::wstring getDecoded(ATN *atn,
                                  std::vector<std::wstring> &tokenNames);
 
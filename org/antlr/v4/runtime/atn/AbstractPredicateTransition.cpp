@@ -6,7 +6,7 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
-                    AbstractPredicateTransition::AbstractPredicateTransition(ATNState *target) : Transition(target) {
+                    AbstractPredicateTransition::AbstractPredicateTransition(ATNState *target, int serializationType) : Transition(target, serializationType) {
                     }
                 }
             }
@@ -46,7 +46,7 @@ namespace org {
                     class AbstractPredicateTransition : public Transition {
 
                     public:
-                        AbstractPredicateTransition(ATNState *target);
+                        AbstractPredicateTransition(ATNState *target, int serializationType);
 
                     };
 
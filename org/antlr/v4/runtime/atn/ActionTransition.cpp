@@ -36,10 +36,10 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
-                    ActionTransition::ActionTransition(ATNState *target, int ruleIndex) : Transition(target), ruleIndex(ruleIndex), actionIndex(0), isCtxDependent(false) {
+                    ActionTransition::ActionTransition(ATNState *target, int ruleIndex) : Transition(target, ACTION), ruleIndex(ruleIndex), actionIndex(0), isCtxDependent(false) {
                     }
 
-                    ActionTransition::ActionTransition(ATNState *target, int ruleIndex, int actionIndex, bool isCtxDependent) : Transition(target), ruleIndex(ruleIndex), actionIndex(actionIndex), isCtxDependent(isCtxDependent) {
+                    ActionTransition::ActionTransition(ATNState *target, int ruleIndex, int actionIndex, bool isCtxDependent) : Transition(target, ACTION), ruleIndex(ruleIndex), actionIndex(actionIndex), isCtxDependent(isCtxDependent) {
                     }
 
                     int ActionTransition::getSerializationType() {
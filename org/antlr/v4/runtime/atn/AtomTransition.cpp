@@ -38,7 +38,8 @@ namespace org {
                 namespace atn {
 
 
-                    AtomTransition::AtomTransition(ATNState *target, int label) : Transition(target), _label(label) {
+                    AtomTransition::AtomTransition(ATNState *target, int label) : Transition(target, ATOM), _label(label) {
+                        matchFrom = matchTo = label;
                     }
 
                     int AtomTransition::getSerializationType() {
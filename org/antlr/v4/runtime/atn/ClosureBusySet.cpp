@@ -0,0 +1,125 @@
+﻿#include "ClosureBusySet.h"
+#include "ATNConfig.h"
+#include "ATNState.h"
+#include "PredictionContext.h"
+#include "SemanticContext.h"
+#include "MurmurHash.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    ClosureBusySet::ClosureBusySet() : slots(INITIAL_CAPACITY), count(0), epoch(1) {
+                    }
+
+                    void ClosureBusySet::clear() {
+                        count = 0;
+                        if (++epoch == 0) {
+                            // slots stamped in the last round of epochs would look in use again
+                            for (Slot &slot : slots) {
+                                slot.epoch = 0;
+                            }
+                            epoch = 1;
+                        }
+                    }
+
+                    bool ClosureBusySet::add(ATNConfig *config) {
+                        return add(config->state, config->alt, config->context, config->semanticContext);
+                    }
+
+                    bool ClosureBusySet::add(ATNState *state, int alt, PredictionContext *context, SemanticContext *semanticContext) {
+                        if ((count + 1) * 2 > slots.size()) {
+                            grow();
+                        }
+
+                        int stateNumber = state->stateNumber;
+                        int hash = hashOf(stateNumber, alt, context, semanticContext);
+                        size_t mask = slots.size() - 1;
+                        for (size_t i = (size_t)(unsigned int)hash & mask; ; i = (i + 1) & mask) {
+                            Slot &slot = slots[i];
+                            if (slot.epoch != epoch) {
+                                slot.epoch = epoch;
+                                slot.hash = hash;
+                                slot.state = stateNumber;
+                                slot.alt = alt;
+                                slot.context = context;
+                                slot.semanticContext = semanticContext;
+                                count++;
+                                return true;
+                            }
+
+                            // semantic contexts are interned; contexts are usually shared
+                            if (slot.hash == hash && slot.state == stateNumber && slot.alt == alt && slot.semanticContext == semanticContext && (slot.context == context || (slot.context != nullptr && context != nullptr && slot.context->equals(context)))) {
+                                return false;
+                            }
+                        }
+                    }
+
+                    size_t ClosureBusySet::size() const {
+                        return count;
+                    }
+
+                    void ClosureBusySet::grow() {
+                        std::vector<Slot> old(slots.size() * 2);
+                        old.swap(slots);
+
+                        size_t mask = slots.size() - 1;
+                        for (const Slot &slot : old) {
+                            if (slot.epoch != epoch) {
+                                continue;
+                            }
+
+                            size_t i = (size_t)(unsigned int)slot.hash & mask;
+                            while (slots[i].epoch == epoch) {
+                                i = (i + 1) & mask;
+                            }
+                            slots[i] = slot;
+                        }
+                    }
+
+                    int ClosureBusySet::hashOf(int state, int alt, PredictionContext *context, SemanticContext *semanticContext) {
+                        int hash = misc::MurmurHash::initialize(7);
+                        hash = misc::MurmurHash::update(hash, state);
+                        hash = misc::MurmurHash::update(hash, alt);
+                        hash = misc::MurmurHash::update(hash, context != nullptr ? context->hashCode() : 0);
+                        hash = misc::MurmurHash::update(hash, semanticContext != nullptr ? semanticContext->hashCode() : 0);
+                        return misc::MurmurHash::finish(hash, 4);
+                    }
+
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,108 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    /// <summary>
+                    /// The set of configurations an epsilon closure has already visited, as
+                    ///  used by <seealso cref="ParserATNSimulator#closure"/> and
+                    ///  <seealso cref="LL1Analyzer#_LOOK"/> to stop on left-recursive cycles.
+                    /// <p/>
+                    /// Configurations are keyed by {@code (s, i, ctx, pi)} and compared like
+                    ///  <seealso cref="ATNConfig#equals"/>, so a configuration rebuilt on another path
+                    ///  counts as visited. The keys are stored in an open-addressing table
+                    ///  whose slots are stamped with the epoch they were filled in; <seealso cref="#clear"/>
+                    ///  just starts a new epoch, so one set can be reused for every closure
+                    ///  without freeing or allocating anything once it has grown.
+                    /// </summary>
+                    class ClosureBusySet {
+                    private:
+                        struct Slot {
+                            unsigned int epoch;
+                            int hash;
+                            int state;
+                            int alt;
+                            PredictionContext *context;
+                            SemanticContext *semanticContext;
+                        };
+
+                        static const size_t INITIAL_CAPACITY = 64;
+
+                        /// <summary>
+                        /// A power of two in size, and never more than half full. A slot is in
+                        ///  use only if its epoch is the current one. </summary>
+                        std::vector<Slot> slots;
+                        size_t count;
+                        unsigned int epoch;
+
+                    public:
+                        ClosureBusySet();
+
+                        /// <summary>
+                        /// Empties the set. </summary>
+                        void clear();
+
+                        /// <summary>
+                        /// Adds {@code config}. Returns {@code false} if an equal configuration
+                        ///  was already in the set.
+                        /// </summary>
+                        bool add(ATNConfig *config);
+
+                        /// <summary>
+                        /// Adds the configuration {@code (state, alt, context, semanticContext)}
+                        ///  without having to build it. Returns {@code false} if it was already
+                        ///  in the set.
+                        /// </summary>
+                        bool add(ATNState *state, int alt, PredictionContext *context, SemanticContext *semanticContext);
+
+                        size_t size() const;
+
+                    private:
+                        void grow();
+
+                        static int hashOf(int state, int alt, PredictionContext *context, SemanticContext *semanticContext);
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -36,7 +36,7 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
-                    EpsilonTransition::EpsilonTransition(ATNState *target) : Transition(target) {
+                    EpsilonTransition::EpsilonTransition(ATNState *target) : Transition(target, EPSILON) {
                     }
 
                     int EpsilonTransition::getSerializationType() {
@@ -8,6 +8,7 @@
 #include "NotSetTransition.h"
 #include "IntervalSet.h"
 #include "ATNConfig.h"
+#include "SemanticContext.h"
 #include "ATN.h"
 
 #include <typeinfo>
@@ -61,9 +62,9 @@ namespace org {
                         // need s->getNumberOfTransitions()); of them
                         for (int alt = 0; alt < s->getNumberOfTransitions(); alt++) {
                             look[alt] = new misc::IntervalSet(0);
-                            std::set<ATNConfig*> *lookBusy = new std::set<ATNConfig*>();
+                            lookBusy.clear();
                             bool seeThruPreds = false; // fail to get lookahead upon pred
-                            _LOOK(s->transition(alt)->target, nullptr, (PredictionContext*)PredictionContext::EMPTY, look[alt], lookBusy, new std::bitset<BITSET_SIZE>(), seeThruPreds, false);
+                            _LOOK(s->transition(alt)->target, nullptr, (PredictionContext*)PredictionContext::EMPTY, look[alt], &lookBusy, new std::bitset<BITSET_SIZE>(), seeThruPreds, false);
                             // Wipe out lookahead for this alternative if we found nothing
                             // or we had a predicate when we !seeThruPreds
                             if (look[alt]->size() == 0 || look[alt]->contains(HIT_PRED)) {
@@ -82,15 +83,14 @@ namespace org {
                            misc::IntervalSet *r = new misc::IntervalSet(0);
                         bool seeThruPreds = true; // ignore preds; get all lookahead
                         PredictionContext *lookContext = ctx != nullptr ? PredictionContext::fromRuleContext(s->atn, ctx) : nullptr;
-                           _LOOK(s, stopState, lookContext, r, new std::set<ATNConfig*>(), new std::bitset<BITSET_SIZE>(), seeThruPreds, true);
+                           lookBusy.clear();
+                           _LOOK(s, stopState, lookContext, r, &lookBusy, new std::bitset<BITSET_SIZE>(), seeThruPreds, true);
                            return r;
                     }
 
-                    void LL1Analyzer::_LOOK(ATNState *s, ATNState *stopState, PredictionContext *ctx, misc::IntervalSet *look, std::set<ATNConfig*> *lookBusy,  std::bitset<BITSET_SIZE> *calledRuleStack, bool seeThruPreds, bool addEOF) {
+                    void LL1Analyzer::_LOOK(ATNState *s, ATNState *stopState, PredictionContext *ctx, misc::IntervalSet *look, ClosureBusySet *lookBusy,  std::bitset<BITSET_SIZE> *calledRuleStack, bool seeThruPreds, bool addEOF) {
                                         //		System.out.println("_LOOK("+s.stateNumber+", ctx="+ctx);
-                        ATNConfig *c = new ATNConfig(s, 0, ctx);
-                        
-                        if (!lookBusy->insert(c).second) {
+                        if (!lookBusy->add(s, 0, ctx, SemanticContext::NONE)) {
                             return;
                         }
 
@@ -104,7 +104,7 @@ namespace org {
                             }
                         }
 
-                        if (dynamic_cast<RuleStopState*>(s) != nullptr) {
+                        if (s->getStateType() == ATNState::RULE_STOP) {
                             if (ctx == nullptr) {
                                 look->add(Token::EPSILON);
                                 return;
@@ -121,7 +121,7 @@ namespace org {
 
                                     bool removed = calledRuleStack->test(returnState->ruleIndex);
                                     try {
-                                        calledRuleStack[returnState->ruleIndex] = false;
+                                        calledRuleStack->reset(returnState->ruleIndex);
                                         _LOOK(returnState, stopState, ctx->getParent(i), look, lookBusy, calledRuleStack, seeThruPreds, addEOF);
                                     }
                                     catch(...) {
@@ -136,11 +136,8 @@ namespace org {
                             }
                         }
 
-                        int n = s->getNumberOfTransitions();
-                        for (int i = 0; i < n; i++) {
-                            Transition *t = s->transition(i);
-                            
-                            if (typeid(t) == typeid(RuleTransition)) {
+                        for (Transition *t : s->transitions) {
+                            if (t->serializationType == Transition::RULE) {
                                 if ( (*calledRuleStack)[(static_cast<RuleTransition*>(t))->target->ruleIndex]) {
                                     continue;
                                 }
@@ -154,23 +151,23 @@ namespace org {
                                 catch(...) {
                                     // Just move to the next steps as a "finally" clause
                                 }
-                                calledRuleStack[((static_cast<RuleTransition*>(t))->target->ruleIndex)] = false;
+                                calledRuleStack->reset((static_cast<RuleTransition*>(t))->target->ruleIndex);
                                 
-                            } else if (dynamic_cast<AbstractPredicateTransition*>(t) != nullptr) {
+                            } else if (t->serializationType == Transition::PREDICATE || t->serializationType == Transition::PRECEDENCE) {
                                 if (seeThruPreds) {
                                     _LOOK(t->target, stopState, ctx, look, lookBusy, calledRuleStack, seeThruPreds, addEOF);
                                 } else {
                                     look->add(HIT_PRED);
                                 }
-                            } else if (t->isEpsilon()) {
+                            } else if (t->epsilon) {
                                 _LOOK(t->target, stopState, ctx, look, lookBusy, calledRuleStack, seeThruPreds, addEOF);
-                            } else if (typeid(t) == typeid(WildcardTransition)) {
+                            } else if (t->serializationType == Transition::WILDCARD) {
                                 look->addAll(misc::IntervalSet::of(Token::MIN_USER_TOKEN_TYPE, atn->maxTokenType));
                             } else {
                                         //				System.out.println("adding "+ t);
                                 misc::IntervalSet *set = t->label();
                                 if (set != nullptr) {
-                                    if (dynamic_cast<NotSetTransition*>(t) != nullptr) {
+                                    if (t->serializationType == Transition::NOT_SET) {
                                         set = set->complement(misc::IntervalSet::of(Token::MIN_USER_TOKEN_TYPE, atn->maxTokenType));
                                     }
                                     look->addAll(set);
@@ -2,6 +2,7 @@
 
 #include "Token.h"
 #include "Declarations.h"
+#include "ClosureBusySet.h"
 
 #include <set>
 #include <vector>
@@ -54,6 +55,12 @@ namespace org {
                         
                         atn::ATN *const atn;
 
+                    protected:
+                        /// <summary>
+                        /// Reused by every top-level call to <seealso cref="#_LOOK"/>. </summary>
+                        ClosureBusySet lookBusy;
+
+                    public:
                         LL1Analyzer(atn::ATN *atn);
 
                         /// <summary>
@@ -120,8 +127,8 @@ namespace org {
                         /// not be used. </param>
                         /// <param name="look"> The result lookahead set. </param>
                         /// <param name="lookBusy"> A set used for preventing epsilon closures in the ATN
-                        /// from causing a stack overflow. Outside code should pass
-                        /// {@code new HashSet<ATNConfig>} for this argument. </param>
+                        /// from causing a stack overflow. Outside code should pass an empty
+                        /// set for this argument. </param>
                         /// <param name="calledRuleStack"> A set used for preventing left recursion in the
                         /// ATN from causing a stack overflow. Outside code should pass
                         /// {@code new BitSet()} for this argument. </param>
@@ -133,7 +140,7 @@ namespace org {
                         /// outermost context is reached. This parameter has no effect if {@code ctx}
                         /// is {@code null}. </param>
                     protected:
-                        virtual void _LOOK(ATNState *s, ATNState *stopState, PredictionContext *ctx, misc::IntervalSet *look, std::set<ATNConfig*> *lookBusy, std::bitset<BITSET_SIZE> *calledRuleStack, bool seeThruPreds, bool addEOF);
+                        virtual void _LOOK(ATNState *s, ATNState *stopState, PredictionContext *ctx, misc::IntervalSet *look, ClosureBusySet *lookBusy, std::bitset<BITSET_SIZE> *calledRuleStack, bool seeThruPreds, bool addEOF);
                     };
 
                 }
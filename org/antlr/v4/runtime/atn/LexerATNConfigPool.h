@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+#include <new>
+
+#include "LexerATNConfig.h"
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    /// <summary>
+                    /// An arena for the <seealso cref="LexerATNConfig"/>s the lexer creates while
+                    /// computing closures for one token. Configurations are carved out of
+                    /// fixed-size chunks and all released together by <seealso cref="#reset"/>;
+                    /// the chunks themselves are kept, so once the pool has grown to the
+                    /// largest token seen, creating a configuration no longer allocates.
+                    /// <p/>
+                    /// Configurations that must outlive the token, i.e. those stored in a DFA
+                    /// state, have to be copied out of the pool first.
+                    /// </summary>
+                    class LexerATNConfigPool {
+                    public:
+                        static const size_t CHUNK_SIZE = 256;
+
+                    private:
+                        typedef std::aligned_storage<sizeof(LexerATNConfig), std::alignment_of<LexerATNConfig>::value>::type Slot;
+
+                        std::vector<Slot*> chunks;
+
+                        /// <summary>
+                        /// Number of slots handed out since the last reset. </summary>
+                        size_t used;
+
+                    public:
+                        LexerATNConfigPool();
+                        virtual ~LexerATNConfigPool();
+
+                        template<typename... Args>
+                        LexerATNConfig *create(Args... args) {
+                            return new (allocate()) LexerATNConfig(args...);
+                        }
+
+                        /// <summary>
+                        /// Destroys every configuration created since the last reset. </summary>
+                        void reset();
+
+                        size_t size() const {
+                            return used;
+                        }
+
+                    private:
+                        void *allocate();
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -16,9 +16,13 @@
 #include "ATN.h"
 #include "DFAState.h"
 #include "LexerATNConfig.h"
+#include "LexerATNConfigPool.h"
+#include "LexerActionExecutor.h"
 #include <assert.h>
 #include "LexerNoViableAltException.h"
 #include "Exceptions.h"
+#include <unordered_map>
+#include <algorithm>
 
 /*
  * [The "BSD license"]
@@ -60,8 +64,7 @@ namespace org {
                         index = -1;
                         line = 0;
                         charPos = -1;
-//JAVA TO C++ CONVERTER WARNING: Java to C++ Converter converted the original 'null' assignment to a call to 'delete', but you should review memory allocation of all pointer variables in the converted code:
-                        delete dfaState;
+                        dfaState = nullptr; // owned by the DFA
                     }
 
                     void LexerATNSimulator::SimState::InitializeInstanceFields() {
@@ -73,10 +76,11 @@ namespace org {
                     int LexerATNSimulator::match_calls = 0;
 
 
-                    LexerATNSimulator::LexerATNSimulator(ATN *atn, std::vector<dfa::DFA*> decisionToDFA, PredictionContextCache *sharedContextCache) : prevAccept(new SimState()), recog(nullptr) {
+                    LexerATNSimulator::LexerATNSimulator(ATN *atn, std::vector<dfa::DFA*> decisionToDFA, PredictionContextCache *sharedContextCache) : prevAccept(new SimState()), recog(nullptr), configPool(new LexerATNConfigPool()), closureScratch(new OrderedATNConfigSet()), reachScratch(new OrderedATNConfigSet()) {
+                        InitializeInstanceFields();
                     }
 
-                    LexerATNSimulator::LexerATNSimulator(Lexer *recog, ATN *atn, std::vector<dfa::DFA*> decisionToDFA, PredictionContextCache *sharedContextCache) : ATNSimulator(atn,sharedContextCache), recog(recog), decisionToDFA(decisionToDFA), prevAccept(new SimState()) {
+                    LexerATNSimulator::LexerATNSimulator(Lexer *recog, ATN *atn, std::vector<dfa::DFA*> decisionToDFA, PredictionContextCache *sharedContextCache) : ATNSimulator(atn,sharedContextCache), recog(recog), decisionToDFA(decisionToDFA), prevAccept(new SimState()), configPool(new LexerATNConfigPool()), closureScratch(new OrderedATNConfigSet()), reachScratch(new OrderedATNConfigSet()) {
                         InitializeInstanceFields();
                     }
 
@@ -94,11 +98,14 @@ namespace org {
                         try {
                             this->startIndex = input->index();
                             this->prevAccept->reset();
-                            dfa::DFA dfa = *decisionToDFA[mode];
-                            if (dfa.s0 == nullptr) {
+                            configPool->reset();
+                            dfa::DFA *dfa = decisionToDFA[mode];
+                            if (dfa->lexerTable != nullptr) {
+                                return execTable(input, dfa->lexerTable);
+                            } else if (dfa->s0 == nullptr) {
                                 return matchATN(input);
                             } else {
-                                return execATN(input, dfa.s0);
+                                return execATN(input, dfa->s0);
                             }
                         }
                         catch(...) {
@@ -107,6 +114,68 @@ namespace org {
                         return -1;
                     }
 
+                    bool LexerATNSimulator::compileDFATable(int mode, size_t maxStates) {
+                        int savedMode = this->mode;
+                        this->mode = mode;
+                        compilingTable = true;
+
+                        dfa::DFA *dfa = decisionToDFA[mode];
+                        dfa::LexerDFATable *table = new dfa::LexerDFATable(atn);
+                        ATNConfigSet *s0_closure = computeStartState(nullptr, (ATNState *)atn->modeToStartState->at(mode));
+                        bool compiled = !s0_closure->hasSemanticContext;
+                        if (compiled) {
+                            dfa::DFAState *s0 = addDFAState(s0_closure);
+                            std::unordered_map<dfa::DFAState*, int> rowOf;
+                            rowOf[s0] = table->addRow(s0);
+
+                            // rows are appended in breadth-first order, so the next row to
+                            // fill in is simply the first one not yet visited
+                            for (int row = 0; compiled && row < table->getNumberOfRows(); row++) {
+                                dfa::DFAState *s = table->stateAt(row);
+                                for (int cls = 0; cls < table->getNumberOfClasses(); cls++) {
+                                    configPool->reset();
+                                    ATNConfigSet *reach = clearScratch(reachScratch);
+                                    getReachableConfigSet(nullptr, s->configs, reach, table->representative(cls));
+                                    if (reach->hasSemanticContext) {
+                                        continue; // stays FALLBACK_ROW
+                                    }
+                                    if (reach->isEmpty()) {
+                                        table->setNext(row, cls, dfa::LexerDFATable::ERROR_ROW);
+                                        continue;
+                                    }
+
+                                    dfa::DFAState *target = addDFAState(reach);
+                                    std::unordered_map<dfa::DFAState*, int>::const_iterator it = rowOf.find(target);
+                                    if (it == rowOf.end()) {
+                                        if ((size_t)table->getNumberOfRows() >= maxStates) {
+                                            compiled = false;
+                                            break;
+                                        }
+                                        it = rowOf.insert(std::make_pair(target, table->addRow(target))).first;
+                                    }
+                                    table->setNext(row, cls, it->second);
+                                }
+                            }
+
+                            if (compiled) {
+                                table->computeLoops();
+                                if (dfa->s0 == nullptr) {
+                                    dfa->s0 = s0;
+                                }
+                                dfa->lexerTable = table;
+                            }
+                        }
+
+                        if (!compiled) {
+                            delete table;
+                        }
+
+                        configPool->reset();
+                        compilingTable = false;
+                        this->mode = savedMode;
+                        return compiled;
+                    }
+
                     void LexerATNSimulator::reset() {
                         prevAccept->reset();
                         startIndex = -1;
@@ -200,12 +269,55 @@ namespace org {
                         return failOrAccept(prevAccept, input, s->configs, t);
                     }
 
+                    int LexerATNSimulator::execTable(CharStream *input, dfa::LexerDFATable *table) {
+                        int row = 0;
+                        int t = input->LA(1);
+                        while (true) {
+                            if (!dfa::LexerDFATable::inAlphabet(t)) {
+                                // EOF or a character no class covers; let the ATN decide
+                                return execATN(input, table->stateAt(row));
+                            }
+
+                            int next = table->next(row, t);
+                            if (next == dfa::LexerDFATable::ERROR_ROW) {
+                                break;
+                            }
+                            if (next == dfa::LexerDFATable::FALLBACK_ROW) {
+                                return execATN(input, table->stateAt(row));
+                            }
+
+                            row = next;
+                            dfa::DFAState *target = table->stateAt(row);
+
+                            size_t available;
+                            const wchar_t *buffer;
+                            if (table->hasLoop(row) && (buffer = input->getBuffer(&available)) != nullptr) {
+                                // t and the run of looping characters after it all lead back
+                                // to row; skip to the last of them, which takes the regular
+                                // path below so the accept position is recorded as usual
+                                size_t run = table->scanLoop(row, buffer + 1, available - 1);
+                                if (run > 0) {
+                                    skipRun(input, buffer, run, table->loopHasNewlines(row));
+                                }
+                            }
+
+                            if (target->isAcceptState) {
+                                captureSimState(prevAccept, input, target);
+                            }
+
+                            consume(input);
+                            t = input->LA(1);
+                        }
+
+                        return failOrAccept(prevAccept, input, table->stateAt(row)->configs, t);
+                    }
+
                     dfa::DFAState *LexerATNSimulator::getExistingTargetState(dfa::DFAState *s, int t) {
-                        if (s->edges.size() == 0 || t < MIN_DFA_EDGE || t > MAX_DFA_EDGE) {
+                        if (t < MIN_DFA_EDGE || t > MAX_DFA_EDGE) {
                             return nullptr;
                         }
 
-                        dfa::DFAState *target = s->edges[t - MIN_DFA_EDGE];
+                        dfa::DFAState *target = s->edges.get(t - MIN_DFA_EDGE);
                         if (debug && target != nullptr) {
                             std::wcout << std::wstring(L"reuse state ") << s->stateNumber << std::wstring(L" edge to ") << target->stateNumber << std::endl;
                         }
@@ -214,7 +326,7 @@ namespace org {
                     }
 
                     dfa::DFAState *LexerATNSimulator::computeTargetState(CharStream *input, dfa::DFAState *s, int t) {
-                        ATNConfigSet *reach = new OrderedATNConfigSet();
+                        ATNConfigSet *reach = clearScratch(reachScratch);
 
                         // if we don't find an existing DFA state
                         // Fill reach starting from closure, following t transitions
@@ -234,9 +346,8 @@ namespace org {
 
                     int LexerATNSimulator::failOrAccept(SimState *prevAccept, CharStream *input, ATNConfigSet *reach, int t) {
                         if (prevAccept->dfaState != nullptr) {
-                            int ruleIndex = prevAccept->dfaState->lexerRuleIndex;
-                            int actionIndex = prevAccept->dfaState->lexerActionIndex;
-                            accept(input, ruleIndex, actionIndex, prevAccept->index, prevAccept->line, prevAccept->charPos);
+                            dfa::DFAState *accepted = prevAccept->dfaState;
+                            accept(input, accepted->lexerActionExecutor, accepted->lexerRuleIndex, accepted->lexerActionIndex, prevAccept->index, prevAccept->line, prevAccept->charPos);
                             return prevAccept->dfaState->prediction;
                         } else {
                             // if no accept and EOF is first char, return EOF
@@ -262,12 +373,10 @@ namespace org {
                                 std::wcout << L"testing " << getTokenName(t) << " at " <<c->toString(recog, true) << std::endl;
                             }
 
-                            int n = c->state->getNumberOfTransitions();
-                            for (int ti = 0; ti < n; ti++) { // for each transition
-                                Transition *trans = c->state->transition(ti);
+                            for (Transition *trans : c->state->transitions) { // for each transition
                                 ATNState *target = getReachableTarget(trans, t);
                                 if (target != nullptr) {
-                                    if (this->closure(input, new LexerATNConfig(static_cast<LexerATNConfig*>(c), target), reach, currentAltReachedAcceptState, true)) {
+                                    if (this->closure(input, configPool->create(static_cast<LexerATNConfig*>(c), target), reach, currentAltReachedAcceptState, true)) {
                                         // any remaining configs for this alt have a lower priority than
                                         // the one that just reached an accept state.
                                         skipAlt = c->alt;
@@ -278,7 +387,7 @@ namespace org {
                         }
                     }
 
-                    void LexerATNSimulator::accept(CharStream *input, int ruleIndex, int actionIndex, int index, int line, int charPos) {
+                    void LexerATNSimulator::accept(CharStream *input, LexerActionExecutor *lexerActionExecutor, int ruleIndex, int actionIndex, int index, int line, int charPos) {
                         if (debug) {
                             std::wcout << L"ACTION ";
                             if (recog != nullptr) {
@@ -289,7 +398,9 @@ namespace org {
                             std::wcout << ":" << actionIndex << std::endl;
                         }
 
-                        if (actionIndex >= 0 && recog != nullptr) {
+                        if (lexerActionExecutor != nullptr && recog != nullptr) {
+                            lexerActionExecutor->execute(recog, ruleIndex);
+                        } else if (actionIndex >= 0 && recog != nullptr) {
                             recog->action(nullptr, ruleIndex, actionIndex);
                         }
 
@@ -303,7 +414,7 @@ namespace org {
                     }
 
                     org::antlr::v4::runtime::atn::ATNState *LexerATNSimulator::getReachableTarget(Transition *trans, int t) {
-                        if (trans->matches(t, WCHAR_MIN, WCHAR_MAX)) {
+                        if (trans->matchesSymbol(t, WCHAR_MIN, WCHAR_MAX)) {
                             return trans->target;
                         }
 
@@ -312,10 +423,10 @@ namespace org {
 
                     org::antlr::v4::runtime::atn::ATNConfigSet *LexerATNSimulator::computeStartState(CharStream *input, ATNState *p) {
                         EmptyPredictionContext * initialContext  = PredictionContext::EMPTY;
-                        ATNConfigSet *configs = new OrderedATNConfigSet();
+                        ATNConfigSet *configs = clearScratch(closureScratch);
                         for (int i = 0; i < p->getNumberOfTransitions(); i++) {
                             ATNState *target = p->transition(i)->target;
-                            LexerATNConfig *c = new LexerATNConfig(target, i + 1, (PredictionContext*)initialContext);
+                            LexerATNConfig *c = configPool->create(target, i + 1, (PredictionContext*)initialContext);
                             closure(input, c, configs, false, false);
                         }
                         return configs;
@@ -326,7 +437,7 @@ namespace org {
                             std::wcout << L"closure(" << config->toString(recog, true) << L")" << std::endl;
                         }
 
-                        if (dynamic_cast<RuleStopState*>(config->state) != nullptr) {
+                        if (config->state->getStateType() == ATNState::RULE_STOP) {
                             if (debug) {
                                 if (recog != nullptr) {
                                     std::wcout << L"closure at " << recog->getRuleNames()[config->state->ruleIndex] << L" rule stop " << config << std::endl;
@@ -340,7 +451,7 @@ namespace org {
                                     configs->add(config);
                                     return true;
                                 } else {
-                                    configs->add(new LexerATNConfig(config, config->state, (PredictionContext*)PredictionContext::EMPTY));
+                                    configs->add(configPool->create(config, config->state, (PredictionContext*)PredictionContext::EMPTY));
                                     currentAltReachedAcceptState = true;
                                 }
                             }
@@ -350,7 +461,7 @@ namespace org {
                                     if (config->context->getReturnState(i) != PredictionContext::EMPTY_RETURN_STATE) {
                                         PredictionContext *newContext = config->context->getParent(i); // "pop" return state
                                         ATNState *returnState = atn->states[config->context->getReturnState(i)];
-                                        LexerATNConfig *c = new LexerATNConfig(returnState, config->alt, newContext);
+                                        LexerATNConfig *c = configPool->create(returnState, config->alt, newContext);
                                         currentAltReachedAcceptState = closure(input, c, configs, currentAltReachedAcceptState, speculative);
                                     }
                                 }
@@ -367,8 +478,7 @@ namespace org {
                         }
 
                         ATNState *p = config->state;
-                        for (int i = 0; i < p->getNumberOfTransitions(); i++) {
-                            Transition *t = p->transition(i);
+                        for (Transition *t : p->transitions) {
                             LexerATNConfig *c = getEpsilonTarget(input, config, t, configs, speculative);
                             if (c != nullptr) {
                                 currentAltReachedAcceptState = closure(input, c, configs, currentAltReachedAcceptState, speculative);
@@ -380,11 +490,11 @@ namespace org {
 
                     org::antlr::v4::runtime::atn::LexerATNConfig *LexerATNSimulator::getEpsilonTarget(CharStream *input, LexerATNConfig *config, Transition *t, ATNConfigSet *configs, bool speculative) {
                         LexerATNConfig *c = nullptr;
-                        switch (t->getSerializationType()) {
+                        switch (t->serializationType) {
                             case Transition::RULE: {
                                 RuleTransition *ruleTransition = static_cast<RuleTransition*>(t);
                                 PredictionContext *newContext = SingletonPredictionContext::create(config->context, ruleTransition->followState->stateNumber);
-                                c = new LexerATNConfig(config, t->target, newContext);
+                                c = configPool->create(config, t->target, newContext);
                             }
                                 break;
 
@@ -418,17 +528,20 @@ namespace org {
                                     std::wcout << L"EVAL rule " << pt->ruleIndex << L":" << pt->predIndex << std::endl;
                                 }
                                 configs->hasSemanticContext = true;
+                                if (compilingTable) {
+                                    break;
+                                }
                                 if (evaluatePredicate(input, pt->ruleIndex, pt->predIndex, speculative)) {
-                                    c = new LexerATNConfig(config, t->target);
+                                    c = configPool->create(config, t->target);
                                 }
                             }
                                 break;
                             // ignore actions; just exec one per rule upon accept
                             case Transition::ACTION:
-                                c = new LexerATNConfig(config, t->target, (static_cast<ActionTransition*>(t))->actionIndex);
+                                c = configPool->create(config, t->target, (static_cast<ActionTransition*>(t))->actionIndex);
                                 break;
                             case Transition::EPSILON:
-                                c = new LexerATNConfig(config, t->target);
+                                c = configPool->create(config, t->target);
                                 break;
                         }
 
@@ -505,21 +618,10 @@ namespace org {
 #ifdef TODO
 //JAVA TO C++ CONVERTER TODO TASK: There is no built-in support for multithreading in native C++:
                         synchronized(p) {
-                            if (p->edges == nullptr) {
-                                //  make room for tokens 1..n and -1 masquerading as index 0
-                                p->edges = new DFAState[MAX_DFA_EDGE - MIN_DFA_EDGE+1];
-                            }
-                            p->edges[t - MIN_DFA_EDGE] = q; // connect
+                            p->edges.set(t - MIN_DFA_EDGE, q); // connect
                         }
 #else
-                        if (p->edges.size() == 0) {
-                            //  make room for tokens 1..n and -1 masquerading as index 0
-//                            p->edges = new DFAState[MAX_DFA_EDGE - MIN_DFA_EDGE+1];
-#ifdef TODO
-                             Do I need to do any allocation here?
-#endif
-                        }
-                        p->edges[t - MIN_DFA_EDGE] = q; // connect
+                        p->edges.set(t - MIN_DFA_EDGE, q); // connect
 #endif
                     }
 
@@ -529,10 +631,13 @@ namespace org {
                          */
                         assert(!configs->hasSemanticContext);
 
-                        dfa::DFAState *proposed = new dfa::DFAState(configs);
+                        // look the state up before allocating anything; configs is usually
+                        // one of the scratch sets and only copied if the state is new
+                        dfa::DFAState lookup(configs);
+                        dfa::DFAState *proposed = &lookup;
                         ATNConfig *firstConfigWithRuleStopState = nullptr;
                         for (auto c : *configs) {
-                            if (dynamic_cast<RuleStopState*>(c->state) != nullptr) {
+                            if (c->state->getStateType() == ATNState::RULE_STOP) {
                                 firstConfigWithRuleStopState = c;
                                 break;
                             }
@@ -543,6 +648,7 @@ namespace org {
                             proposed->lexerRuleIndex = firstConfigWithRuleStopState->state->ruleIndex;
                             proposed->lexerActionIndex = (static_cast<LexerATNConfig*>(firstConfigWithRuleStopState))->lexerActionIndex;
                             proposed->prediction = atn->ruleToTokenType[proposed->lexerRuleIndex];
+                            proposed->lexerActionExecutor = atn->getLexerActionExecutor(proposed->lexerActionIndex);
                         }
 
                         dfa::DFA *dfa = decisionToDFA[mode];
@@ -564,22 +670,42 @@ namespace org {
                         }
 #else
 
-                        dfa::DFAState *existing = dfa->states->at(proposed);
-                        if (existing != nullptr) {
-                            return existing;
+                        dfa::DFA::StateSet::const_iterator existing = dfa->states->find(proposed);
+                        if (existing != dfa->states->end()) {
+                            return *existing;
                         }
                         
-                        dfa::DFAState *newState = proposed;
-                        
+                        // states aren't copyable (their edge map is shared with readers), so
+                        // take over what the lookup state was given field by field
+                        dfa::DFAState *newState = new dfa::DFAState(persistConfigs(configs));
+                        newState->isAcceptState = proposed->isAcceptState;
+                        newState->lexerRuleIndex = proposed->lexerRuleIndex;
+                        newState->lexerActionIndex = proposed->lexerActionIndex;
+                        newState->prediction = proposed->prediction;
+                        newState->lexerActionExecutor = proposed->lexerActionExecutor;
+
                         newState->stateNumber = dfa->states->size();
-                        configs->setReadonly(true);
-                        newState->configs = configs;
-                        dfa->states->insert(newState, newState);
+                        newState->configs->setReadonly(true);
+                        dfa->states->insert(newState);
                         return newState;
 #endif
                         
                     }
 
+                    ATNConfigSet *LexerATNSimulator::clearScratch(ATNConfigSet *scratch) {
+                        scratch->clear();
+                        scratch->hasSemanticContext = false;
+                        return scratch;
+                    }
+
+                    ATNConfigSet *LexerATNSimulator::persistConfigs(ATNConfigSet *configs) {
+                        ATNConfigSet *copy = new OrderedATNConfigSet();
+                        for (auto c : *configs) {
+                            copy->add(new LexerATNConfig(*static_cast<LexerATNConfig*>(c)));
+                        }
+                        return copy;
+                    }
+
                     org::antlr::v4::runtime::dfa::DFA *LexerATNSimulator::getDFA(int mode) {
                         return decisionToDFA[mode];
                     }
@@ -614,6 +740,40 @@ namespace org {
                             charPositionInLine++;
                         }
                         input->consume();
+                        if (input->index() > lookaheadEnd) {
+                            lookaheadEnd = input->index();
+                        }
+                    }
+
+                    int LexerATNSimulator::getLookaheadEnd() {
+                        return lookaheadEnd;
+                    }
+
+                    void LexerATNSimulator::clearLookahead() {
+                        lookaheadEnd = -1;
+                    }
+
+                    void LexerATNSimulator::skipRun(CharStream *input, const wchar_t *run, size_t length, bool newlines) {
+                        const wchar_t *lastNewline = nullptr;
+                        if (newlines) {
+                            for (const wchar_t *p = run + length; p != run; ) {
+                                if (*--p == L'\n') {
+                                    lastNewline = p;
+                                    break;
+                                }
+                            }
+                        }
+
+                        if (lastNewline != nullptr) {
+                            line += (int)std::count(run, lastNewline + 1, L'\n');
+                            charPositionInLine = (int)(run + length - lastNewline - 1);
+                        } else {
+                            charPositionInLine += (int)length;
+                        }
+                        input->seek(input->index() + (int)length);
+                        if (input->index() > lookaheadEnd) {
+                            lookaheadEnd = input->index();
+                        }
                     }
 
                     std::wstring LexerATNSimulator::getTokenName(int t) {
@@ -628,7 +788,9 @@ namespace org {
                         startIndex = -1;
                         line = 1;
                         charPositionInLine = 0;
+                        lookaheadEnd = -1;
                         mode = org::antlr::v4::runtime::Lexer::DEFAULT_MODE;
+                        compilingTable = false;
                     }
                 }
             }
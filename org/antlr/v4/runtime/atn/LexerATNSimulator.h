@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "ATNSimulator.h"
+#include "LexerDFATable.h"
 #include <string>
 #include <iostream>
 #include "Declarations.h"
@@ -107,6 +108,11 @@ namespace org {
                         /// The index of the character relative to the beginning of the line 0..n-1 </summary>
                         int charPositionInLine;
 
+                        /// <summary>
+                        /// The highest input index examined since the last call to
+                        ///  <seealso cref="#clearLookahead"/>, or -1. </summary>
+                        int lookaheadEnd;
+
                     public:
                         const std::vector<dfa::DFA*> decisionToDFA;
                     protected:
@@ -116,6 +122,24 @@ namespace org {
                         /// Used during DFA/ATN exec to record the most recent accept configuration info </summary>
                         SimState *const prevAccept;
 
+                        /// <summary>
+                        /// Set while <seealso cref="#compileDFATable"/> runs: there is no input to
+                        ///  evaluate predicates against, so closure stops at them and marks the
+                        ///  configuration set as predicated. </summary>
+                        bool compilingTable;
+
+                        /// <summary>
+                        /// Holds the configurations created while matching the current token;
+                        ///  reset at the start of every <seealso cref="#match"/>. </summary>
+                        LexerATNConfigPool *const configPool;
+
+                        /// <summary>
+                        /// Reused by <seealso cref="#computeStartState"/> and
+                        ///  <seealso cref="#computeTargetState"/> respectively. Neither set is ever
+                        ///  stored in a DFA state; <seealso cref="#addDFAState"/> keeps a copy. </summary>
+                        ATNConfigSet *const closureScratch;
+                        ATNConfigSet *const reachScratch;
+
                     public:
                         static int match_calls;
 
@@ -127,6 +151,22 @@ namespace org {
 
                         virtual int match(CharStream *input, int mode);
 
+                        /// <summary>
+                        /// Determinizes the DFA of {@code mode} ahead of time into a
+                        /// <seealso cref="dfa.LexerDFATable"/>, which <seealso cref="#match"/> then
+                        /// runs directly instead of walking DFA states. Transitions that depend on
+                        /// a semantic predicate are left to the ATN simulation at match time, as
+                        /// are EOF and characters outside the table's alphabet.
+                        /// <p/>
+                        /// The table is stored on the mode's <seealso cref="dfa.DFA"/>, so all lexers
+                        /// sharing it benefit. The DFA states it creates are the ones the ATN
+                        /// simulation would create, so mixing both paths is safe.
+                        /// </summary>
+                        /// <returns> {@code false} if the mode's start state depends on a
+                        /// predicate or the DFA would need more than {@code maxStates} states;
+                        /// the mode is then left to the ATN simulation. </returns>
+                        virtual bool compileDFATable(int mode, size_t maxStates = dfa::LexerDFATable::DEFAULT_MAX_STATES);
+
                         virtual void reset() override;
 
                     protected:
@@ -134,6 +174,12 @@ namespace org {
 
                         virtual int execATN(CharStream *input, dfa::DFAState *ds0);
 
+                        /// <summary>
+                        /// The match loop over a compiled table. Hands over to
+                        ///  <seealso cref="#execATN"/> at the current state wherever the table has no
+                        ///  answer. </summary>
+                        virtual int execTable(CharStream *input, dfa::LexerDFATable *table);
+
                         /// <summary>
                         /// Get an existing target state for an edge in the DFA. If the target state
                         /// for the edge has not yet been computed or is otherwise not available,
@@ -168,7 +214,7 @@ namespace org {
                         /// </summary>
                         virtual void getReachableConfigSet(CharStream *input, ATNConfigSet *closure, ATNConfigSet *reach, int t);
 
-                        virtual void accept(CharStream *input, int ruleIndex, int actionIndex, int index, int line, int charPos);
+                        virtual void accept(CharStream *input, LexerActionExecutor *lexerActionExecutor, int ruleIndex, int actionIndex, int index, int line, int charPos);
 
                         virtual ATNState *getReachableTarget(Transition *trans, int t);
 
@@ -216,6 +262,15 @@ namespace org {
 
                         virtual void addDFAEdge(dfa::DFAState *p, int t, dfa::DFAState *q);
 
+                        /// <summary>
+                        /// Empties a scratch set for reuse. </summary>
+                        virtual ATNConfigSet *clearScratch(ATNConfigSet *scratch);
+
+                        /// <summary>
+                        /// Copies {@code configs} and its configurations out of the scratch sets and
+                        ///  <seealso cref="#configPool"/>, for storing in a DFA state. </summary>
+                        virtual ATNConfigSet *persistConfigs(ATNConfigSet *configs);
+
                         /// <summary>
                         /// Add a new DFA state if there isn't one with this set of
                         /// configurations already. This method also detects the first
@@ -242,6 +297,22 @@ namespace org {
 
                         virtual void consume(CharStream *input);
 
+                        /// <summary>
+                        /// Returns the index of the furthest character looked at since the last
+                        ///  <seealso cref="#clearLookahead"/>. A token can only change when text at or
+                        ///  before this index does, which is what incremental relexing relies on.
+                        /// </summary>
+                        virtual int getLookaheadEnd();
+
+                        virtual void clearLookahead();
+
+                        /// <summary>
+                        /// Advances {@code input} over the {@code length} characters at
+                        ///  {@code run}, which start at its current index, keeping line and
+                        ///  column in step like {@code length} calls to <seealso cref="#consume"/>.
+                        /// </summary>
+                        virtual void skipRun(CharStream *input, const wchar_t *run, size_t length, bool newlines);
+
                         virtual std::wstring getTokenName(int t);
 
                     private:
@@ -0,0 +1,105 @@
+﻿#include "LexerAction.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    LexerAction::LexerAction(LexerActionType type, int value) : type(type), value(value) {
+                    }
+
+                    LexerAction LexerAction::skip() {
+                        return LexerAction(LexerActionType::SKIP, 0);
+                    }
+
+                    LexerAction LexerAction::more() {
+                        return LexerAction(LexerActionType::MORE, 0);
+                    }
+
+                    LexerAction LexerAction::setType(int type) {
+                        return LexerAction(LexerActionType::TYPE, type);
+                    }
+
+                    LexerAction LexerAction::setChannel(int channel) {
+                        return LexerAction(LexerActionType::CHANNEL, channel);
+                    }
+
+                    LexerAction LexerAction::mode(int mode) {
+                        return LexerAction(LexerActionType::MODE, mode);
+                    }
+
+                    LexerAction LexerAction::pushMode(int mode) {
+                        return LexerAction(LexerActionType::PUSH_MODE, mode);
+                    }
+
+                    LexerAction LexerAction::popMode() {
+                        return LexerAction(LexerActionType::POP_MODE, 0);
+                    }
+
+                    LexerAction LexerAction::custom(int actionIndex) {
+                        return LexerAction(LexerActionType::CUSTOM, actionIndex);
+                    }
+
+                    bool LexerAction::operator == (const LexerAction &other) const {
+                        return type == other.type && value == other.value;
+                    }
+
+                    std::wstring LexerAction::toString() const {
+                        switch (type) {
+                            case LexerActionType::SKIP:
+                                return L"skip";
+                            case LexerActionType::MORE:
+                                return L"more";
+                            case LexerActionType::TYPE:
+                                return L"type(" + std::to_wstring(value) + L")";
+                            case LexerActionType::CHANNEL:
+                                return L"channel(" + std::to_wstring(value) + L")";
+                            case LexerActionType::MODE:
+                                return L"mode(" + std::to_wstring(value) + L")";
+                            case LexerActionType::PUSH_MODE:
+                                return L"pushMode(" + std::to_wstring(value) + L")";
+                            case LexerActionType::POP_MODE:
+                                return L"popMode";
+                            case LexerActionType::CUSTOM:
+                                return L"action(" + std::to_wstring(value) + L")";
+                        }
+                        return L"";
+                    }
+
+                }
+            }
+        }
+    }
+}
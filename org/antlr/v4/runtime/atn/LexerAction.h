@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <string>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    /// <summary>
+                    /// The kinds of <seealso cref="LexerAction"/>. All but {@code CUSTOM} are
+                    /// lexer commands that <seealso cref="LexerActionExecutor"/> carries out
+                    /// itself.
+                    /// </summary>
+                    enum class LexerActionType {
+                        SKIP,
+                        MORE,
+                        TYPE,
+                        CHANNEL,
+                        MODE,
+                        PUSH_MODE,
+                        POP_MODE,
+
+                        /// <summary>
+                        /// Embedded code, run through <seealso cref="Recognizer#action"/> with
+                        /// the action index as argument.
+                        /// </summary>
+                        CUSTOM,
+                    };
+
+                    /// <summary>
+                    /// One step of the action sequence run when a lexer rule is accepted,
+                    /// as plain data: a command and its argument (the token type, channel,
+                    /// mode or custom action index; unused by {@code skip}, {@code more} and
+                    /// {@code popMode}).
+                    /// </summary>
+                    class LexerAction {
+                    public:
+                        LexerActionType type;
+                        int value;
+
+                        LexerAction(LexerActionType type, int value);
+
+                        static LexerAction skip();
+                        static LexerAction more();
+                        static LexerAction setType(int type);
+                        static LexerAction setChannel(int channel);
+                        static LexerAction mode(int mode);
+                        static LexerAction pushMode(int mode);
+                        static LexerAction popMode();
+                        static LexerAction custom(int actionIndex);
+
+                        bool operator == (const LexerAction &other) const;
+
+                        std::wstring toString() const;
+                    };
+
+                }
+            }
+        }
+    }
+}
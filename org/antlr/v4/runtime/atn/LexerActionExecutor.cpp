@@ -0,0 +1,101 @@
+﻿#include "LexerActionExecutor.h"
+#include "Lexer.h"
+#include "RecognitionException.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    LexerActionExecutor::LexerActionExecutor(const std::vector<LexerAction> &actions) : actions(actions), custom(false) {
+                        for (const LexerAction &action : actions) {
+                            if (action.type == LexerActionType::CUSTOM) {
+                                custom = true;
+                            }
+                        }
+                    }
+
+                    void LexerActionExecutor::execute(Lexer *lexer, int ruleIndex) const {
+                        for (const LexerAction &action : actions) {
+                            switch (action.type) {
+                                case LexerActionType::SKIP:
+                                    lexer->_type = Lexer::SKIP;
+                                    break;
+                                case LexerActionType::MORE:
+                                    lexer->_type = Lexer::MORE;
+                                    break;
+                                case LexerActionType::TYPE:
+                                    lexer->_type = action.value;
+                                    break;
+                                case LexerActionType::CHANNEL:
+                                    lexer->_channel = action.value;
+                                    break;
+                                case LexerActionType::MODE:
+                                    lexer->_mode = action.value;
+                                    break;
+                                case LexerActionType::PUSH_MODE:
+                                    lexer->_modeStack.push_back(lexer->_mode);
+                                    lexer->_mode = action.value;
+                                    break;
+                                case LexerActionType::POP_MODE:
+                                    if (lexer->_modeStack.empty()) {
+                                        throw EmptyStackException();
+                                    }
+                                    lexer->_mode = lexer->_modeStack.back();
+                                    lexer->_modeStack.pop_back();
+                                    break;
+                                case LexerActionType::CUSTOM:
+                                    lexer->action(nullptr, ruleIndex, action.value);
+                                    break;
+                            }
+                        }
+                    }
+
+                    std::wstring LexerActionExecutor::toString() const {
+                        std::wstring result;
+                        for (const LexerAction &action : actions) {
+                            if (!result.empty()) {
+                                result += L", ";
+                            }
+                            result += action.toString();
+                        }
+                        return result;
+                    }
+
+                }
+            }
+        }
+    }
+}
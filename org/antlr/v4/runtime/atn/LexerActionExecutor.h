@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <vector>
+#include <string>
+
+#include "LexerAction.h"
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    /// <summary>
+                    /// The sequence of <seealso cref="LexerAction"/>s behind one lexer action
+                    /// index, e.g. {@code -> channel(HIDDEN), pushMode(X)}. Accept states of the
+                    /// lexer DFA keep a pointer to it, so accepting a token runs the commands
+                    /// directly on the <seealso cref="Lexer"/>'s fields; only
+                    /// {@code CUSTOM} steps go through the virtual <seealso cref="Recognizer#action"/>.
+                    /// <p/>
+                    /// Executors are registered on the ATN with
+                    /// <seealso cref="ATN#defineLexerAction"/>.
+                    /// </summary>
+                    class LexerActionExecutor {
+                    private:
+                        const std::vector<LexerAction> actions;
+
+                        /// <summary>
+                        /// Whether there is a {@code CUSTOM} step, i.e. whether
+                        ///  <seealso cref="#execute"/> may call into the recognizer. </summary>
+                        bool custom;
+
+                    public:
+                        LexerActionExecutor(const std::vector<LexerAction> &actions);
+
+                        const std::vector<LexerAction> &getActions() const {
+                            return actions;
+                        }
+
+                        bool hasCustomActions() const {
+                            return custom;
+                        }
+
+                        /// <summary>
+                        /// Runs the sequence for a token of rule {@code ruleIndex}. </summary>
+                        void execute(Lexer *lexer, int ruleIndex) const;
+
+                        std::wstring toString() const;
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -38,7 +38,7 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
-                    NotSetTransition::NotSetTransition(ATNState *target, misc::IntervalSet *set) : SetTransition(target, set) {
+                    NotSetTransition::NotSetTransition(ATNState *target, misc::IntervalSet *set) : SetTransition(target, set, NOT_SET) {
                     }
 
                     int NotSetTransition::getSerializationType() {
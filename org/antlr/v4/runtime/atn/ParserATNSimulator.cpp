@@ -10,6 +10,14 @@
 #include "DecisionState.h"
 #include "ParserRuleContext.h"
 #include "ParserATNSimulator.h"
+#include "Transition.h"
+#include "RuleTransition.h"
+#include "RuleMemoTable.h"
+#include "PredictionBudget.h"
+#include "DFAEvictionPolicy.h"
+#include "ActionTransition.h"
+#include "PredicateTransition.h"
+#include "PrecedencePredicateTransition.h"
 
 /*
  * [The "BSD license"]
@@ -49,6 +57,7 @@ namespace org {
 
                     ParserATNSimulator::ParserATNSimulator(ATN *atn, const std::vector<dfa::DFA>& decisionToDFA, PredictionContextCache *sharedContextCache):
                     parser(nullptr) {
+                        InitializeInstanceFields();
                     }
 
                     ParserATNSimulator::ParserATNSimulator(Parser *parser, ATN *atn, const std::vector<dfa::DFA>& decisionToDFA, PredictionContextCache *sharedContextCache) : ATNSimulator(atn,sharedContextCache), parser(parser), _decisionToDFA(decisionToDFA) {
@@ -59,6 +68,10 @@ namespace org {
                     }
 
                     void ParserATNSimulator::reset() {
+                        clearPredicateMemo();
+                        if (budget != nullptr) {
+                            budget->start();
+                        }
                     }
 
                     int ParserATNSimulator::adaptivePredict(TokenStream *input, int decision, ParserRuleContext *outerContext) {
@@ -69,7 +82,10 @@ namespace org {
                         _input = input;
                         _startIndex = input->index();
                         _outerContext = outerContext;
-                        dfa::DFA dfa = _decisionToDFA[decision];
+                        if (budget != nullptr) {
+                            budget->predictions++;
+                        }
+                        dfa::DFA &dfa = _decisionToDFA[decision];
 
                         int m = input->mark();
                         int index = input->index();
@@ -77,25 +93,63 @@ namespace org {
                         // Now we are certain to have a specific decision's DFA
                         // But, do we still need an initial state?
                         try {
-                            if (dfa.s0 == nullptr) {
-                                if (outerContext == nullptr) {
-                                    outerContext = ParserRuleContext::EMPTY;
+                            int alt;
+                            {
+                                // keeps every state this prediction reaches from being deleted
+                                // under it by an eviction on another thread
+                                dfa::DFAEvictionPolicy::ReadGuard guard(evictionPolicy);
+                                dfa::DFAState *s0;
+                                if (dfa.isPrecedenceDfa()) {
+                                    // the start state for a precedence DFA depends on the current
+                                    // parser precedence, and is provided by a DFA method.
+                                    s0 = dfa.getPrecedenceStartState(parser->getPrecedence());
+                                    if (s0 != nullptr && !s0->referenced) {
+                                        s0->referenced = true;
+                                    }
+                                } else {
+                                    // the start state for a "regular" DFA is just s0
+                                    s0 = dfa.s0;
                                 }
-                                if (debug || debug_list_atn_decisions) {
 
-                                    std::wcout << std::wstring(L"predictATN decision ") << dfa.decision << std::wstring(L" exec LA(1)==") << getLookaheadName(input) << std::wstring(L", outerContext=") << outerContext->toString(parser) << std::endl;
+                                if (s0 == nullptr) {
+                                    if (outerContext == nullptr) {
+                                        outerContext = ParserRuleContext::EMPTY;
+                                    }
+                                    if (debug || debug_list_atn_decisions) {
+
+                                        std::wcout << std::wstring(L"predictATN decision ") << dfa.decision << std::wstring(L" exec LA(1)==") << getLookaheadName(input) << std::wstring(L", outerContext=") << outerContext->toString(parser) << std::endl;
+                                    }
+                                    bool fullCtx = false;
+                                    ATNConfigSet *s0_closure = computeStartState(dynamic_cast<ATNState*>(dfa.atnStartState),
+                                                                                 ParserRuleContext::EMPTY, fullCtx);
+
+                                    std::unique_lock<std::recursive_mutex> lock = dfa::DFAEvictionPolicy::lockUpdates(evictionPolicy);
+                                    if (dfa.isPrecedenceDfa()) {
+                                        // If this is a precedence DFA, we use applyPrecedenceFilter
+                                        // to convert the computed start state to a precedence start
+                                        // state. We then use DFA.setPrecedenceStartState to set the
+                                        // appropriate start state for the precedence level rather
+                                        // than simply setting DFA.s0.
+                                        s0_closure = applyPrecedenceFilter(s0_closure);
+                                        s0 = addDFAState(&dfa, new dfa::DFAState(s0_closure));
+                                        dfa.setPrecedenceStartState(parser->getPrecedence(), s0, evictionPolicy);
+                                    } else {
+                                        s0 = addDFAState(&dfa, new dfa::DFAState(s0_closure));
+                                        dfa.s0 = s0;
+                                    }
                                 }
-                                bool fullCtx = false;
-                                ATNConfigSet *s0_closure = computeStartState(dynamic_cast<ATNState*>(dfa.atnStartState),
-                                                                             ParserRuleContext::EMPTY, fullCtx);
-                                dfa.s0 = addDFAState(&dfa, new dfa::DFAState(s0_closure));
-                            }
 
-                            // We can start with an existing DFA.
-                            int alt = execATN(&dfa, dfa.s0, input, index, outerContext);
-                            if (debug) {
+                                // We can start with an existing DFA.
+                                alt = execATN(&dfa, s0, input, index, outerContext);
+                                if (debug) {
+
+                                    std::wcout << "DFA after predictATN: " << dfa.toString(parser->getTokenNames()) << std::endl;
+                                }
+                            }
 
-                                std::wcout << "DFA after predictATN: " << dfa.toString(parser->getTokenNames()) << std::endl;
+                            // no DFA state is in use any more
+                            if (evictionPolicy != nullptr) {
+                                evictionPolicy->enforce();
                             }
                             return alt;
                         }
@@ -201,7 +255,7 @@ namespace org {
                                 std::bitset<BITSET_SIZE> *alts = evalSemanticContext(D->predicates, outerContext, true);
                                 switch (alts->count()) {
                                 case 0:
-                                    throw noViableAlt(input, outerContext, D->configs, startIndex);
+                                    throw noViableAlt(input, outerContext, getConfigs(D), startIndex);
 
                                 case 1:
                                     return alts->nextSetBit(0);
@@ -209,7 +263,7 @@ namespace org {
                                 default:
                                     // report ambiguity after predicate evaluation to make sure the correct
                                     // set of ambig alts is reported.
-                                    reportAmbiguity(dfa, D, startIndex, stopIndex, false, alts, D->configs);
+                                    reportAmbiguity(dfa, D, startIndex, stopIndex, false, alts, getConfigs(D));
                                     return alts->nextSetBit(0);
                                 }
                             }
@@ -219,19 +273,20 @@ namespace org {
                             if (t != IntStream::_EOF) {
                                 input->consume();
                                 t = input->LA(1);
+                                if (budget != nullptr) {
+                                    budget->checkLookahead(input->index() - startIndex + 1);
+                                }
                             }
                         }
                     }
 
                     dfa::DFAState *ParserATNSimulator::getExistingTargetState(dfa::DFAState *previousD, int t) {
-//JAVA TO C++ CONVERTER WARNING: Since the array size is not known in this declaration, Java to C++ Converter has converted this array to a pointer.  You will need to call 'delete[]' where appropriate:
-//ORIGINAL LINE: org.antlr.v4.runtime.dfa.DFAState[] edges = previousD.edges;
-                        std::vector<dfa::DFAState *>edges = previousD->edges;
-                        if (edges.size() == 0 || t + 1 < 0 || t + 1 >= edges.size()) {
-                            return nullptr;
+                        dfa::DFAState *target = previousD->edges.get(t + 1);
+                        // only write when the flag changes, to leave shared cache lines clean
+                        if (target != nullptr && !target->referenced) {
+                            target->referenced = true;
                         }
-
-                        return edges[t + 1];
+                        return target;
                     }
 
                     dfa::DFAState *ParserATNSimulator::computeTargetState(dfa::DFA *dfa, dfa::DFAState *previousD, int t) {
@@ -275,7 +330,13 @@ namespace org {
                         }
 
                         // all adds to dfa are done after we've created full D state
+                        D->origin = previousD;
+                        D->originSymbol = t;
+                        std::unique_lock<std::recursive_mutex> lock = dfa::DFAEvictionPolicy::lockUpdates(evictionPolicy);
                         D = addDFAEdge(dfa, previousD, t, D);
+                        if (leanDFA && D != nullptr) {
+                            compactDFAState(D);
+                        }
                         return D;
                     }
 
@@ -286,10 +347,8 @@ namespace org {
                         // Update DFA so reach becomes accept state with (predicate,alt)
                         // pairs if preds found for conflicting alts
                         BitSet *altsToCollectPredsFrom = getConflictingAltsOrUniqueAlt(dfaState->configs);
-//JAVA TO C++ CONVERTER WARNING: Since the array size is not known in this declaration, Java to C++ Converter has converted this array to a pointer.  You will need to call 'delete[]' where appropriate:
-//ORIGINAL LINE: SemanticContext[] altToPred = getPredsForAmbigAlts(altsToCollectPredsFrom, dfaState.configs, nalts);
-                        SemanticContext *altToPred = getPredsForAmbigAlts(altsToCollectPredsFrom, dfaState->configs, nalts);
-                        if (altToPred != nullptr) {
+                        std::vector<SemanticContext*> altToPred = getPredsForAmbigAlts(altsToCollectPredsFrom, dfaState->configs, nalts);
+                        if (!altToPred.empty()) {
                             dfaState->predicates = getPredicatePredictions(altsToCollectPredsFrom, altToPred);
                             dfaState->prediction = ATN::INVALID_ALT_NUMBER; // make sure we use preds
                         } else {
@@ -311,6 +370,9 @@ namespace org {
                         input->seek(startIndex);
                         int t = input->LA(1);
                         int predictedAlt;
+                        if (budget != nullptr) {
+                            budget->fullContextPredictions++;
+                        }
                         while (true) { // while more work
                                         //			System.out.println("LL REACH "+getLookaheadName(input)+
                                         //							   " from configs.size="+previous.size()+
@@ -367,6 +429,9 @@ namespace org {
                             if (t != IntStream::_EOF) {
                                 input->consume();
                                 t = input->LA(1);
+                                if (budget != nullptr) {
+                                    budget->checkLookahead(input->index() - startIndex + 1);
+                                }
                             }
                         }
 
@@ -415,6 +480,12 @@ namespace org {
                             std::cout << std::wstring(L"in computeReachSet, starting closure: ") << closure << std::endl;
                         }
 
+                        // closure below runs on configurations that have matched t
+                        _closureIndex = _input != nullptr ? _input->index() + 1 : 0;
+                        if (budget != nullptr) {
+                            budget->checkDeadline();
+                        }
+
                         if (mergeCache == nullptr) {
                             mergeCache = new DoubleKeyMap<PredictionContext*, PredictionContext*, PredictionContext*>();
                         }
@@ -439,7 +510,7 @@ namespace org {
                                 std::wcout << std::wstring(L"testing ") << getTokenName(t) << std::wstring(L" at ") << c->toString() << std::endl;
                             }
 
-                            if (dynamic_cast<RuleStopState*>(c->state) != nullptr) {
+                            if (c->state->getStateType() == ATNState::RULE_STOP) {
                                 assert(c->context->isEmpty());
                                 if (fullCtx || t == IntStream::_EOF) {
                                     if (skippedStopStates.empty()) {
@@ -452,9 +523,7 @@ namespace org {
                                 continue;
                             }
 
-                            int n = c->state->getNumberOfTransitions();
-                            for (int ti = 0; ti < n; ti++) { // for each transition
-                                Transition *trans = c->state->transition(ti);
+                            for (Transition *trans : c->state->transitions) { // for each transition
                                 ATNState *target = getReachableTarget(trans, t);
                                 if (target != nullptr) {
                                     intermediate->add(new ATNConfig(c, target), mergeCache);
@@ -494,9 +563,9 @@ namespace org {
                          */
                         if (reach == nullptr) {
                             reach = new ATNConfigSet(fullCtx);
-                            Set<ATNConfig*> *closureBusy = std::set<ATNConfig*>();
+                            closureBusy.clear();
                             for (auto c : intermediate) {
-                                closure(c, reach, closureBusy, false, fullCtx);
+                                closure(c, reach, &closureBusy, false, fullCtx);
                             }
                         }
 
@@ -539,6 +608,9 @@ namespace org {
                         if (reach->isEmpty()) {
                             return nullptr;
                         }
+                        if (budget != nullptr) {
+                            budget->checkConfigs(reach->size());
+                        }
                         return reach;
                     }
 
@@ -549,7 +621,7 @@ namespace org {
 
                         ATNConfigSet *result = new ATNConfigSet(configs->fullCtx);
                         for (auto config : configs) {
-                            if (dynamic_cast<RuleStopState*>(config->state) != nullptr) {
+                            if (config->state->getStateType() == ATNState::RULE_STOP) {
                                 result->add(config, mergeCache);
                                 continue;
                             }
@@ -570,26 +642,71 @@ namespace org {
                         // always at least the implicit call to start rule
                         PredictionContext *initialContext = PredictionContext::fromRuleContext(atn, ctx);
                         ATNConfigSet *configs = new ATNConfigSet(fullCtx);
+                        _closureIndex = _input != nullptr ? _input->index() : 0;
 
                         for (int i = 0; i < p->getNumberOfTransitions(); i++) {
                             ATNState *target = p->transition(i)->target;
                             ATNConfig *c = new ATNConfig(target, i + 1, initialContext);
-                            Set<ATNConfig*> *closureBusy = std::set<ATNConfig*>();
-                            closure(c, configs, closureBusy, true, fullCtx);
+                            closureBusy.clear();
+                            closure(c, configs, &closureBusy, true, fullCtx);
                         }
 
                         return configs;
                     }
 
+                    org::antlr::v4::runtime::atn::ATNConfigSet *ParserATNSimulator::applyPrecedenceFilter(ATNConfigSet *configs) {
+                        std::map<int, PredictionContext*> statesFromAlt1;
+                        ATNConfigSet *configSet = new ATNConfigSet(configs->fullCtx);
+                        for (ATNConfig *config : configs->configs) {
+                            // handle alt 1 first
+                            if (config->alt != 1) {
+                                continue;
+                            }
+
+                            SemanticContext *updatedContext = config->semanticContext->evalPrecedence(parser, _outerContext);
+                            if (updatedContext == nullptr) {
+                                // the configuration was eliminated
+                                continue;
+                            }
+
+                            statesFromAlt1[config->state->stateNumber] = config->context;
+                            if (updatedContext != config->semanticContext) {
+                                configSet->add(new ATNConfig(config, updatedContext), mergeCache);
+                            } else {
+                                configSet->add(config, mergeCache);
+                            }
+                        }
+
+                        for (ATNConfig *config : configs->configs) {
+                            if (config->alt == 1) {
+                                // already handled
+                                continue;
+                            }
+
+                            // In the future, this elimination step could be updated to also
+                            // filter the prediction context for alternatives predicting alt>1
+                            // (basically a graph subtraction algorithm).
+                            std::map<int, PredictionContext*>::const_iterator context = statesFromAlt1.find(config->state->stateNumber);
+                            if (context != statesFromAlt1.end() && context->second->equals(config->context)) {
+                                // eliminated
+                                continue;
+                            }
+
+                            configSet->add(config, mergeCache);
+                        }
+
+                        return configSet;
+                    }
+
                     org::antlr::v4::runtime::atn::ATNState *ParserATNSimulator::getReachableTarget(Transition *trans, int ttype) {
-                        if (trans->matches(ttype, 0, atn->maxTokenType)) {
+                        if (trans->matchesSymbol(ttype, 0, atn->maxTokenType)) {
                             return trans->target;
                         }
 
                         return nullptr;
                     }
 
-                    SemanticContext *ParserATNSimulator::getPredsForAmbigAlts(BitSet *ambigAlts, ATNConfigSet *configs, int nalts) {
+                    std::vector<SemanticContext*> ParserATNSimulator::getPredsForAmbigAlts(BitSet *ambigAlts, ATNConfigSet *configs, int nalts) {
                         // REACH=[1|1|[]|0:0, 1|2|[]|0:1]
                         /* altToPred starts as an array of all null contexts. The entry at index i
                          * corresponds to alternative i. altToPred[i] may have one of three values:
@@ -602,10 +719,10 @@ namespace org {
                          *
                          * From this, it is clear that NONE||anything==NONE.
                          */
-                        SemanticContext altToPred[nalts + 1];
-                        for (auto c : configs) {
+                        std::vector<SemanticContext*> altToPred(nalts + 1, nullptr);
+                        for (ATNConfig *c : configs->configs) {
                             if (ambigAlts->get(c->alt)) {
-                                altToPred[c->alt] = SemanticContext::or(altToPred[c->alt], c->semanticContext);
+                                altToPred[c->alt] = SemanticContext::Or(altToPred[c->alt], c->semanticContext);
                             }
                         }
 
@@ -625,25 +742,25 @@ namespace org {
 
                         // nonambig alts are null in altToPred
                         if (nPredAlts == 0) {
-                            altToPred = nullptr;
+                            altToPred.clear();
                         }
                         if (debug) {
-                            std::wcout << std::wstring(L"getPredsForAmbigAlts result ") << Arrays->toString(altToPred) << std::endl;
+                            std::wcout << std::wstring(L"getPredsForAmbigAlts result ") << altToPred.size() << std::endl;
                         }
                         return altToPred;
                     }
 
-                    DFAState::PredPrediction *ParserATNSimulator::getPredicatePredictions(BitSet *ambigAlts, SemanticContext altToPred[]) {
-                        std::vector<DFAState::PredPrediction*> pairs = std::vector<DFAState::PredPrediction*>();
+                    std::vector<dfa::DFAState::PredPrediction*> ParserATNSimulator::getPredicatePredictions(BitSet *ambigAlts, const std::vector<SemanticContext*> &altToPred) {
+                        std::vector<dfa::DFAState::PredPrediction*> pairs;
                         bool containsPredicate = false;
-                        for (int i = 1; i < sizeof(altToPred) / sizeof(altToPred[0]); i++) {
+                        for (std::vector<SemanticContext*>::size_type i = 1; i < altToPred.size(); i++) {
                             SemanticContext *pred = altToPred[i];
 
                             // unpredicated is indicated by SemanticContext.NONE
                             assert(pred != nullptr);
 
                             if (ambigAlts != nullptr && ambigAlts->get(i)) {
-                                pairs.push_back(new DFAState::PredPrediction(pred, i));
+                                pairs.push_back(new dfa::DFAState::PredPrediction(pred, (int)i));
                             }
                             if (pred != SemanticContext::NONE) {
                                 containsPredicate = true;
@@ -651,17 +768,16 @@ namespace org {
                         }
 
                         if (!containsPredicate) {
-                            return nullptr;
+                            pairs.clear();
                         }
 
-                                        //		System.out.println(Arrays.toString(altToPred)+"->"+pairs);
-                        return pairs.toArray(new DFAState::PredPrediction[pairs.size()]);
+                        return pairs;
                     }
 
                     int ParserATNSimulator::getAltThatFinishedDecisionEntryRule(ATNConfigSet *configs) {
                         IntervalSet *alts = new IntervalSet();
                         for (auto c : configs) {
-                            if (c->reachesIntoOuterContext > 0 || (dynamic_cast<RuleStopState*>(c->state) != nullptr && c->context->hasEmptyPath())) {
+                            if (c->reachesIntoOuterContext > 0 || (c->state->getStateType() == ATNState::RULE_STOP && c->context->hasEmptyPath())) {
                                 alts->add(c->alt);
                             }
                         }
@@ -682,7 +798,7 @@ namespace org {
                                 continue;
                             }
 
-                            bool predicateEvaluationResult = pair->pred->eval(parser, outerContext);
+                            bool predicateEvaluationResult = evalPredicate(pair->pred, outerContext);
                             if (debug || dfa_debug) {
                                 std::cout << std::wstring(L"eval pred ") << pair << std::wstring(L"=") << predicateEvaluationResult << std::endl;
                             }
@@ -701,18 +817,41 @@ namespace org {
                         return predictions;
                     }
 
-                    void ParserATNSimulator::closure(ATNConfig *config, ATNConfigSet *configs, Set<ATNConfig*> *closureBusy, bool collectPredicates, bool fullCtx) {
+                    bool ParserATNSimulator::evalPredicate(SemanticContext *pred, ParserRuleContext *outerContext) {
+                        SemanticContext::Predicate *p = dynamic_cast<SemanticContext::Predicate*>(pred);
+                        if (p == nullptr || p->isCtxDependent || parser == nullptr || !parser->isPurePredicate(p->ruleIndex, p->predIndex)) {
+                            return pred->eval(parser, outerContext);
+                        }
+
+                        int index = _input->index();
+                        if (index != predicateMemoIndex) {
+                            predicateMemo.clear();
+                            predicateMemoIndex = index;
+                        }
+
+                        int key = p->ruleIndex << 16 | p->predIndex;
+                        std::unordered_map<int, bool>::const_iterator it = predicateMemo.find(key);
+                        if (it != predicateMemo.end()) {
+                            return it->second;
+                        }
+
+                        bool result = pred->eval(parser, outerContext);
+                        predicateMemo[key] = result;
+                        return result;
+                    }
+
+                    void ParserATNSimulator::closure(ATNConfig *config, ATNConfigSet *configs, ClosureBusySet *closureBusy, bool collectPredicates, bool fullCtx) {
                         const int initialDepth = 0;
                         closureCheckingStopState(config, configs, closureBusy, collectPredicates, fullCtx, initialDepth);
                         assert(!fullCtx || !configs->dipsIntoOuterContext);
                     }
 
-                    void ParserATNSimulator::closureCheckingStopState(ATNConfig *config, ATNConfigSet *configs, Set<ATNConfig*> *closureBusy, bool collectPredicates, bool fullCtx, int depth) {
+                    void ParserATNSimulator::closureCheckingStopState(ATNConfig *config, ATNConfigSet *configs, ClosureBusySet *closureBusy, bool collectPredicates, bool fullCtx, int depth) {
                         if (debug) {
                             std::cout << std::wstring(L"closure(") << config->toString(parser,true) << std::wstring(L")") << std::endl;
                         }
 
-                        if (dynamic_cast<RuleStopState*>(config->state) != nullptr) {
+                        if (config->state->getStateType() == ATNState::RULE_STOP) {
                             // We hit rule end. If we have context info, use it
                             // run thru all possible stack tops in ctx
                             if (!config->context->isEmpty()) {
@@ -756,7 +895,10 @@ namespace org {
                         closure_(config, configs, closureBusy, collectPredicates, fullCtx, depth);
                     }
 
-                    void ParserATNSimulator::closure_(ATNConfig *config, ATNConfigSet *configs, Set<ATNConfig*> *closureBusy, bool collectPredicates, bool fullCtx, int depth) {
+                    void ParserATNSimulator::closure_(ATNConfig *config, ATNConfigSet *configs, ClosureBusySet *closureBusy, bool collectPredicates, bool fullCtx, int depth) {
+                        if (budget != nullptr) {
+                            budget->countClosure();
+                        }
                         ATNState *p = config->state;
                         // optimization
                         if (!p->onlyHasEpsilonTransitions()) {
@@ -764,13 +906,13 @@ namespace org {
                                         //            if ( debug ) System.out.println("added config "+configs);
                         }
 
-                        for (int i = 0; i < p->getNumberOfTransitions(); i++) {
-                            Transition *t = p->transition(i);
-                            bool continueCollecting = !(dynamic_cast<ActionTransition*>(t) != nullptr) && collectPredicates;
+                        bool atRuleStop = p->getStateType() == ATNState::RULE_STOP;
+                        for (Transition *t : p->transitions) {
+                            bool continueCollecting = t->serializationType != Transition::ACTION && collectPredicates;
                             ATNConfig *c = getEpsilonTarget(config, t, continueCollecting, depth == 0, fullCtx);
                             if (c != nullptr) {
                                 int newDepth = depth;
-                                if (dynamic_cast<RuleStopState*>(config->state) != nullptr) {
+                                if (atRuleStop) {
                                     assert(!fullCtx);
                                     // target fell off end of rule; mark resulting c as having dipped into outer context
                                     // We can't get here if incoming config was rule stop and we had context
@@ -790,7 +932,7 @@ namespace org {
                                     if (debug) {
                                         std::cout << std::wstring(L"dips into outer ctx: ") << c << std::endl;
                                     }
-                                } else if (dynamic_cast<RuleTransition*>(t) != nullptr) {
+                                } else if (t->serializationType == Transition::RULE) {
                                     // latch when newDepth goes negative - once we step out of the entry context we can't return
                                     if (newDepth >= 0) {
                                         newDepth++;
@@ -810,8 +952,11 @@ namespace org {
                     }
 
                     org::antlr::v4::runtime::atn::ATNConfig *ParserATNSimulator::getEpsilonTarget(ATNConfig *config, Transition *t, bool collectPredicates, bool inContext, bool fullCtx) {
-                        switch (t->getSerializationType()) {
+                        switch (t->serializationType) {
                         case Transition::RULE:
+                            if (fullCtx && isMemoizedFailure(static_cast<RuleTransition*>(t))) {
+                                return nullptr;
+                            }
                             return ruleTransition(config, static_cast<RuleTransition*>(t));
 
                         case Transition::PRECEDENCE:
@@ -861,7 +1006,7 @@ namespace org {
                                     c = new ATNConfig(config, pt->target); // no pred context
                                 }
                             } else {
-                                SemanticContext *newSemCtx = SemanticContext::and(config->semanticContext, pt->getPredicate());
+                                SemanticContext *newSemCtx = SemanticContext::And(config->semanticContext, pt->getPredicate());
                                 c = new ATNConfig(config, pt->target, newSemCtx);
                             }
                         } else {
@@ -891,13 +1036,13 @@ namespace org {
                                 // later during conflict resolution.
                                 int currentPosition = _input->index();
                                 _input->seek(_startIndex);
-                                bool predSucceeds = pt->getPredicate()->eval(parser, _outerContext);
+                                bool predSucceeds = evalPredicate(pt->getPredicate(), _outerContext);
                                 _input->seek(currentPosition);
                                 if (predSucceeds) {
                                     c = new ATNConfig(config, pt->target); // no pred context
                                 }
                             } else {
-                                SemanticContext *newSemCtx = SemanticContext::and(config->semanticContext, pt->getPredicate());
+                                SemanticContext *newSemCtx = SemanticContext::And(config->semanticContext, pt->getPredicate());
                                 c = new ATNConfig(config, pt->target, newSemCtx);
                             }
                         } else {
@@ -920,6 +1065,11 @@ namespace org {
                         return new ATNConfig(config, t->target, newContext);
                     }
 
+                    bool ParserATNSimulator::isMemoizedFailure(RuleTransition *t) {
+                        RuleMemoTable *memo = parser != nullptr ? parser->getRuleMemoTable() : nullptr;
+                        return memo != nullptr && memo->hasFailed(t->target->ruleIndex, _closureIndex, t->precedence);
+                    }
+
                     BitSet *ParserATNSimulator::getConflictingAlts(ATNConfigSet *configs) {
                         Collection<BitSet*> *altsets = PredictionMode::getConflictingAltSubsets(configs);
                         return PredictionMode::getAlts(altsets);
@@ -1000,19 +1150,15 @@ namespace org {
                             return nullptr;
                         }
 
+                        // one update, so that no sweep can take the state before it is linked
+                        std::unique_lock<std::recursive_mutex> lock = dfa::DFAEvictionPolicy::lockUpdates(evictionPolicy);
                         to = addDFAState(dfa, to); // used existing if possible not incoming
                         if (from == nullptr || t < -1 || t > atn->maxTokenType) {
                             return to;
                         }
 
-//JAVA TO C++ CONVERTER TODO TASK: There is no built-in support for multithreading in native C++:
-                        synchronized(from) {
-                            if (from->edges == nullptr) {
-                                from->edges = new DFAState[atn->maxTokenType+1 + 1];
-                            }
-
-                            from->edges[t + 1] = to; // connect
-                        }
+                        from->edges.set(t + 1, to, evictionPolicy); // connect
+                        lock.unlock();
 
                         if (debug) {
                             std::vector<std::wstring> names;
@@ -1030,29 +1176,36 @@ namespace org {
                             return D;
                         }
 
-//JAVA TO C++ CONVERTER TODO TASK: There is no built-in support for multithreading in native C++:
-                        synchronized(dfa->states) {
-                            DFAState *existing = dfa->states->get(D);
-                            if (existing != nullptr) {
-                                return existing;
-                            }
+                        std::unique_lock<std::recursive_mutex> lock = dfa::DFAEvictionPolicy::lockUpdates(evictionPolicy);
 
-                            D->stateNumber = dfa->states->size();
-                            if (!D->configs->isReadonly()) {
-                                D->configs->optimizeConfigs(this);
-                                D->configs->setReadonly(true);
-                            }
-                            dfa->states->put(D, D);
-                            if (debug) {
-                                std::cout << std::wstring(L"adding new DFA state: ") << D << std::endl;
-                            }
-                            return D;
+                        // freeze the configurations first so the lookup can compare them
+                        // with the states' frozen sets
+                        if (!D->configs->isReadonly()) {
+                            D->configs->optimizeConfigs(this);
+                            D->configs->setReadonly(true);
+                        }
+
+                        DFA::StateSet::const_iterator existing = dfa->states->find(D);
+                        if (existing != dfa->states->end()) {
+                            (*existing)->referenced = true;
+                            return *existing;
                         }
+
+                        D->stateNumber = dfa->newStateNumber();
+                        D->referenced = true;
+                        dfa->states->insert(D);
+                        if (evictionPolicy != nullptr) {
+                            evictionPolicy->stateAdded(dfa);
+                        }
+                        if (debug) {
+                            std::cout << std::wstring(L"adding new DFA state: ") << D << std::endl;
+                        }
+                        return D;
                     }
 
                     void ParserATNSimulator::reportAttemptingFullContext(DFA *dfa, BitSet *conflictingAlts, ATNConfigSet *configs, int startIndex, int stopIndex) {
                         if (debug || retry_debug) {
-                            Interval *interval = Interval::of(startIndex, stopIndex);
+                            Interval interval(startIndex, stopIndex);
                             std::cout << std::wstring(L"reportAttemptingFullContext decision=") << dfa->decision << std::wstring(L":") << configs << std::wstring(L", input=") << parser->getTokenStream()->getText(interval) << std::endl;
                         }
                         if (parser != nullptr) {
@@ -1062,7 +1215,7 @@ namespace org {
 
                     void ParserATNSimulator::reportContextSensitivity(DFA *dfa, int prediction, ATNConfigSet *configs, int startIndex, int stopIndex) {
                         if (debug || retry_debug) {
-                            Interval *interval = Interval::of(startIndex, stopIndex);
+                            Interval interval(startIndex, stopIndex);
                             std::cout << std::wstring(L"reportContextSensitivity decision=") << dfa->decision << std::wstring(L":") << configs << std::wstring(L", input=") << parser->getTokenStream()->getText(interval) << std::endl;
                         }
                         if (parser != nullptr) {
@@ -1088,7 +1241,7 @@ namespace org {
                                         //				}
                                         //				i++;
                                         //			}
-                            Interval *interval = Interval::of(startIndex, stopIndex);
+                            Interval interval(startIndex, stopIndex);
                             std::cout << std::wstring(L"reportAmbiguity ") << ambigAlts << std::wstring(L":") << configs << std::wstring(L", input=") << parser->getTokenStream()->getText(interval) << std::endl;
                         }
                         if (parser != nullptr) {
@@ -1104,9 +1257,75 @@ namespace org {
                         return mode;
                     }
 
+                    void ParserATNSimulator::setPredictionBudget(PredictionBudget *budget) {
+                        this->budget = budget;
+                        if (budget != nullptr) {
+                            budget->start();
+                        }
+                    }
+
+                    org::antlr::v4::runtime::atn::PredictionBudget *ParserATNSimulator::getPredictionBudget() {
+                        return budget;
+                    }
+
+                    void ParserATNSimulator::setLeanDFA(bool leanDFA) {
+                        this->leanDFA = leanDFA;
+                    }
+
+                    bool ParserATNSimulator::isLeanDFA() {
+                        return leanDFA;
+                    }
+
+                    void ParserATNSimulator::setEvictionPolicy(dfa::DFAEvictionPolicy *evictionPolicy) {
+                        this->evictionPolicy = evictionPolicy;
+                    }
+
+                    org::antlr::v4::runtime::dfa::DFAEvictionPolicy *ParserATNSimulator::getEvictionPolicy() {
+                        return evictionPolicy;
+                    }
+
+                    void ParserATNSimulator::compactDFAState(dfa::DFAState *D) {
+                        if (D == ERROR || D->isCompacted() || !D->isAcceptState || D->requiresFullContext || D->origin == nullptr) {
+                            return;
+                        }
+
+                        D->configsHash = D->configs->hashCode();
+                        ATNConfigSet *configs = D->configs;
+                        D->configs = nullptr;
+                        if (evictionPolicy != nullptr) {
+                            // another prediction may still be reading them
+                            evictionPolicy->retire(configs);
+                        } else {
+                            delete configs;
+                        }
+                    }
+
+                    org::antlr::v4::runtime::atn::ATNConfigSet *ParserATNSimulator::getConfigs(dfa::DFAState *D) {
+                        if (!D->isCompacted()) {
+                            return D->configs;
+                        }
+
+                        // only accept states are compacted, and an accept state is never the
+                        // origin of another state, so the origin still has its configurations
+                        ATNConfigSet *configs = computeReachSet(D->origin->configs, D->originSymbol, false);
+                        configs->optimizeConfigs(this);
+                        configs->setReadonly(true);
+                        return configs;
+                    }
+
+                    void ParserATNSimulator::clearPredicateMemo() {
+                        predicateMemo.clear();
+                        predicateMemoIndex = -1;
+                    }
+
                     void ParserATNSimulator::InitializeInstanceFields() {
                         mode = PredictionMode::LL;
                         _startIndex = 0;
+                        _closureIndex = 0;
+                        budget = nullptr;
+                        predicateMemoIndex = -1;
+                        leanDFA = false;
+                        evictionPolicy = nullptr;
                     }
                 }
             }
@@ -3,6 +3,7 @@
 #include "ATNSimulator.h"
 #include "PredictionMode.h"
 #include "DFAState.h"
+#include "ClosureBusySet.h"
 #include "stringconverter.h"
 #include "Declarations.h"
 
@@ -11,6 +12,7 @@
 #include <set>
 #include <iostream>
 #include <bitset>
+#include <unordered_map>
 
 
 
@@ -284,6 +286,33 @@ namespace org {
                         int _startIndex;
                         ParserRuleContext *_outerContext;
 
+                        /// <summary>
+                        /// The token index the configurations currently being closed over
+                        ///  will match next; a rule entered during closure starts there. </summary>
+                        int _closureIndex;
+
+                        /// <summary>
+                        /// Limits on prediction work, or {@code null} for none. Not owned. </summary>
+                        PredictionBudget *budget;
+
+                        /// <summary>
+                        /// Results of pure predicates evaluated at token {@code predicateMemoIndex},
+                        ///  keyed by rule and predicate index. See <seealso cref="#evalPredicate"/>. </summary>
+                        std::unordered_map<int, bool> predicateMemo;
+                        int predicateMemoIndex;
+
+                        /// <summary>
+                        /// Reused by every closure; see <seealso cref="#closure"/>. </summary>
+                        ClosureBusySet closureBusy;
+
+                        /// <summary>
+                        /// Compact SLL accept states as they are added. See <seealso cref="#compactDFAState"/>. </summary>
+                        bool leanDFA;
+
+                        /// <summary>
+                        /// Quotas on the number of DFA states, or {@code null} for none. Not owned. </summary>
+                        dfa::DFAEvictionPolicy *evictionPolicy;
+
                         /// <summary>
                         /// Testing only! </summary>
                     public:
@@ -384,11 +413,54 @@ namespace org {
 
                         virtual ATNConfigSet *computeStartState(ATNState *p, RuleContext *ctx, bool fullCtx);
 
+                        /// <summary>
+                        /// This method transforms the start state computed by
+                        /// <seealso cref="#computeStartState"/> to the special start state used by a
+                        /// precedence DFA for a particular precedence value. The transformation
+                        /// process applies the following changes to the start state's configuration
+                        /// set.
+                        ///
+                        /// <ol>
+                        /// <li>Evaluate the precedence predicates for each configuration using
+                        /// <seealso cref="SemanticContext#evalPrecedence"/>.</li>
+                        /// <li>Remove all configurations which predict an alternative greater than
+                        /// 1, for which another configuration that predicts alternative 1 is in the
+                        /// same ATN state with the same prediction context. This transformation is
+                        /// valid for the following reasons:
+                        /// <ul>
+                        /// <li>The closure block cannot contain any epsilon transitions which bypass
+                        /// the body of the closure, so all states reachable via alternative 1 are
+                        /// part of the precedence alternatives of the transformed left-recursive
+                        /// rule.</li>
+                        /// <li>The "primary" portion of a left recursive rule cannot contain an
+                        /// epsilon transition, so the only way an alternative other than 1 can exist
+                        /// in a state that is also reachable via alternative 1 is by nesting calls
+                        /// to the left-recursive rule, with the outer calls not being at the
+                        /// preferred precedence level.</li>
+                        /// </ul>
+                        /// </li>
+                        /// </ol>
+                        ///
+                        /// The precedence predicates are evaluated once here, so the resulting DFA
+                        /// states carry no precedence predicates and prediction for the decision
+                        /// stays in the SLL DFA.
+                        /// </summary>
+                        /// <param name="configs"> The configuration set computed by
+                        /// <seealso cref="#computeStartState"/> as the start state for the DFA. </param>
+                        /// <returns> The transformed configuration set representing the start state
+                        /// for a precedence DFA at a particular precedence level (determined by
+                        /// calling <seealso cref="Parser#getPrecedence"/>). </returns>
+                        virtual ATNConfigSet *applyPrecedenceFilter(ATNConfigSet *configs);
+
                         virtual ATNState *getReachableTarget(Transition *trans, int ttype);
 
-                        virtual SemanticContext *getPredsForAmbigAlts(std::bitset<BITSET_SIZE> *ambigAlts, ATNConfigSet *configs, int nalts);
+                        /// <summary>
+                        /// Returns the predicate guarding each alternative in {@code ambigAlts},
+                        ///  indexed by alternative, or an empty vector if none is predicated.
+                        /// </summary>
+                        virtual std::vector<SemanticContext*> getPredsForAmbigAlts(std::bitset<BITSET_SIZE> *ambigAlts, ATNConfigSet *configs, int nalts);
 
-                        virtual dfa::DFAState::PredPrediction *getPredicatePredictions(std::bitset<BITSET_SIZE> *ambigAlts, SemanticContext altToPred[]);
+                        virtual std::vector<dfa::DFAState::PredPrediction*> getPredicatePredictions(std::bitset<BITSET_SIZE> *ambigAlts, const std::vector<SemanticContext*> &altToPred);
 
                         virtual int getAltThatFinishedDecisionEntryRule(ATNConfigSet *configs);
 
@@ -401,6 +473,17 @@ namespace org {
                         /// </summary>
                         virtual std::bitset<BITSET_SIZE> *evalSemanticContext(std::vector<dfa::DFAState::PredPrediction*> predPredictions, ParserRuleContext *outerContext, bool complete);
 
+                        /// <summary>
+                        /// Evaluates {@code pred} at the current input position. A context
+                        ///  independent predicate the parser declares pure with
+                        ///  <seealso cref="Recognizer#isPurePredicate"/> is evaluated once per token:
+                        ///  SLL predicate states, the full context retry and sibling decisions
+                        ///  starting at the same token all reuse the first result. The memo
+                        ///  only holds results for one token and is dropped as soon as a pure
+                        ///  predicate is evaluated at another one.
+                        /// </summary>
+                        virtual bool evalPredicate(SemanticContext *pred, ParserRuleContext *outerContext);
+
 
                         /* TODO: If we are doing predicates, there is no point in pursuing
                         	 closure operations if we reach a DFA state that uniquely predicts
@@ -409,13 +492,13 @@ namespace org {
                         	 ambig detection thought :(
                         	  */
 
-                        virtual void closure(ATNConfig *config, ATNConfigSet *configs, std::set<ATNConfig*> *closureBusy, bool collectPredicates, bool fullCtx);
+                        virtual void closure(ATNConfig *config, ATNConfigSet *configs, ClosureBusySet *closureBusy, bool collectPredicates, bool fullCtx);
 
-                        virtual void closureCheckingStopState(ATNConfig *config, ATNConfigSet *configs, std::set<ATNConfig*> *closureBusy, bool collectPredicates, bool fullCtx, int depth);
+                        virtual void closureCheckingStopState(ATNConfig *config, ATNConfigSet *configs, ClosureBusySet *closureBusy, bool collectPredicates, bool fullCtx, int depth);
 
                         /// <summary>
                         /// Do the actual work of walking epsilon edges </summary>
-                        virtual void closure_(ATNConfig *config, ATNConfigSet *configs, std::set<ATNConfig*> *closureBusy, bool collectPredicates, bool fullCtx, int depth);
+                        virtual void closure_(ATNConfig *config, ATNConfigSet *configs, ClosureBusySet *closureBusy, bool collectPredicates, bool fullCtx, int depth);
 
                     public:
                         virtual std::wstring getRuleName(int index);
@@ -433,6 +516,12 @@ namespace org {
 
                         virtual ATNConfig *ruleTransition(ATNConfig *config, RuleTransition *t);
 
+                        /// <summary>
+                        /// Returns {@code true} if the parser's <seealso cref="RuleMemoTable"/> says
+                        ///  the rule {@code t} invokes already failed at <seealso cref="#_closureIndex"/>.
+                        /// </summary>
+                        virtual bool isMemoizedFailure(RuleTransition *t);
+
                         virtual std::bitset<BITSET_SIZE> *getConflictingAlts(ATNConfigSet *configs);
 
                         /// <summary>
@@ -541,6 +630,62 @@ namespace org {
 
                         PredictionMode getPredictionMode();
 
+                        /// <summary>
+                        /// Enforces {@code budget} on every prediction from now on and starts
+                        ///  its clock; {@code null} removes the limits.
+                        /// </summary>
+                        void setPredictionBudget(PredictionBudget *budget);
+
+                        PredictionBudget *getPredictionBudget();
+
+                        /// <summary>
+                        /// Forgets every memoized predicate result. Call it when an action has
+                        ///  changed what a pure predicate looks at without consuming a token.
+                        /// </summary>
+                        void clearPredicateMemo();
+
+                        /// <summary>
+                        /// In a lean DFA, SLL accept states that don't require full context drop
+                        ///  their configuration sets once built; DFA simulation never looks at
+                        ///  them again, and error reporting rebuilds them on demand. States
+                        ///  already compacted stay compacted when the mode is turned off.
+                        /// </summary>
+                        void setLeanDFA(bool leanDFA);
+
+                        bool isLeanDFA();
+
+                        /// <summary>
+                        /// Reports the DFA states added from now on to {@code evictionPolicy} and
+                        ///  lets it evict after every prediction; {@code null} lets the DFAs
+                        ///  grow without bound. Simulators sharing DFAs must share the policy,
+                        ///  which then lets them predict concurrently: predictions read the DFAs
+                        ///  inside its <seealso cref="dfa.DFAEvictionPolicy.ReadGuard"/> and every
+                        ///  update holds its lock.
+                        /// </summary>
+                        void setEvictionPolicy(dfa::DFAEvictionPolicy *evictionPolicy);
+
+                        dfa::DFAEvictionPolicy *getEvictionPolicy();
+
+                        /// <summary>
+                        /// Returns the configurations of {@code D}, computing them again from the
+                        ///  state it was first reached from if it has been compacted. The result
+                        ///  for a compacted state is not stored back into it.
+                        /// </summary>
+                        virtual ATNConfigSet *getConfigs(dfa::DFAState *D);
+
+                    protected:
+                        /// <summary>
+                        /// Frees the configuration set of an SLL accept state that doesn't
+                        ///  require full context, keeping only its hash for
+                        ///  <seealso cref="#addDFAState"/> and what <seealso cref="#execATN"/> reads:
+                        ///  the prediction, the predicates and the accept flag. The
+                        ///  configurations themselves may be shared with other sets and are
+                        ///  left alone.
+                        /// </summary>
+                        virtual void compactDFAState(dfa::DFAState *D);
+
+                    public:
+
                     private:
                         void InitializeInstanceFields();
                     };
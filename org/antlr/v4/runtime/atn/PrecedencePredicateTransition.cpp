@@ -7,7 +7,7 @@ namespace org {
                 namespace atn {
                     using org::antlr::v4::runtime::misc::NotNull;
 
-                    PrecedencePredicateTransition::PrecedencePredicateTransition(ATNState *target, int precedence) : AbstractPredicateTransition(target), precedence(precedence) {
+                    PrecedencePredicateTransition::PrecedencePredicateTransition(ATNState *target, int precedence) : AbstractPredicateTransition(target, PRECEDENCE), precedence(precedence), predicate(SemanticContext::getPrecedencePredicate(precedence)) {
                     }
 
                     int PrecedencePredicateTransition::getSerializationType() {
@@ -23,7 +23,7 @@ namespace org {
                     }
 
                     org::antlr::v4::runtime::atn::SemanticContext::PrecedencePredicate *PrecedencePredicateTransition::getPredicate() {
-                        return new SemanticContext::PrecedencePredicate(precedence);
+                        return predicate;
                     }
 
                     std::wstring PrecedencePredicateTransition::toString() {
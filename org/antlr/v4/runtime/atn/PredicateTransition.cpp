@@ -8,7 +8,7 @@ namespace org {
                 namespace atn {
                     using org::antlr::v4::runtime::misc::NotNull;
 
-                    PredicateTransition::PredicateTransition(ATNState *target, int ruleIndex, int predIndex, bool isCtxDependent) : AbstractPredicateTransition(target), ruleIndex(ruleIndex), predIndex(predIndex), isCtxDependent(isCtxDependent) {
+                    PredicateTransition::PredicateTransition(ATNState *target, int ruleIndex, int predIndex, bool isCtxDependent) : AbstractPredicateTransition(target, PREDICATE), ruleIndex(ruleIndex), predIndex(predIndex), isCtxDependent(isCtxDependent), predicate(SemanticContext::getPredicate(ruleIndex, predIndex, isCtxDependent)) {
                     }
 
                     int PredicateTransition::getSerializationType() {
@@ -24,8 +24,7 @@ namespace org {
                     }
 
                     org::antlr::v4::runtime::atn::SemanticContext::Predicate *PredicateTransition::getPredicate() {
-                        // TODO: who is responsible for managing this memory?
-                        return new SemanticContext::Predicate(ruleIndex, predIndex, isCtxDependent);
+                        return predicate;
                     }
 
                     std::wstring PredicateTransition::toString() {
@@ -67,6 +67,11 @@ namespace org {
 
                         virtual std::wstring toString();
 
+                    private:
+                        /// <summary>
+                        /// Interned once here so prediction never takes the intern lock. </summary>
+                        SemanticContext::Predicate *const predicate;
+
                     };
 
                 }
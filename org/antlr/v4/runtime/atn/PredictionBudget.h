@@ -0,0 +1,164 @@
+﻿#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace atn {
+
+                    /// <summary>
+                    /// Limits on how much work <seealso cref="ParserATNSimulator"/> may spend on
+                    ///  prediction, so that one adversarial input can't stall a parse. Any
+                    ///  limit left at 0 is not enforced. Exceeding one throws
+                    ///  <seealso cref="PredictionBudgetExceededException"/>, which cancels the parse
+                    ///  like <seealso cref="misc.ParseCancellationException"/> does.
+                    /// <p/>
+                    /// The counters are kept whether or not limits are set, and are meant
+                    ///  for choosing limits from real traffic. Prediction that is answered
+                    ///  from the DFA cache only pays for the lookahead check; closure and
+                    ///  the clock are only looked at while simulating the ATN.
+                    /// </summary>
+                    class PredictionBudget {
+                    public:
+                        enum class Limit {
+                            LOOKAHEAD,
+                            CONFIGS,
+                            CLOSURE_OPERATIONS,
+                            DEADLINE
+                        };
+
+                        static const size_t LIMIT_COUNT = 4;
+
+                        /// <summary>
+                        /// How often, in closure operations, the deadline is checked. </summary>
+                        static const size_t DEADLINE_CHECK_INTERVAL = 1024;
+
+                        /// <summary>
+                        /// Tokens a single prediction may look at. </summary>
+                        size_t maxLookahead;
+
+                        /// <summary>
+                        /// Configurations a single reach set may hold. </summary>
+                        size_t maxConfigs;
+
+                        /// <summary>
+                        /// Closure operations per parse. </summary>
+                        size_t maxClosureOperations;
+
+                        /// <summary>
+                        /// Wall-clock time per parse, counted from <seealso cref="#start"/>. </summary>
+                        std::chrono::steady_clock::duration timeLimit;
+
+                        size_t predictions;
+                        size_t fullContextPredictions;
+                        size_t deepestLookahead;
+                        size_t largestConfigSet;
+
+                        /// <summary>
+                        /// Closure operations since <seealso cref="#start"/>. </summary>
+                        size_t closureOperations;
+
+                        /// <summary>
+                        /// How many times each <seealso cref="Limit"/> was exceeded. </summary>
+                        size_t exceeded[LIMIT_COUNT];
+
+                    protected:
+                        std::chrono::steady_clock::time_point deadline;
+
+                    public:
+                        PredictionBudget();
+
+                        virtual ~PredictionBudget() {}
+
+                        /// <summary>
+                        /// Begins a parse: restarts the closure count and the clock.
+                        ///  <seealso cref="ParserATNSimulator#reset"/> calls this, and so does
+                        ///  <seealso cref="ParserATNSimulator#setPredictionBudget"/>.
+                        /// </summary>
+                        virtual void start();
+
+                        /// <summary>
+                        /// Zeroes every counter. </summary>
+                        virtual void resetCounters();
+
+                        void checkLookahead(size_t depth) {
+                            if (depth > deepestLookahead) {
+                                deepestLookahead = depth;
+                            }
+                            if (maxLookahead != 0 && depth > maxLookahead) {
+                                exceed(Limit::LOOKAHEAD);
+                            }
+                        }
+
+                        void checkConfigs(size_t size) {
+                            if (size > largestConfigSet) {
+                                largestConfigSet = size;
+                            }
+                            if (maxConfigs != 0 && size > maxConfigs) {
+                                exceed(Limit::CONFIGS);
+                            }
+                        }
+
+                        void countClosure() {
+                            closureOperations++;
+                            if (maxClosureOperations != 0 && closureOperations > maxClosureOperations) {
+                                exceed(Limit::CLOSURE_OPERATIONS);
+                            }
+                            if (closureOperations % DEADLINE_CHECK_INTERVAL == 0) {
+                                checkDeadline();
+                            }
+                        }
+
+                        void checkDeadline() {
+                            if (timeLimit.count() != 0 && std::chrono::steady_clock::now() > deadline) {
+                                exceed(Limit::DEADLINE);
+                            }
+                        }
+
+                    protected:
+                        /// <summary>
+                        /// Counts the overrun and throws <seealso cref="PredictionBudgetExceededException"/>.
+                        /// </summary>
+                        virtual void exceed(Limit limit);
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -31,7 +31,8 @@
 #include "PredictionMode.h"
 
 #include <assert.h>
-#include "AbstractEqualityComparator.h"
+#include <algorithm>
+#include <cstdint>
 
 namespace org {
 namespace antlr {
@@ -39,42 +40,163 @@ namespace v4 {
 namespace runtime {
 namespace atn {
 
-class AltAndContextConfigEqualityComparator
-    : misc::AbstractEqualityComparator<ATNConfig> {
- public:
-  int hashCode(ATNConfig* o);
-  bool equals(ATNConfig* a, ATNConfig* b);
+namespace {
 
- private:
-  AltAndContextConfigEqualityComparator() {}
+// One configuration, reduced to what conflict analysis looks at.
+struct ConfigEntry {
+  int stateNumber;
+  int contextHash;
+  ATNState* state;
+  PredictionContext* context;
+  int alt;
 };
 
-// TODO -- Determine if we need this hash function.
-int AltAndContextConfigEqualityComparator::hashCode(ATNConfig* o) {
-  int hashCode = runtime::misc::MurmurHash::initialize(7);
-  hashCode = runtime::misc::MurmurHash::update(hashCode, o->state->stateNumber);
-  hashCode = runtime::misc::MurmurHash::update(hashCode, o->context);
-  return runtime::misc::MurmurHash::finish(hashCode, 2);
+// Alternatives below this fit in a uint64_t mask; larger decisions take the
+// BitSet path.
+const int kMaskAlts = 64;
+
+// Reused by every analysis on this thread; only ever grows.
+std::vector<ConfigEntry>& scratchEntries() {
+  static thread_local std::vector<ConfigEntry> entries;
+  return entries;
 }
 
-// TODO -- Determine if we need this comparator.
-bool AltAndContextConfigEqualityComparator::equals(ATNConfig* a, ATNConfig* b) {
-  if (a == b) {
-    return true;
+std::vector<PredictionContext*>& scratchContexts() {
+  static thread_local std::vector<PredictionContext*> contexts;
+  return contexts;
+}
+
+void addAlt(uint64_t* mask, int alt) { *mask |= uint64_t(1) << alt; }
+
+void addAlt(BitSet* alts, int alt) { alts->set(alt); }
+
+bool sameContext(PredictionContext* a, PredictionContext* b) {
+  return a == b || (a != nullptr && a->equals(b));
+}
+
+// Copies |configs| into |entries| sorted by (state, context hash), so that
+// every (state, context) group lies within one run of equal keys. Returns
+// the largest alternative seen.
+int sortConfigs(ATNConfigSet* configs, std::vector<ConfigEntry>* entries) {
+  int maxAlt = 0;
+  entries->clear();
+  for (ATNConfig* c : configs->configs) {
+    ConfigEntry e;
+    e.stateNumber = c->state->stateNumber;
+    e.contextHash = c->context != nullptr ? c->context->hashCode() : 0;
+    e.state = c->state;
+    e.context = c->context;
+    e.alt = c->alt;
+    entries->push_back(e);
+    maxAlt = std::max(maxAlt, c->alt);
   }
-  if (a == nullptr || b == nullptr) {
+  std::sort(entries->begin(), entries->end(),
+            [](const ConfigEntry& a, const ConfigEntry& b) {
+              if (a.stateNumber != b.stateNumber) {
+                return a.stateNumber < b.stateNumber;
+              }
+              return a.contextHash < b.contextHash;
+            });
+  return maxAlt;
+}
+
+// Appends the alternatives of each (state, context) group of the sorted
+// |entries| to |groups|, one Mask per group.
+template <typename Mask>
+void groupByStateAndContext(const std::vector<ConfigEntry>& entries,
+                            std::vector<Mask>* groups) {
+  std::vector<PredictionContext*>& contexts = scratchContexts();
+  groups->clear();
+  for (size_t i = 0, j; i < entries.size(); i = j) {
+    for (j = i + 1; j < entries.size() &&
+                    entries[j].stateNumber == entries[i].stateNumber &&
+                    entries[j].contextHash == entries[i].contextHash;
+         ++j) {
+    }
+
+    // Contexts in a run share a hash, so they are nearly always equal; tell
+    // them apart the slow way only when they aren't.
+    size_t first = groups->size();
+    contexts.clear();
+    for (size_t k = i; k < j; ++k) {
+      size_t g = 0;
+      while (g < contexts.size() &&
+             !sameContext(contexts[g], entries[k].context)) {
+        ++g;
+      }
+      if (g == contexts.size()) {
+        contexts.push_back(entries[k].context);
+        groups->push_back(Mask());
+      }
+      addAlt(&(*groups)[first + g], entries[k].alt);
+    }
+  }
+}
+
+// Appends the alternatives of each state in the sorted |entries| to
+// |groups|, and the state itself to |states| if it isn't null.
+template <typename Mask>
+void groupByState(const std::vector<ConfigEntry>& entries,
+                  std::vector<Mask>* groups, std::vector<ATNState*>* states) {
+  groups->clear();
+  for (size_t i = 0, j; i < entries.size(); i = j) {
+    Mask alts = Mask();
+    for (j = i; j < entries.size() &&
+                entries[j].stateNumber == entries[i].stateNumber;
+         ++j) {
+      addAlt(&alts, entries[j].alt);
+    }
+    groups->push_back(alts);
+    if (states != nullptr) {
+      states->push_back(entries[i].state);
+    }
+  }
+}
+
+bool hasMoreThanOne(uint64_t mask) { return (mask & (mask - 1)) != 0; }
+
+bool hasExactlyOne(uint64_t mask) { return mask != 0 && !hasMoreThanOne(mask); }
+
+bool hasMoreThanOne(const BitSet& alts) { return alts.count() > 1; }
+
+bool hasExactlyOne(const BitSet& alts) { return alts.count() == 1; }
+
+template <typename Mask>
+bool conflictTerminates(const std::vector<ConfigEntry>& entries) {
+  std::vector<Mask> groups;
+  groupByStateAndContext(entries, &groups);
+  bool conflict = std::any_of(groups.begin(), groups.end(),
+                              [](const Mask& m) { return hasMoreThanOne(m); });
+  if (!conflict) {
     return false;
   }
-  return a->state->stateNumber == b->state->stateNumber &&
-         a->context->equals(b->context);
+
+  groupByState(entries, &groups, nullptr);
+  return std::none_of(groups.begin(), groups.end(),
+                      [](const Mask& m) { return hasExactlyOne(m); });
 }
 
-/// <summary>
-/// A Map that uses just the state and the stack context as the key. </summary>
-class AltAndContextMap : public std::map<ATNConfig, BitSet> {
- public:
-  AltAndContextMap() {}
-};
+// The lowest alternative in |alts|, or -1 if there is none.
+int nextSetBit(const BitSet& alts) {
+  static const BitSet kLowWord(~0ULL);
+  unsigned long long low = (alts & kLowWord).to_ullong();
+  if (low != 0) {
+    int i = 0;
+    while ((low & 1) == 0) {
+      low >>= 1;
+      ++i;
+    }
+    return i;
+  }
+  for (size_t i = kMaskAlts; i < alts.size(); ++i) {
+    if (alts[i]) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+}  // namespace
 
 bool hasSLLConflictTerminatingPrediction(PredictionMode* mode,
                                          ATNConfigSet* configs) {
@@ -87,6 +209,9 @@ bool hasSLLConflictTerminatingPrediction(PredictionMode* mode,
     return true;
   }
 
+  ATNConfigSet* dup = nullptr;
+  std::vector<ATNConfig*> dupConfigs;
+
   // pure SLL mode parsing
   if (*mode == PredictionMode::SLL) {
     // Don't bother with combining configs from different semantic
@@ -94,9 +219,10 @@ bool hasSLLConflictTerminatingPrediction(PredictionMode* mode,
     // since we'll often fail over anyway.
     if (configs->hasSemanticContext) {
       // dup configs, tossing out semantic predicates
-      ATNConfigSet* dup = new ATNConfigSet();
-      for (ATNConfig config : *configs) {
-        ATNConfig* c = new ATNConfig(&config, SemanticContext::NONE);
+      dup = new ATNConfigSet();
+      for (ATNConfig* config : configs->configs) {
+        ATNConfig* c = new ATNConfig(config, SemanticContext::NONE);
+        dupConfigs.push_back(c);
         dup->add(c);
       }
       configs = dup;
@@ -104,16 +230,25 @@ bool hasSLLConflictTerminatingPrediction(PredictionMode* mode,
     // now we have combined contexts for configs with dissimilar preds
   }
 
-  // pure SLL or combined SLL+LL mode parsing
-  std::vector<BitSet> altsets = getConflictingAltSubsets(configs);
-  bool heuristic =
-      hasConflictingAltSet(altsets) && !hasStateAssociatedWithOneAlt(configs);
+  // pure SLL or combined SLL+LL mode parsing: a conflicting (state, context)
+  // subset, and no state that only one alternative reaches
+  std::vector<ConfigEntry>& entries = scratchEntries();
+  bool heuristic = sortConfigs(configs, &entries) < kMaskAlts
+                       ? conflictTerminates<uint64_t>(entries)
+                       : conflictTerminates<BitSet>(entries);
+
+  if (dup != nullptr) {
+    delete dup;
+    for (ATNConfig* c : dupConfigs) {
+      delete c;
+    }
+  }
   return heuristic;
 }
 
 bool hasConfigInRuleStopState(ATNConfigSet* configs) {
-  for (ATNConfig c : *configs) {
-    if (dynamic_cast<RuleStopState*>(c.state) != NULL) {
+  for (ATNConfig* c : configs->configs) {
+    if (c->state->getStateType() == ATNState::RULE_STOP) {
       return true;
     }
   }
@@ -122,8 +257,8 @@ bool hasConfigInRuleStopState(ATNConfigSet* configs) {
 }
 
 bool allConfigsInRuleStopStates(ATNConfigSet* configs) {
-  for (ATNConfig config : *configs) {
-    if (dynamic_cast<RuleStopState*>(config.state) == NULL) {
+  for (ATNConfig* config : configs->configs) {
+    if (config->state->getStateType() != ATNState::RULE_STOP) {
       return false;
     }
   }
@@ -140,7 +275,7 @@ bool allSubsetsConflict(const std::vector<BitSet>& altsets) {
 }
 
 bool hasNonConflictingAltSet(const std::vector<BitSet>& altsets) {
-  for (BitSet alts : altsets) {
+  for (const BitSet& alts : altsets) {
     if (alts.count() == 1) {
       return true;
     }
@@ -149,7 +284,7 @@ bool hasNonConflictingAltSet(const std::vector<BitSet>& altsets) {
 }
 
 bool hasConflictingAltSet(const std::vector<BitSet>& altsets) {
-  for (BitSet alts : altsets) {
+  for (const BitSet& alts : altsets) {
     if (alts.count() > 1) {
       return true;
     }
@@ -175,55 +310,68 @@ bool allSubsetsEqual(const std::vector<BitSet>& altsets) {
 int getUniqueAlt(const std::vector<BitSet>& altsets) {
   BitSet all = getAlts(altsets);
   if (all.count() == 1) {
-    // TODO -- Create a nextBit helper function.
-    for (int i = 0; i < all.size(); ++i) {
-      if (all[i]) {
-        return i;
-      }
-    }
+    return nextSetBit(all);
   }
   return ATN::INVALID_ALT_NUMBER;
 }
 
 BitSet getAlts(const std::vector<BitSet>& altsets) {
   BitSet all;
-  for (BitSet alts : altsets) {
+  for (const BitSet& alts : altsets) {
     all |= alts;
   }
   return all;
 }
 
 std::vector<BitSet> getConflictingAltSubsets(ATNConfigSet* configs) {
-  AltAndContextMap configToAlts;
-  for (const ATNConfig& c : *configs) {
-    configToAlts[c].set(c.alt);
-  }
+  std::vector<ConfigEntry>& entries = scratchEntries();
   std::vector<BitSet> values;
-  for (auto it : configToAlts) {
-    values.push_back(it.second);
+  if (sortConfigs(configs, &entries) < kMaskAlts) {
+    std::vector<uint64_t> masks;
+    groupByStateAndContext(entries, &masks);
+    values.reserve(masks.size());
+    for (uint64_t mask : masks) {
+      values.push_back(BitSet((unsigned long long)mask));
+    }
+  } else {
+    groupByStateAndContext(entries, &values);
   }
   return values;
 }
 
-std::map<ATNState, BitSet> getStateToAltMap(ATNConfigSet* configs) {
-  std::map<ATNState, BitSet> m;
-  for (ATNConfig c : *configs) {
-    m[*c.state].set(c.alt);
+std::map<ATNState*, BitSet> getStateToAltMap(ATNConfigSet* configs) {
+  std::vector<ConfigEntry>& entries = scratchEntries();
+  sortConfigs(configs, &entries);
+  std::vector<BitSet> groups;
+  std::vector<ATNState*> states;
+  groupByState(entries, &groups, &states);
+
+  std::map<ATNState*, BitSet> m;
+  for (size_t i = 0; i < states.size(); ++i) {
+    m[states[i]] = groups[i];
   }
   return m;
 }
 
+bool hasStateAssociatedWithOneAlt(ATNConfigSet* configs) {
+  std::vector<ConfigEntry>& entries = scratchEntries();
+  if (sortConfigs(configs, &entries) < kMaskAlts) {
+    std::vector<uint64_t> masks;
+    groupByState(entries, &masks, nullptr);
+    return std::any_of(masks.begin(), masks.end(),
+                       [](uint64_t m) { return hasExactlyOne(m); });
+  }
+
+  std::vector<BitSet> alts;
+  groupByState(entries, &alts, nullptr);
+  return std::any_of(alts.begin(), alts.end(),
+                     [](const BitSet& m) { return hasExactlyOne(m); });
+}
+
 int getSingleViableAlt(const std::vector<BitSet>& altsets) {
   BitSet viableAlts;
-  for (BitSet alts : altsets) {
-    int minAlt = -1;
-    // TODO -- Create a nextBit helper function.
-    for (int i = 0; i < alts.size(); ++i) {
-      if (alts[i]) {
-        minAlt = i;
-        break;
-      }
-    }
+  for (const BitSet& alts : altsets) {
+    int minAlt = nextSetBit(alts);
     assert(minAlt != -1);  // TODO -- Remove this after verification.
     viableAlts.set(minAlt);
     if (viableAlts.count() > 1)  // more than 1 viable alt
@@ -231,14 +379,9 @@ int getSingleViableAlt(const std::vector<BitSet>& altsets) {
       return ATN::INVALID_ALT_NUMBER;
     }
   }
-  // TODO -- Create a nextBit helper function.
-  for (int i = 0; i < viableAlts.size(); ++i) {
-    if (viableAlts[i]) {
-      return i;
-    }
-  }
-  assert(false);  // TODO -- Remove this after verification.
-  return -1;
+  int alt = nextSetBit(viableAlts);
+  assert(alt != -1);  // TODO -- Remove this after verification.
+  return alt;
 }
 
 }  // namespace atn
@@ -508,9 +508,12 @@ std::vector<BitSet> getConflictingAltSubsets(ATNConfigSet *configs);
 /// cref="ATNConfig#alt alt"/>
 /// </pre>
 /// </summary>
-std::map<ATNState, BitSet> getStateToAltMap(ATNConfigSet *configs);
+std::map<ATNState *, BitSet> getStateToAltMap(ATNConfigSet *configs);
 
-// TODO -- Add docs.
+/// <summary>
+/// Returns {@code true} if some state in {@code configs} is reached by exactly
+/// one alternative.
+/// </summary>
 bool hasStateAssociatedWithOneAlt(ATNConfigSet *configs);
 
 // TODO -- Add docs.
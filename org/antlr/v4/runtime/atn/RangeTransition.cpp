@@ -38,7 +38,9 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
-                    RangeTransition::RangeTransition(ATNState *target, int from, int to) : Transition(target), from(from), to(to) {
+                    RangeTransition::RangeTransition(ATNState *target, int from, int to) : Transition(target, RANGE), from(from), to(to) {
+                        matchFrom = from;
+                        matchTo = to;
                     }
 
                     int RangeTransition::getSerializationType() {
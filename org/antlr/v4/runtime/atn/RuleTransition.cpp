@@ -1,4 +1,5 @@
 ﻿#include "RuleTransition.h"
+#include "RuleStartState.h"
 
 /*
  * [The "BSD license"]
@@ -37,10 +38,11 @@ namespace org {
                 namespace atn {
 
                     // this(ruleStart, ruleIndex, 0, followState);
-                    RuleTransition::RuleTransition(RuleStartState *ruleStart, int ruleIndex, ATNState *followState) : Transition(followState), ruleIndex(ruleIndex), precedence(0) {
+                    RuleTransition::RuleTransition(RuleStartState *ruleStart, int ruleIndex, ATNState *followState) : Transition(ruleStart, RULE), ruleIndex(ruleIndex), precedence(0) {
+                        this->followState = followState;
                     }
 
-                    RuleTransition::RuleTransition(RuleStartState *ruleStart, int ruleIndex, int precedence, ATNState *followState) : Transition(followState), ruleIndex(ruleIndex), precedence(precedence) {
+                    RuleTransition::RuleTransition(RuleStartState *ruleStart, int ruleIndex, int precedence, ATNState *followState) : Transition(ruleStart, RULE), ruleIndex(ruleIndex), precedence(precedence) {
                         this->followState = followState;
                     }
 
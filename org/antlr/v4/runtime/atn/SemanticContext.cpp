@@ -1,9 +1,12 @@
 ﻿#include <typeinfo>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
 
 #include "SemanticContext.h"
 #include "MurmurHash.h"
-#include "Utils.h"
-#include "Arrays.h"
+#include "Parser.h"
 
 /*
  * [The "BSD license"]
@@ -40,274 +43,347 @@ namespace org {
         namespace v4 {
             namespace runtime {
                 namespace atn {
-                    SemanticContext::Predicate::Predicate() : ruleIndex(-1), predIndex(-1), isCtxDependent(false) {
-                    }
 
-                    SemanticContext::Predicate::Predicate(int ruleIndex, int predIndex, bool isCtxDependent) : ruleIndex(ruleIndex), predIndex(predIndex), isCtxDependent(isCtxDependent) {
-                    }
+                    static const int AND_HASH_SEED = 0x414E44;
+                    static const int OR_HASH_SEED = 0x4F52;
 
-                    std::wstring SemanticContext::toString() {
-#ifdef TODO 
-                        WRITE ME
-#endif
-                        return nullptr;
-                    }
-                    
-                    int SemanticContext::hashCode() {
-#ifdef TODO
-                        WRITE ME
-#endif
-                        return 0;
-                    }
-                    
-                    bool SemanticContext::equals(void *obj) {
-                        // "SemanticContext::equals should have been called on a daughter class"
-                        throw new std::exception();
-                    }
-                    
-                    template<typename T1, typename T2>
-                    bool SemanticContext::Predicate::eval(Recognizer<T1, T2> *parser, RuleContext *outerContext) {
-                        RuleContext *localctx = isCtxDependent ? outerContext : nullptr;
-                        return parser->sempred(localctx, ruleIndex, predIndex);
+                    // every interned context, by hash code; lookups compare the few
+                    // candidates with the same hash field by field
+                    static std::unordered_multimap<int, SemanticContext*> &internTable() {
+                        static std::unordered_multimap<int, SemanticContext*> table;
+                        return table;
                     }
 
-                    int SemanticContext::Predicate::hashCode() {
-                        int hashCode = misc::MurmurHash::initialize();
-                        hashCode = misc::MurmurHash::update(hashCode, ruleIndex);
-                        hashCode = misc::MurmurHash::update(hashCode, predIndex);
-                        hashCode = misc::MurmurHash::update(hashCode, isCtxDependent ? 1 : 0);
-                        hashCode = misc::MurmurHash::finish(hashCode, 3);
-                        return hashCode;
+                    static std::mutex &internMutex() {
+                        static std::mutex mutex;
+                        return mutex;
                     }
 
-                    bool SemanticContext::Predicate::equals(void *obj) {
-                        // TODO: this is wrong
-                        if (!((Predicate*)obj/*dynamic_cast<Predicate*>(obj)*/ != nullptr)) {
-                            return false;
+                    static int hashOperands(const std::vector<SemanticContext*> &opnds, int seed) {
+                        int hashCode = misc::MurmurHash::initialize(seed);
+                        for (SemanticContext *opnd : opnds) {
+                            hashCode = misc::MurmurHash::update(hashCode, opnd->hashCode());
                         }
-                        if (this == obj) {
-                            return true;
+                        return misc::MurmurHash::finish(hashCode, (int)opnds.size());
+                    }
+
+                    static std::wstring joinOperands(const std::vector<SemanticContext*> &opnds, const std::wstring &separator) {
+                        std::wstring result;
+                        for (std::vector<SemanticContext*>::size_type i = 0; i < opnds.size(); i++) {
+                            if (i > 0) {
+                                result += separator;
+                            }
+                            result += opnds[i]->toString();
                         }
-                        Predicate *p = static_cast<Predicate*>(obj);
-                        return this->ruleIndex == p->ruleIndex && this->predIndex == p->predIndex && this->isCtxDependent == p->isCtxDependent;
+                        return result;
                     }
 
-                    std::wstring SemanticContext::Predicate::toString() {
-                        return std::wstring(L"{") + std::to_wstring(ruleIndex) + std::wstring(L":") + std::to_wstring(predIndex) + std::wstring(L"}?");
+                    SemanticContext::SemanticContext() : cachedHashCode(0) {
                     }
 
-                    SemanticContext::PrecedencePredicate::PrecedencePredicate() : precedence(0) {
+                    int SemanticContext::hashCode() {
+                        return cachedHashCode;
                     }
 
-                    SemanticContext::PrecedencePredicate::PrecedencePredicate(int precedence) : precedence(precedence) {
+                    bool SemanticContext::equals(SemanticContext *obj) {
+                        // interned, so equal trees are the same instance
+                        return this == obj;
                     }
 
-                    template<typename T1, typename T2>
-                    bool SemanticContext::PrecedencePredicate::eval(Recognizer<T1, T2> *parser, RuleContext *outerContext) {
-                        return parser->precpred(outerContext, precedence);
+                    SemanticContext *SemanticContext::evalPrecedence(Parser *parser, RuleContext *outerContext) {
+                        return this;
                     }
 
-                    int SemanticContext::PrecedencePredicate::compareTo(PrecedencePredicate *o) {
-                        return precedence - o->precedence;
+                    template<typename T>
+                    T *SemanticContext::intern(const T &probe) {
+                        std::lock_guard<std::mutex> lock(internMutex());
+                        std::unordered_multimap<int, SemanticContext*> &table = internTable();
+                        auto range = table.equal_range(probe.cachedHashCode);
+                        for (auto it = range.first; it != range.second; ++it) {
+                            if (typeid(*it->second) == typeid(T) && probe.sameAs(it->second)) {
+                                return static_cast<T*>(it->second);
+                            }
+                        }
+
+                        T *instance = new T(probe);
+                        table.emplace(instance->cachedHashCode, instance);
+                        return instance;
+                    }
+
+                    SemanticContext::Predicate *SemanticContext::getPredicate(int ruleIndex, int predIndex, bool isCtxDependent) {
+                        return intern(Predicate(ruleIndex, predIndex, isCtxDependent));
                     }
 
-                    int SemanticContext::PrecedencePredicate::hashCode() {
-                        int hashCode = 1;
-                        hashCode = 31 * hashCode + precedence;
-                        return hashCode;
+                    SemanticContext::PrecedencePredicate *SemanticContext::getPrecedencePredicate(int precedence) {
+                        return intern(PrecedencePredicate(precedence));
                     }
 
-                    bool SemanticContext::PrecedencePredicate::equals(void *obj) {
-                        // TODO: this is wrong
-                        if (!((Predicate*)obj/*dynamic_cast<PrecedencePredicate*>(obj)*/ != nullptr)) {
-                            return false;
+                    SemanticContext *const SemanticContext::NONE = SemanticContext::getPredicate(-1, -1, false);
+
+                    std::vector<SemanticContext*> SemanticContext::flatten(SemanticContext *a, SemanticContext *b, bool conjunction) {
+                        std::vector<SemanticContext*> operands;
+                        for (SemanticContext *context : { a, b }) {
+                            const std::vector<SemanticContext*> *nested = nullptr;
+                            if (conjunction && dynamic_cast<AND*>(context) != nullptr) {
+                                nested = &static_cast<AND*>(context)->opnds;
+                            } else if (!conjunction && dynamic_cast<OR*>(context) != nullptr) {
+                                nested = &static_cast<OR*>(context)->opnds;
+                            }
+
+                            if (nested != nullptr) {
+                                operands.insert(operands.end(), nested->begin(), nested->end());
+                            } else {
+                                operands.push_back(context);
+                            }
+                        }
+
+                        // keep the precedence predicate that decides the result: the lowest
+                        // one for a conjunction, the highest one for a disjunction
+                        PrecedencePredicate *reduced = nullptr;
+                        std::vector<SemanticContext*> result;
+                        for (SemanticContext *operand : operands) {
+                            PrecedencePredicate *p = dynamic_cast<PrecedencePredicate*>(operand);
+                            if (p == nullptr) {
+                                result.push_back(operand);
+                            } else if (reduced == nullptr || (conjunction ? p->compareTo(reduced) < 0 : p->compareTo(reduced) > 0)) {
+                                reduced = p;
+                            }
+                        }
+                        if (reduced != nullptr) {
+                            result.push_back(reduced);
                         }
 
-                        if (this == obj) {
-                            return true;
+                        sortOperands(result);
+                        result.erase(std::unique(result.begin(), result.end()), result.end());
+
+                        // absorption: p && (p || q) is p, and p || (p && q) is p
+                        std::vector<SemanticContext*> absorbed;
+                        for (SemanticContext *operand : result) {
+                            const std::vector<SemanticContext*> *inner = nullptr;
+                            if (conjunction && dynamic_cast<OR*>(operand) != nullptr) {
+                                inner = &static_cast<OR*>(operand)->opnds;
+                            } else if (!conjunction && dynamic_cast<AND*>(operand) != nullptr) {
+                                inner = &static_cast<AND*>(operand)->opnds;
+                            }
+
+                            bool implied = false;
+                            if (inner != nullptr) {
+                                for (SemanticContext *other : result) {
+                                    if (other != operand && std::find(inner->begin(), inner->end(), other) != inner->end()) {
+                                        implied = true;
+                                        break;
+                                    }
+                                }
+                            }
+                            if (!implied) {
+                                absorbed.push_back(operand);
+                            }
                         }
 
-                        PrecedencePredicate *other = static_cast<PrecedencePredicate*>(obj);
-                        return this->precedence == other->precedence;
+                        return absorbed;
                     }
 
-                    std::wstring SemanticContext::PrecedencePredicate::toString() {
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                        return SemanticContext::toString();
-                    }
-
-#ifdef TODO
-                    // I can't make heads or tails of this
-                    SemanticContext::AND::AND(SemanticContext *a, SemanticContext *b) : opnds(operands::toArray(new SemanticContext[operands->size()])) {
-                        std::vector<SemanticContext*> *operands = new std::vector<SemanticContext*>();
-                        if ((AND*)a/*dynamic_cast<AND*>(a)*/ != nullptr) {
-                            operands->addAll(Arrays::asList((static_cast<AND*>(a))->opnds));
-                        } else {
-                            operands->add(a);
+                    void SemanticContext::sortOperands(std::vector<SemanticContext*> &operands) {
+                        // operands are interned, so the order only has to be the same every
+                        // time the same set is combined; ties on the hash fall back to identity
+                        std::sort(operands.begin(), operands.end(), [](SemanticContext *x, SemanticContext *y) {
+                            if (x->hashCode() != y->hashCode()) {
+                                return x->hashCode() < y->hashCode();
+                            }
+                            return std::less<SemanticContext*>()(x, y);
+                        });
+                    }
+
+                    SemanticContext *SemanticContext::And(SemanticContext *a, SemanticContext *b) {
+                        if (a == nullptr || a == NONE) {
+                            return b;
                         }
-                        if ((AND*)/*dynamic_cast<AND*>*/(b) != nullptr) {
-                            operands->addAll(Arrays::asList((static_cast<AND*>(b))->opnds));
-                        } else {
-                            operands->add(b);
+                        if (b == nullptr || b == NONE || a == b) {
+                            return a;
                         }
 
-                        std::vector<PrecedencePredicate*> precedencePredicates = filterPrecedencePredicates(operands);
-                        if (!precedencePredicates.empty()) {
-                            // interested in the transition with the lowest precedence
-                            PrecedencePredicate *reduced = Collections::min(precedencePredicates);
-                            operands->add(reduced);
+                        std::vector<SemanticContext*> operands = flatten(a, b, true);
+                        if (operands.size() == 1) {
+                            return operands[0];
                         }
 
+                        return intern(AND(operands));
                     }
-#endif
-                    bool SemanticContext::AND::equals(void *obj) {
-                        if (this == obj) {
-                            return true;
+
+                    SemanticContext *SemanticContext::Or(SemanticContext *a, SemanticContext *b) {
+                        if (a == nullptr) {
+                            return b;
                         }
-                        // TODO: this is wrong
-                        if (!((AND*)obj/*dynamic_cast<AND*>(obj)*/ != nullptr)) {
-                            return false;
+                        if (b == nullptr || a == b) {
+                            return a;
+                        }
+                        if (a == NONE || b == NONE) {
+                            return NONE;
                         }
-                        AND *other = static_cast<AND*>(obj);
-                        return (this->opnds == other->opnds);//Arrays::equals(this->opnds, other->opnds);
+
+                        std::vector<SemanticContext*> operands = flatten(a, b, false);
+                        if (operands.size() == 1) {
+                            return operands[0];
+                        }
+
+                        return intern(OR(operands));
                     }
 
-                    
-                    int SemanticContext::AND::hashCode() {
-                        return misc::MurmurHash::hashCode(opnds.data(), 1234 /*TODO: AND::typeid::hashCode()*/);
+                    SemanticContext::Predicate::Predicate(int ruleIndex, int predIndex, bool isCtxDependent) : ruleIndex(ruleIndex), predIndex(predIndex), isCtxDependent(isCtxDependent) {
+                        int hashCode = misc::MurmurHash::initialize();
+                        hashCode = misc::MurmurHash::update(hashCode, ruleIndex);
+                        hashCode = misc::MurmurHash::update(hashCode, predIndex);
+                        hashCode = misc::MurmurHash::update(hashCode, isCtxDependent ? 1 : 0);
+                        cachedHashCode = misc::MurmurHash::finish(hashCode, 3);
                     }
 
-                    
-                    template<typename T1, typename T2>
-                    bool SemanticContext::AND::eval(Recognizer<T1, T2> *parser, RuleContext *outerContext) {
-                        for (auto opnd : opnds) {
-                            if (!opnd->eval(parser, outerContext)) {
-                                return false;
-                            }
-                        }
-                        return true;
+                    bool SemanticContext::Predicate::eval(Parser *parser, RuleContext *outerContext) {
+                        RuleContext *localctx = isCtxDependent ? outerContext : nullptr;
+                        return parser->sempred(localctx, ruleIndex, predIndex);
                     }
 
-                    std::wstring SemanticContext::AND::toString() {
-                        // TODO: Utils class has not been declared
-                        // return Utils::join(Arrays::asList(opnds)->begin(), L"&&");
-
-                        return L"";
-                    }
-
-                    // TODO: operands is not defined.  In SemanticContext.java
-                    // it's declared as Set<SemanticContext> and initialized to
-                    // an instance of HashSet.
-//                    SemanticContext::OR::OR(SemanticContext *a, SemanticContext *b) : opnds(operands::toArray(new SemanticContext[operands->size()])) {
-//                        std::vector<SemanticContext*> *operands = new std::vector<SemanticContext*>();
-//                        if ((OR*)/*dynamic_cast<OR*>*/(a) != nullptr) {
-//                            operands->addAll(Arrays::asList( ((OR*)/*static_cast<OR*>*/(a))->opnds) );
-//                        } else {
-//                            operands->add(a);
-//                        }
-//                        if (dynamic_cast<OR*>(b) != nullptr) {
-//                            operands->addAll(Arrays::asList((static_cast<OR*>(b))->opnds));
-//                        } else {
-//                            operands->add(b);
-//                        }
-//
-//                        std::vector<PrecedencePredicate*> precedencePredicates = filterPrecedencePredicates(operands);
-//                        if (!precedencePredicates.empty()) {
-//                            // interested in the transition with the highest precedence
-//                            PrecedencePredicate *reduced = Collections::max(precedencePredicates);
-//                            operands->add(reduced);
-//                        }
-//                    }
-
-                    // TODO: changed obj from void* to SemanticContext*
-                    bool SemanticContext::OR::equals(SemanticContext *obj) {
-                        if (this == obj) {
-                            return true;
-                        }
+                    bool SemanticContext::Predicate::sameAs(SemanticContext *other) const {
+                        Predicate *p = static_cast<Predicate*>(other);
+                        return ruleIndex == p->ruleIndex && predIndex == p->predIndex && isCtxDependent == p->isCtxDependent;
+                    }
 
-                        if (obj == nullptr || typeid(*obj) != typeid(*this)) {
-                            return false;
+                    std::wstring SemanticContext::Predicate::toString() {
+                        return std::wstring(L"{") + std::to_wstring(ruleIndex) + std::wstring(L":") + std::to_wstring(predIndex) + std::wstring(L"}?");
+                    }
+
+                    SemanticContext::PrecedencePredicate::PrecedencePredicate(int precedence) : precedence(precedence) {
+                        cachedHashCode = 31 + precedence;
+                    }
+
+                    bool SemanticContext::PrecedencePredicate::eval(Parser *parser, RuleContext *outerContext) {
+                        return parser->precpred(outerContext, precedence);
+                    }
+
+                    SemanticContext *SemanticContext::PrecedencePredicate::evalPrecedence(Parser *parser, RuleContext *outerContext) {
+                        if (parser->precpred(outerContext, precedence)) {
+                            return SemanticContext::NONE;
                         }
+                        return nullptr;
+                    }
 
-                        // TODO: fix Array::equals
-                        //OR *other = static_cast<OR*>(obj);
-                        //return Arrays::equals(this->opnds, other->opnds);
-                        return false;
+                    int SemanticContext::PrecedencePredicate::compareTo(PrecedencePredicate *o) {
+                        return precedence - o->precedence;
                     }
 
-                    int SemanticContext::OR::hashCode() {
-                        // TODO: seed? (OR::typeid::hashCode()???)
-                        return misc::MurmurHash::hashCode(opnds, 0);
+                    bool SemanticContext::PrecedencePredicate::sameAs(SemanticContext *other) const {
+                        return precedence == static_cast<PrecedencePredicate*>(other)->precedence;
                     }
 
-                    template<typename T1, typename T2>
-                    bool SemanticContext::OR::eval(Recognizer<T1, T2> *parser, RuleContext *outerContext) {
-                        // TODO: opnds is not a container type (const
-                        // SemanticContext *).  Should it be changed to a
-                        // container type?
-//                        for (auto opnd : opnds) {
-//                            if (opnd->eval(parser, outerContext)) {
-//                                return true;
-//                            }
-//                        }
-                        return false;
+                    std::wstring SemanticContext::PrecedencePredicate::toString() {
+                        return std::wstring(L"{") + std::to_wstring(precedence) + std::wstring(L">=prec}?");
                     }
 
-                    std::wstring SemanticContext::OR::toString() {
-                        // TODO: Utils
-                        //return misc::Utils::join(Arrays::asList(opnds)->begin(), L"||");
-                        return L"";
+                    SemanticContext::AND::AND(const std::vector<SemanticContext*> &opnds) : opnds(opnds) {
+                        cachedHashCode = hashOperands(opnds, AND_HASH_SEED);
                     }
 
-                    SemanticContext *const SemanticContext::NONE = new Predicate();
+                    bool SemanticContext::AND::eval(Parser *parser, RuleContext *outerContext) {
+                        for (SemanticContext *opnd : opnds) {
+                            if (!opnd->eval(parser, outerContext)) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    }
 
-                    // TODO: huh???
-                    /*org::antlr::v4::runtime::atn::SemanticContext *SemanticContext::and(SemanticContext *a, SemanticContext *b) {
-                        if (a == nullptr || a == NONE) {
-                            return b;
+                    SemanticContext *SemanticContext::AND::evalPrecedence(Parser *parser, RuleContext *outerContext) {
+                        bool differs = false;
+                        std::vector<SemanticContext*> operands;
+                        for (SemanticContext *context : opnds) {
+                            SemanticContext *evaluated = context->evalPrecedence(parser, outerContext);
+                            differs |= (evaluated != context);
+                            if (evaluated == nullptr) {
+                                // The AND context is false if any element is false
+                                return nullptr;
+                            } else if (evaluated != NONE) {
+                                // Reduce the result by skipping true elements
+                                operands.push_back(evaluated);
+                            }
                         }
-                        if (b == nullptr || b == NONE) {
-                            return a;
+
+                        if (!differs) {
+                            return this;
                         }
-                        AND *result = new AND(a, b);
-                        if (result->opnds->length == 1) {
-                            return result->opnds[0];
+
+                        if (operands.empty()) {
+                            // all elements were true, so the AND context is true
+                            return NONE;
+                        }
+
+                        SemanticContext *result = operands[0];
+                        for (std::vector<SemanticContext*>::size_type i = 1; i < operands.size(); i++) {
+                            result = SemanticContext::And(result, operands[i]);
                         }
 
                         return result;
                     }
 
-                    org::antlr::v4::runtime::atn::SemanticContext *SemanticContext::or(SemanticContext *a, SemanticContext *b) {
-                        if (a == nullptr) {
-                            return b;
+                    bool SemanticContext::AND::sameAs(SemanticContext *other) const {
+                        return opnds == static_cast<AND*>(other)->opnds;
+                    }
+
+                    std::wstring SemanticContext::AND::toString() {
+                        return joinOperands(opnds, L"&&");
+                    }
+
+                    SemanticContext::OR::OR(const std::vector<SemanticContext*> &opnds) : opnds(opnds) {
+                        cachedHashCode = hashOperands(opnds, OR_HASH_SEED);
+                    }
+
+                    bool SemanticContext::OR::eval(Parser *parser, RuleContext *outerContext) {
+                        for (SemanticContext *opnd : opnds) {
+                            if (opnd->eval(parser, outerContext)) {
+                                return true;
+                            }
                         }
-                        if (b == nullptr) {
-                            return a;
+                        return false;
+                    }
+
+                    SemanticContext *SemanticContext::OR::evalPrecedence(Parser *parser, RuleContext *outerContext) {
+                        bool differs = false;
+                        std::vector<SemanticContext*> operands;
+                        for (SemanticContext *context : opnds) {
+                            SemanticContext *evaluated = context->evalPrecedence(parser, outerContext);
+                            differs |= (evaluated != context);
+                            if (evaluated == NONE) {
+                                // The OR context is true if any element is true
+                                return NONE;
+                            } else if (evaluated != nullptr) {
+                                // Reduce the result by skipping false elements
+                                operands.push_back(evaluated);
+                            }
                         }
-                        if (a == NONE || b == NONE) {
-                            return NONE;
+
+                        if (!differs) {
+                            return this;
                         }
-                        OR *result = new OR(a, b);
-                        if (result->opnds->length == 1) {
-                            return result->opnds[0];
+
+                        if (operands.empty()) {
+                            // all elements were false, so the OR context is false
+                            return nullptr;
                         }
 
-                        return result;
-                    }*/
-
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ template equivalent to generic constraints:
-                    template<typename T1> //where T1 : SemanticContext
-                    std::vector<SemanticContext::PrecedencePredicate*> SemanticContext::filterPrecedencePredicates(std::set<T1> *collection) {
-                        std::vector<PrecedencePredicate*> result;
-                        for (std::set<SemanticContext*>::const_iterator iterator = collection->begin(); iterator != collection->end(); ++iterator) {
-                            SemanticContext *context = *iterator;
-                            if (dynamic_cast<PrecedencePredicate*>(context) != nullptr) {
-                                result.push_back(static_cast<PrecedencePredicate*>(context));
-                            }
+                        SemanticContext *result = operands[0];
+                        for (std::vector<SemanticContext*>::size_type i = 1; i < operands.size(); i++) {
+                            result = SemanticContext::Or(result, operands[i]);
                         }
 
                         return result;
                     }
+
+                    bool SemanticContext::OR::sameAs(SemanticContext *other) const {
+                        return opnds == static_cast<OR*>(other)->opnds;
+                    }
+
+                    std::wstring SemanticContext::OR::toString() {
+                        return joinOperands(opnds, L"||");
+                    }
+
                 }
             }
         }
@@ -1,10 +1,7 @@
 ﻿#pragma once
 
-#include "Recognizer.h"
-#include "SemanticContext.h"
 #include <string>
 #include <vector>
-#include <set>
 
 #include "Declarations.h"
 
@@ -52,25 +49,33 @@ namespace org {
                     /// <p/>
                     ///  I have scoped the <seealso cref="AND"/>, <seealso cref="OR"/>, and <seealso cref="Predicate"/> subclasses of
                     ///  <seealso cref="SemanticContext"/> within the scope of this outer class.
+                    /// <p/>
+                    ///  Contexts are hash-consed: every one is obtained from
+                    ///  <seealso cref="#getPredicate"/>, <seealso cref="#getPrecedencePredicate"/>, <seealso cref="#And"/> or
+                    ///  <seealso cref="#Or"/>, which return the one shared instance for each
+                    ///  distinct tree. Equal contexts are therefore the same object, and
+                    ///  <seealso cref="#equals"/> is a pointer comparison. The hash code of each
+                    ///  instance is computed once when it is created. Instances live for the
+                    ///  rest of the program and must not be deleted.
                     /// </summary>
                     class SemanticContext {
 
                     public:
                         static SemanticContext *const NONE;
-                        
-                        virtual int hashCode() ;
-                        
+
                         class Predicate;
                         class PrecedencePredicate;
                         class AND;
                         class OR;
-                        
-                        SemanticContext *parent;
 
-                        std::wstring toString();
-                        
-                        virtual bool equals(void *obj);
-                        
+                        virtual ~SemanticContext() {}
+
+                        virtual int hashCode();
+
+                        virtual bool equals(SemanticContext *obj);
+
+                        virtual std::wstring toString() = 0;
+
                         /// <summary>
                         /// For context independent predicates, we evaluate them without a local
                         /// context (i.e., null context). That way, we can evaluate them without
@@ -84,25 +89,83 @@ namespace org {
                         /// prediction, so we passed in the outer context here in case of context
                         /// dependent predicate evaluation.
                         /// </summary>
-                        
-                        
-                        template<typename T1, typename T2>
-                        bool eval(Recognizer<T1, T2> *parser, RuleContext *outerContext);
+                        virtual bool eval(Parser *parser, RuleContext *outerContext) = 0;
 
+                        /// <summary>
+                        /// Evaluate the precedence predicates for the context and reduce the result.
+                        /// </summary>
+                        /// <param name="parser"> The parser instance. </param>
+                        /// <param name="outerContext"> The current parser context object. </param>
+                        /// <returns> The simplified semantic context after precedence predicates are
+                        /// evaluated, which will be one of the following values.
+                        /// <ul>
+                        /// <li><seealso cref="#NONE"/>: if the predicate simplifies to {@code true} after
+                        /// precedence predicates are evaluated.</li>
+                        /// <li>{@code null}: if the predicate simplifies to {@code false} after
+                        /// precedence predicates are evaluated.</li>
+                        /// <li>{@code this}: if the semantic context is not changed as a result of
+                        /// precedence predicate evaluation.</li>
+                        /// </ul> </returns>
+                        virtual SemanticContext *evalPrecedence(Parser *parser, RuleContext *outerContext);
+
+                        /// <summary>
+                        /// Returns the shared instance of the predicate {@code predIndex} of
+                        ///  rule {@code ruleIndex}.
+                        /// </summary>
+                        static Predicate *getPredicate(int ruleIndex, int predIndex, bool isCtxDependent);
+
+                        /// <summary>
+                        /// Returns the shared instance of the predicate {@code precedence >= _p}.
+                        /// </summary>
+                        static PrecedencePredicate *getPrecedencePredicate(int precedence);
+
+                        /// <summary>
+                        /// Returns the conjunction of {@code a} and {@code b}. {@code null} and
+                        ///  <seealso cref="#NONE"/> operands are dropped, nested conjunctions are
+                        ///  flattened, repeated operands appear once, only the lowest of several
+                        ///  precedence predicates is kept, and a disjunction already implied by
+                        ///  another operand is absorbed. A single remaining operand is returned
+                        ///  as is.
+                        /// </summary>
                         static SemanticContext *And(SemanticContext *a, SemanticContext *b);
 
-                        /// 
+                        /// <summary>
+                        /// Returns the disjunction of {@code a} and {@code b}, reduced like
+                        ///  <seealso cref="#And"/>: {@code null} operands are dropped, <seealso cref="#NONE"/>
+                        ///  makes the whole disjunction <seealso cref="#NONE"/>, only the highest of
+                        ///  several precedence predicates is kept, and a conjunction implying
+                        ///  another operand is absorbed.
+                        /// </summary>
                         ///  <seealso cref= ParserATNSimulator#getPredsForAmbigAlts </seealso>
                         static SemanticContext *Or(SemanticContext *a, SemanticContext *b);
 
-                    private:
+                    protected:
+                        /// <summary>
+                        /// Computed by each subclass constructor from the operands, which are
+                        ///  interned already, so it never changes. </summary>
+                        int cachedHashCode;
+
+                        SemanticContext();
+
+                        /// <summary>
+                        /// Compares the fields that make two contexts of the same type the
+                        ///  same tree; used to find the shared instance while interning.
+                        /// </summary>
+                        virtual bool sameAs(SemanticContext *other) const = 0;
 
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ template equivalent to generic constraints:
-                        template<typename T1>
-                        static std::vector<PrecedencePredicate*> filterPrecedencePredicates(std::set<T1> *collection);
+                        /// <summary>
+                        /// Returns the shared instance equal to {@code probe}, copying
+                        ///  {@code probe} into the table the first time it is seen.
+                        /// </summary>
+                        template<typename T>
+                        static T *intern(const T &probe);
 
+                    private:
+                        static std::vector<SemanticContext*> flatten(SemanticContext *a, SemanticContext *b, bool conjunction);
+
+                        static void sortOperands(std::vector<SemanticContext*> &operands);
                     };
-                    
+
 
                     class SemanticContext::Predicate : public SemanticContext {
                         friend class SemanticContext;
@@ -111,81 +174,85 @@ namespace org {
                         const int ruleIndex;
                         const int predIndex;
                         const bool isCtxDependent; // e.g., $i ref in pred
-                        
+
                     protected:
-                        Predicate();
-                        
-                    public:
                         Predicate(int ruleIndex, int predIndex, bool isCtxDependent);
 
-                        template<typename T1, typename T2>
-                        bool eval(Recognizer<T1, T2> *parser, RuleContext *outerContext);
+                    public:
+                        virtual bool eval(Parser *parser, RuleContext *outerContext) override;
+
+                        virtual std::wstring toString() override;
 
-                        virtual int hashCode() ;
-                        
-                        virtual bool equals(void *obj);
-                        
-                        virtual std::wstring toString() ;
+                    protected:
+                        virtual bool sameAs(SemanticContext *other) const override;
                     };
-                    
-                    class SemanticContext::PrecedencePredicate : public SemanticContext /*, public Comparable<PrecedencePredicate*>*/ {
+
+                    class SemanticContext::PrecedencePredicate : public SemanticContext {
+                        friend class SemanticContext;
+
                     public:
                         const int precedence;
-                        
+
                     protected:
-                        PrecedencePredicate();
-                        
-                    public:
                         PrecedencePredicate(int precedence);
 
-                        template<typename T1, typename T2>
-                        bool eval(Recognizer<T1, T2> *parser, RuleContext *outerContext);
+                    public:
+                        virtual bool eval(Parser *parser, RuleContext *outerContext) override;
+
+                        virtual SemanticContext *evalPrecedence(Parser *parser, RuleContext *outerContext) override;
 
-                        
                         virtual int compareTo(PrecedencePredicate *o);
-                        
-                        virtual int hashCode();
-                        
-                        virtual bool equals(void *obj);
-                        
-                        virtual std::wstring toString();
+
+                        virtual std::wstring toString() override;
+
+                    protected:
+                        virtual bool sameAs(SemanticContext *other) const override;
                     };
-                    
+
                     class SemanticContext::AND : public SemanticContext {
+                        friend class SemanticContext;
+
                     public:
-                        //JAVA TO C++ CONVERTER WARNING: Since the array size is not known in this declaration, Java to C++ Converter has converted this array to a pointer.  You will need to call 'delete[]' where appropriate:
-                        //ORIGINAL LINE: @NotNull public final SemanticContext[] opnds;
+                        /// <summary>
+                        /// Two or more interned operands, none of them an AND, in the
+                        ///  canonical order that <seealso cref="#And"/> sorts them into. </summary>
                         const std::vector<SemanticContext*> opnds;
-                        
-                        AND(SemanticContext *a, SemanticContext *b);
-                        
-                        virtual bool equals(void *obj);
-                        
-                        virtual int hashCode();
 
-                        template<typename T1, typename T2>
-                        bool eval(Recognizer<T1, T2> *parser, RuleContext *outerContext);
+                    protected:
+                        AND(const std::vector<SemanticContext*> &opnds);
+
+                    public:
+                        virtual bool eval(Parser *parser, RuleContext *outerContext) override;
+
+                        virtual SemanticContext *evalPrecedence(Parser *parser, RuleContext *outerContext) override;
 
-                        
-                        virtual std::wstring toString();
+                        virtual std::wstring toString() override;
+
+                    protected:
+                        virtual bool sameAs(SemanticContext *other) const override;
                     };
-                    
+
                     class SemanticContext::OR : public SemanticContext {
+                        friend class SemanticContext;
+
                     public:
-                        //JAVA TO C++ CONVERTER WARNING: Since the array size is not known in this declaration, Java to C++ Converter has converted this array to a pointer.  You will need to call 'delete[]' where appropriate:
-                        //ORIGINAL LINE: @NotNull public final SemanticContext[] opnds;
-                        const SemanticContext *opnds;
-                        
-                        OR(SemanticContext *a, SemanticContext *b);
-                        
-                        virtual bool equals(SemanticContext *obj);
-                        
-                        virtual int hashCode();
+                        /// <summary>
+                        /// Two or more interned operands, none of them an OR, in the
+                        ///  canonical order that <seealso cref="#Or"/> sorts them into. </summary>
+                        const std::vector<SemanticContext*> opnds;
 
-                        template<typename T1, typename T2>
-                        bool eval(Recognizer<T1, T2> *parser, RuleContext *outerContext);
+                    protected:
+                        OR(const std::vector<SemanticContext*> &opnds);
 
-                        virtual std::wstring toString();
+                    public:
+                        virtual bool eval(Parser *parser, RuleContext *outerContext) override;
+
+                        virtual SemanticContext *evalPrecedence(Parser *parser, RuleContext *outerContext) override;
+
+                        virtual std::wstring toString() override;
+
+                    protected:
+                        virtual bool sameAs(SemanticContext *other) const override;
                     };
 
                 }
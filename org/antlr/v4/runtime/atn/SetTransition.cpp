@@ -39,8 +39,12 @@ namespace org {
                 namespace atn {
 
 
-                    SetTransition::SetTransition(ATNState *target, misc::IntervalSet *aSet) :
-                    Transition(target), set(aSet==nullptr?misc::IntervalSet::of(Token::INVALID_TYPE):aSet) {
+                    SetTransition::SetTransition(ATNState *target, misc::IntervalSet *aSet) : SetTransition(target, aSet, SET) {
+                    }
+
+                    SetTransition::SetTransition(ATNState *target, misc::IntervalSet *aSet, int serializationType) :
+                    Transition(target, serializationType), set(aSet==nullptr?misc::IntervalSet::of(Token::INVALID_TYPE):aSet) {
+                        matchSet = set;
                     }
 
                     int SetTransition::getSerializationType() {
@@ -48,6 +48,10 @@ namespace org {
 
                         SetTransition(ATNState *target, misc::IntervalSet *set);
 
+                    protected:
+                        SetTransition(ATNState *target, misc::IntervalSet *set, int serializationType);
+
+                    public:
                         virtual int getSerializationType() override;
 
                         virtual misc::IntervalSet *label() override;
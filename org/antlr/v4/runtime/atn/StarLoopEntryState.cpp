@@ -6,6 +6,9 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
+                    StarLoopEntryState::StarLoopEntryState() : loopBackState(nullptr), precedenceRuleDecision(false) {
+                    }
+
                     int StarLoopEntryState::getStateType() {
                         return STAR_LOOP_ENTRY;
                     }
@@ -43,6 +43,19 @@ namespace org {
                     public:
                         StarLoopbackState *loopBackState;
 
+                        /// <summary>
+                        /// Indicates whether this state can benefit from a precedence DFA during SLL
+                        /// decision making: it is the decision of a left-recursive rule's operator
+                        /// loop, whose alternatives are guarded by precedence predicates.
+                        /// <p/>
+                        /// This is a computed property that is calculated during ATN deserialization
+                        /// and stored for use in <seealso cref="ParserATNSimulator"/>.
+                        /// </summary>
+                        /// <seealso cref= dfa.DFA#isPrecedenceDfa() </seealso>
+                        bool precedenceRuleDecision;
+
+                        StarLoopEntryState();
+
                         virtual int getStateType() override;
                     };
 
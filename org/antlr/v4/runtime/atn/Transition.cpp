@@ -46,7 +46,7 @@ namespace org {
 #endif
                     std::map<Transition *, int> *const Transition::serializationTypes = nullptr;
                     
-                    Transition::Transition(ATNState *target) {
+                    Transition::Transition(ATNState *target, int serializationType) : serializationType(serializationType), epsilon(serializationType == EPSILON || serializationType == RULE || serializationType == PREDICATE || serializationType == ACTION || serializationType == PRECEDENCE), matchFrom(0), matchTo(-1), matchSet(nullptr) {
                         if (target == nullptr) {
                             throw NullPointerException(L"target cannot be null.");
                         }
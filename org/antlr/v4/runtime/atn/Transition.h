@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "ATNState.h"
+#include "IntervalSet.h"
 #include "Declarations.h"
 
 
@@ -79,12 +80,54 @@ namespace org {
                         /// The target of this transition. </summary>
                         ATNState *target;
 
+                        /// <summary>
+                        /// The value <seealso cref="#getSerializationType"/> returns, fixed at
+                        ///  construction. The simulators switch on this tag instead of using
+                        ///  dynamic_cast or a virtual call to find out what a transition is.
+                        /// </summary>
+                        const int serializationType;
+
+                        /// <summary>
+                        /// The value <seealso cref="#isEpsilon"/> returns, derived from the tag. </summary>
+                        const bool epsilon;
+
                     protected:
-                        Transition(ATNState *target);
+                        /// <summary>
+                        /// Symbols matched by atom, range, set and not-set transitions, copied
+                        ///  into the base so <seealso cref="#matchesSymbol"/> can test them inline.
+                        ///  An atom matches matchFrom..matchFrom; matchSet is only set for set
+                        ///  and not-set transitions.
+                        /// </summary>
+                        int matchFrom;
+                        int matchTo;
+                        misc::IntervalSet *matchSet;
+
+                        Transition(ATNState *target, int serializationType);
 
                     public:
                         virtual int getSerializationType() = 0;
 
+                        /// <summary>
+                        /// Same as <seealso cref="#matches"/>, dispatched on
+                        ///  <seealso cref="#serializationType"/> without a virtual call.
+                        /// </summary>
+                        bool matchesSymbol(int symbol, int minVocabSymbol, int maxVocabSymbol) const {
+                            switch (serializationType) {
+                                case ATOM:
+                                    return symbol == matchFrom;
+                                case RANGE:
+                                    return symbol >= matchFrom && symbol <= matchTo;
+                                case SET:
+                                    return matchSet->contains(symbol);
+                                case NOT_SET:
+                                    return symbol >= minVocabSymbol && symbol <= maxVocabSymbol && !matchSet->contains(symbol);
+                                case WILDCARD:
+                                    return symbol >= minVocabSymbol && symbol <= maxVocabSymbol;
+                                default:
+                                    return false;
+                            }
+                        }
+
                         /// <summary>
                         /// Are we epsilon, action, sempred? </summary>
                         virtual bool isEpsilon();
@@ -37,7 +37,7 @@ namespace org {
             namespace runtime {
                 namespace atn {
 
-                    WildcardTransition::WildcardTransition(ATNState *target) : Transition(target) {
+                    WildcardTransition::WildcardTransition(ATNState *target) : Transition(target, WILDCARD) {
                     }
 
                     int WildcardTransition::getSerializationType() {
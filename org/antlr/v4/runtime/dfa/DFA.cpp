@@ -1,7 +1,13 @@
 ﻿#include "DFA.h"
 #include "DFASerializer.h"
 #include "LexerDFASerializer.h"
+#include "DFAState.h"
+#include "StarLoopEntryState.h"
+#include "ATNConfigSet.h"
+#include "Exceptions.h"
 #include <map>
+#include <algorithm>
+#include <sstream>
 /*
  * [The "BSD license"]
  *  Copyright (c) 2013 Terence Parr
@@ -38,59 +44,156 @@ namespace org {
                 namespace dfa {
 
 //JAVA TO C++ CONVERTER TODO TASK: Calls to same-class constructors are not supported in C++ prior to C++11:
-                    DFA::DFA(atn::DecisionState *atnStartState) : states(new std::map<DFAState*, DFAState*>()), atnStartState(atnStartState), decision(0) {
+                    DFA::DFA(atn::DecisionState *atnStartState) : states(new StateSet()), atnStartState(atnStartState), decision(0), s0(nullptr), lexerTable(nullptr), lastStateNumber(-1), clockHand(0), precedenceDfa(isPrecedenceDecision(atnStartState)) {
+                        initializePrecedenceStartState();
                     }
 
-                    DFA::DFA(atn::DecisionState *atnStartState, int decision) : decision(decision), atnStartState(atnStartState), states(new std::map<DFAState*, DFAState*>()) {
+                    DFA::DFA(atn::DecisionState *atnStartState, int decision) : decision(decision), atnStartState(atnStartState), states(new StateSet()), s0(nullptr), lexerTable(nullptr), lastStateNumber(-1), clockHand(0), precedenceDfa(isPrecedenceDecision(atnStartState)) {
+                        initializePrecedenceStartState();
                     }
 
-                    std::vector<DFAState*> DFA::getStates() {
-                        // Get all the keys, which C++ doesn't do natively, ugh
-                        std::map<DFAState*,DFAState*> mapints;
-                        std::vector<DFAState*> vints;
-                        for(auto imap: mapints) {
-                            vints.push_back(imap.first);
+                    bool DFA::isPrecedenceDecision(atn::DecisionState *atnStartState) {
+                        atn::StarLoopEntryState *entry = dynamic_cast<atn::StarLoopEntryState*>(atnStartState);
+                        return entry != nullptr && entry->precedenceRuleDecision;
+                    }
+
+                    void DFA::initializePrecedenceStartState() {
+                        if (precedenceDfa) {
+                            // the start state only holds the edges to the per-precedence start
+                            // states, indexed by precedence; it never matches anything itself
+                            s0 = new DFAState(new atn::ATNConfigSet());
+                            s0->isAcceptState = false;
+                            s0->requiresFullContext = false;
                         }
-                        return vints;
-#ifdef TODO
-                        // Do I need to sort these?
-//                        std::vector<DFAState*> result = std::vector<DFAState*>(states->);
-//                        Collections::sort(result, new ComparatorAnonymousInnerClassHelper(this));
-
-//                        return result;
-#endif
                     }
 
-#ifdef TODO
-                    DFA::ComparatorAnonymousInnerClassHelper::ComparatorAnonymousInnerClassHelper(DFA *outerInstance) {
-                        this->outerInstance = outerInstance;
+                    bool DFA::isPrecedenceDfa() {
+                        return precedenceDfa;
                     }
 
-                    int DFA::ComparatorAnonymousInnerClassHelper::compare(DFAState *o1, DFAState *o2) {
-                        return o1->stateNumber - o2->stateNumber;
+                    DFAState *DFA::getPrecedenceStartState(int precedence) {
+                        if (!isPrecedenceDfa()) {
+                            throw IllegalStateException(L"Only precedence DFAs may contain a precedence start state.");
+                        }
+
+                        return s0->edges.get(precedence);
+                    }
+
+                    void DFA::setPrecedenceStartState(int precedence, DFAState *startState, DFAEdgeMap::Retirer *retirer) {
+                        if (!isPrecedenceDfa()) {
+                            throw IllegalStateException(L"Only precedence DFAs may contain a precedence start state.");
+                        }
+
+                        // negative precedences are ignored by the edge map
+                        s0->edges.set(precedence, startState, retirer);
+                    }
+
+                    std::vector<DFAState*> DFA::getStates() {
+                        std::vector<DFAState*> result(states->begin(), states->end());
+                        std::sort(result.begin(), result.end(), [](DFAState *o1, DFAState *o2) {
+                            return o1->stateNumber < o2->stateNumber;
+                        });
+                        return result;
+                    }
+
+                    int DFA::newStateNumber() {
+                        return ++lastStateNumber;
+                    }
+
+                    std::vector<DFAState*> DFA::evictColdStates(size_t count, DFAEdgeMap::Retirer *retirer) {
+                        std::unordered_set<DFAState*> evicted;
+                        size_t buckets = states->bucket_count();
+                        if (clockHand >= buckets) {
+                            clockHand = 0; // the set was rehashed since the last sweep
+                        }
+
+                        // at most two turns, so a state spared on the first is taken on the
+                        // second unless prediction reached it in between
+                        for (size_t step = 0; step <= 2 * buckets && evicted.size() < count; step++) {
+                            StateSet::local_iterator it = states->begin(clockHand);
+                            for (; it != states->end(clockHand) && evicted.size() < count; ++it) {
+                                DFAState *state = *it;
+                                if (state == s0 || evicted.count(state) != 0) {
+                                    continue;
+                                }
+
+                                if (state->referenced) {
+                                    state->referenced = false;
+                                } else {
+                                    evicted.insert(state);
+                                }
+                            }
+                            if (it == states->end(clockHand)) {
+                                clockHand = (clockHand + 1) % buckets;
+                            }
+                        }
+
+                        std::vector<DFAState*> result;
+                        if (evicted.empty()) {
+                            return result;
+                        }
+
+                        // only accept states are compacted and they are never an origin, so
+                        // one round catches every state that can no longer be rebuilt
+                        for (DFAState *state : *states) {
+                            if (state->isCompacted() && evicted.count(state->origin) != 0) {
+                                evicted.insert(state);
+                            }
+                        }
+
+                        for (StateSet::iterator it = states->begin(); it != states->end();) {
+                            DFAState *state = *it;
+                            if (evicted.count(state) != 0) {
+                                result.push_back(state);
+                                it = states->erase(it);
+                                continue;
+                            }
+
+                            state->edges.removeTargets(evicted, retirer);
+                            if (evicted.count(state->origin) != 0) {
+                                state->origin = nullptr;
+                            }
+                            ++it;
+                        }
+
+                        // a precedence DFA's s0 isn't in the set but holds the start states
+                        if (s0 != nullptr) {
+                            s0->edges.removeTargets(evicted, retirer);
+                        }
+                        return result;
                     }
-#endif
+
                     std::wstring DFA::toString() {
                         std::vector<std::wstring> tokenNames;
                         return toString(tokenNames);
                     }
 
                     std::wstring DFA::toString(const std::vector<std::wstring>& tokenNames) {
+                        std::wstringstream buf;
+                        toString(tokenNames, buf);
+                        return buf.str();
+                    }
+
+                    void DFA::toString(const std::vector<std::wstring>& tokenNames, std::wostream &out) {
                         if (s0 == nullptr) {
-                            return L"";
+                            return;
                         }
-                        DFASerializer *serializer = new DFASerializer(this, tokenNames);
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                        return serializer->toString();
+                        DFASerializer serializer(this, tokenNames);
+                        serializer.toString(out);
                     }
 
                     std::wstring DFA::toLexerString() {
+                        std::wstringstream buf;
+                        toLexerString(buf);
+                        return buf.str();
+                    }
+
+                    void DFA::toLexerString(std::wostream &out) {
                         if (s0 == nullptr) {
-                            return L"";
+                            return;
                         }
-                        DFASerializer *serializer = new LexerDFASerializer(this);
-//JAVA TO C++ CONVERTER TODO TASK: There is no native C++ equivalent to 'toString':
-                        return serializer->toString();
+                        LexerDFASerializer serializer(this);
+                        serializer.toString(out);
                     }
                 }
             }
@@ -3,7 +3,10 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_set>
+#include <iostream>
 #include "Declarations.h"
+#include "DFAState.h"
 
 /*
  * [The "BSD license"]
@@ -45,11 +48,13 @@ namespace org {
 
                     class DFA {
                         /// <summary>
-                        /// A set of all DFA states. Use <seealso cref="Map"/> so we can get old state back
-                        ///  (<seealso cref="Set"/> only allows you to see if it's there).
+                        /// A set of all DFA states, hashed and compared by their ATN configurations
+                        ///  so that {@code find} hands back an existing state equal to a new one.
                         /// </summary>
                     public:
-                        std::map<DFAState*, DFAState*> *const states;
+                        typedef std::unordered_set<DFAState*, DFAState::Hasher, DFAState::Comparer> StateSet;
+
+                        StateSet *const states;
                         DFAState *s0;
 
                         const int decision;
@@ -58,6 +63,32 @@ namespace org {
                         /// From which ATN state did we create this DFA? </summary>
                         atn::DecisionState *const atnStartState;
 
+                        /// <summary>
+                        /// For a lexer mode, the table compiled by
+                        ///  <seealso cref="atn.LexerATNSimulator#compileDFATable"/>, or null.
+                        ///  Shared by every lexer using this DFA, like the states. </summary>
+                        LexerDFATable *lexerTable;
+
+                    private:
+                        /// <summary>
+                        /// The number given to the last state added. States can be evicted, so
+                        ///  the size of <seealso cref="#states"/> doesn't make a unique number.
+                        /// </summary>
+                        int lastStateNumber;
+
+                        /// <summary>
+                        /// The bucket of <seealso cref="#states"/> where the next eviction sweep
+                        ///  starts, which is where the last one stopped. </summary>
+                        size_t clockHand;
+
+                        /// <summary>
+                        /// {@code true} if this DFA is for a precedence decision; otherwise,
+                        /// {@code false}. This is the backing field for <seealso cref="#isPrecedenceDfa"/>.
+                        /// </summary>
+                        const bool precedenceDfa;
+
+                    public:
+
 //JAVA TO C++ CONVERTER TODO TASK: Calls to same-class constructors are not supported in C++ prior to C++11:
                         DFA(atn::DecisionState *atnStartState); //this(atnStartState, 0);
 
@@ -68,24 +99,83 @@ namespace org {
                         /// </summary>
                         virtual std::vector<DFAState*> getStates();
 
-                    private:
-#ifdef TODO
-                        class ComparatorAnonymousInnerClassHelper : public Comparator<DFAState*> {
-                        private:
-                            DFA *const outerInstance;
+                        /// <summary>
+                        /// Returns a state number not yet used in this DFA.
+                        /// </summary>
+                        virtual int newStateNumber();
 
-                        public:
-                            ComparatorAnonymousInnerClassHelper(DFA *outerInstance);
+                        /// <summary>
+                        /// Removes up to {@code count} states that prediction hasn't reached
+                        ///  lately and returns them. This is a CLOCK sweep: the hand moves over
+                        ///  the state set from where the previous sweep stopped, and a state
+                        ///  whose <seealso cref="DFAState#referenced"/> flag is set gets a second
+                        ///  chance: the flag is cleared and the state is only taken the next
+                        ///  time the hand comes by. The start state is always kept.
+                        /// <p/>
+                        /// Every edge into a removed state is dropped, and a compacted state
+                        ///  whose origin is removed goes with it since it could not be rebuilt.
+                        ///  Edge maps are replaced rather than changed in place, and their old
+                        ///  tables go to {@code retirer}, so predictions may keep reading the
+                        ///  DFA during the sweep. The removed states are not deleted either;
+                        ///  the caller decides when nothing refers to them any more.
+                        /// <p/>
+                        /// The sweep must not run concurrently with any other update of this
+                        ///  DFA.
+                        /// </summary>
+                        virtual std::vector<DFAState*> evictColdStates(size_t count, DFAEdgeMap::Retirer *retirer = nullptr);
+
+                        /// <summary>
+                        /// Gets whether this DFA is a precedence DFA. Precedence DFAs use a special
+                        /// start state <seealso cref="#s0"/> which is not stored in <seealso cref="#states"/>. The
+                        /// <seealso cref="DFAState#edges"/> map for this start state contains outgoing edges
+                        /// supplying individual start states corresponding to specific precedence
+                        /// values.
+                        /// </summary>
+                        /// <returns> {@code true} if this is a precedence DFA; otherwise,
+                        /// {@code false}. </returns>
+                        /// <seealso cref= Parser#getPrecedence() </seealso>
+                        virtual bool isPrecedenceDfa();
+
+                        /// <summary>
+                        /// Get the start state for a specific precedence value.
+                        /// </summary>
+                        /// <param name="precedence"> The current precedence. </param>
+                        /// <returns> The start state corresponding to the specified precedence, or
+                        /// {@code null} if no start state exists for the specified precedence.
+                        /// </returns>
+                        /// <exception cref="IllegalStateException"> if this is not a precedence DFA. </exception>
+                        /// <seealso cref= #isPrecedenceDfa() </seealso>
+                        virtual DFAState *getPrecedenceStartState(int precedence);
+
+                        /// <summary>
+                        /// Set the start state for a specific precedence value.
+                        /// </summary>
+                        /// <param name="precedence"> The current precedence. </param>
+                        /// <param name="startState"> The start state corresponding to the specified
+                        /// precedence.
+                        /// </param>
+                        /// <param name="retirer"> Takes the replaced edge table of <seealso cref="#s0"/>,
+                        /// see <seealso cref="DFAEdgeMap#set"/>. </param>
+                        /// <exception cref="IllegalStateException"> if this is not a precedence DFA. </exception>
+                        /// <seealso cref= #isPrecedenceDfa() </seealso>
+                        virtual void setPrecedenceStartState(int precedence, DFAState *startState, DFAEdgeMap::Retirer *retirer = nullptr);
 
-                            virtual int compare(DFAState *o1, DFAState *o2);
-                        };
-#endif
-                    public:
                         virtual std::wstring toString();
 
                         virtual std::wstring toString(const std::vector<std::wstring>& tokenNames);
+
+                        /// <summary>
+                        /// Write the DFA edges to out, one line per edge, as they are visited. </summary>
+                        virtual void toString(const std::vector<std::wstring>& tokenNames, std::wostream &out);
+
                         virtual std::wstring toLexerString();
 
+                        virtual void toLexerString(std::wostream &out);
+
+                    private:
+                        static bool isPrecedenceDecision(atn::DecisionState *atnStartState);
+
+                        void initializePrecedenceStartState();
                     };
 
                 }
@@ -0,0 +1,304 @@
+﻿#include "DFAEdgeMap.h"
+
+#include <algorithm>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace dfa {
+
+                    DFAEdgeMap::DFAEdgeMap() : table(nullptr) {
+                    }
+
+                    DFAEdgeMap::~DFAEdgeMap() {
+                        deleteTable(table.load(std::memory_order_relaxed));
+                    }
+
+                    void DFAEdgeMap::set(int symbol, DFAState *target, Retirer *retirer) {
+                        if (symbol < 0) {
+                            return;
+                        }
+
+                        const Table *current = table.load(std::memory_order_relaxed);
+                        Table *next = current != nullptr ? new Table(*current) : new Table();
+                        next->set(symbol, target);
+                        publish(next, retirer);
+                    }
+
+                    bool DFAEdgeMap::empty() const {
+                        const Table *current = table.load(std::memory_order_acquire);
+                        return current == nullptr || current->entries().empty();
+                    }
+
+                    std::vector<std::pair<int, DFAState*>> DFAEdgeMap::entries() const {
+                        const Table *current = table.load(std::memory_order_acquire);
+                        return current != nullptr ? current->entries() : std::vector<std::pair<int, DFAState*>>();
+                    }
+
+                    void DFAEdgeMap::clear(Retirer *retirer) {
+                        if (table.load(std::memory_order_relaxed) != nullptr) {
+                            publish(nullptr, retirer);
+                        }
+                    }
+
+                    void DFAEdgeMap::removeTargets(const std::unordered_set<DFAState*> &states, Retirer *retirer) {
+                        const Table *current = table.load(std::memory_order_relaxed);
+                        if (current == nullptr || !current->leadsTo(states)) {
+                            return;
+                        }
+
+                        Table *next = new Table(*current);
+                        next->removeTargets(states);
+                        publish(next, retirer);
+                    }
+
+                    void DFAEdgeMap::deleteTable(const Table *table) {
+                        delete table;
+                    }
+
+                    void DFAEdgeMap::publish(const Table *next, Retirer *retirer) {
+                        const Table *previous = table.exchange(next, std::memory_order_acq_rel);
+                        if (previous == nullptr) {
+                            return;
+                        }
+                        if (retirer != nullptr) {
+                            retirer->retire(previous);
+                        } else {
+                            deleteTable(previous);
+                        }
+                    }
+
+                    DFAEdgeMap::Table::Table() : kind(INLINE) {
+                        for (int i = 0; i < INLINE_EDGES; i++) {
+                            keys[i] = -1;
+                            targets[i] = nullptr;
+                        }
+                    }
+
+                    void DFAEdgeMap::Table::set(int symbol, DFAState *target) {
+                        switch (kind) {
+                            case INLINE:
+                                for (int i = 0; i < INLINE_EDGES; i++) {
+                                    if (keys[i] == symbol || keys[i] == -1) {
+                                        keys[i] = symbol;
+                                        targets[i] = target;
+                                        return;
+                                    }
+                                }
+                                toRanges();
+                                insertRange(symbol, target);
+                                break;
+
+                            case RANGES:
+                                insertRange(symbol, target);
+                                break;
+
+                            case DENSE:
+                                if (symbol >= (int)dense.size()) {
+                                    dense.resize(symbol + 1, nullptr);
+                                }
+                                dense[symbol] = target;
+                                return;
+                        }
+
+                        if ((int)ranges.size() > DENSE_RANGE_LIMIT) {
+                            toDense();
+                        }
+                    }
+
+                    std::vector<std::pair<int, DFAState*>> DFAEdgeMap::Table::entries() const {
+                        std::vector<std::pair<int, DFAState*>> result;
+                        switch (kind) {
+                            case INLINE:
+                                for (int i = 0; i < INLINE_EDGES && keys[i] != -1; i++) {
+                                    result.push_back(std::make_pair(keys[i], targets[i]));
+                                }
+                                std::sort(result.begin(), result.end(), [](const std::pair<int, DFAState*> &a, const std::pair<int, DFAState*> &b) {
+                                    return a.first < b.first;
+                                });
+                                break;
+
+                            case RANGES:
+                                for (const Range &range : ranges) {
+                                    for (int symbol = range.from; symbol <= range.to; symbol++) {
+                                        result.push_back(std::make_pair(symbol, range.target));
+                                    }
+                                }
+                                break;
+
+                            case DENSE:
+                                for (int symbol = 0; symbol < (int)dense.size(); symbol++) {
+                                    if (dense[symbol] != nullptr) {
+                                        result.push_back(std::make_pair(symbol, dense[symbol]));
+                                    }
+                                }
+                                break;
+                        }
+                        return result;
+                    }
+
+                    bool DFAEdgeMap::Table::leadsTo(const std::unordered_set<DFAState*> &states) const {
+                        switch (kind) {
+                            case INLINE:
+                                for (int i = 0; i < INLINE_EDGES && keys[i] != -1; i++) {
+                                    if (states.count(targets[i]) != 0) {
+                                        return true;
+                                    }
+                                }
+                                return false;
+
+                            case RANGES:
+                                return std::any_of(ranges.begin(), ranges.end(), [&states](const Range &range) {
+                                    return states.count(range.target) != 0;
+                                });
+
+                            default:
+                                return std::any_of(dense.begin(), dense.end(), [&states](DFAState *target) {
+                                    return target != nullptr && states.count(target) != 0;
+                                });
+                        }
+                    }
+
+                    void DFAEdgeMap::Table::removeTargets(const std::unordered_set<DFAState*> &states) {
+                        switch (kind) {
+                            case INLINE: {
+                                int n = 0;
+                                for (int i = 0; i < INLINE_EDGES && keys[i] != -1; i++) {
+                                    if (states.count(targets[i]) == 0) {
+                                        keys[n] = keys[i];
+                                        targets[n] = targets[i];
+                                        n++;
+                                    }
+                                }
+                                for (int i = n; i < INLINE_EDGES; i++) {
+                                    keys[i] = -1;
+                                    targets[i] = nullptr;
+                                }
+                                break;
+                            }
+
+                            case RANGES:
+                                ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [&states](const Range &range) {
+                                    return states.count(range.target) != 0;
+                                }), ranges.end());
+                                break;
+
+                            case DENSE:
+                                for (DFAState *&target : dense) {
+                                    if (target != nullptr && states.count(target) != 0) {
+                                        target = nullptr;
+                                    }
+                                }
+                                break;
+                        }
+                    }
+
+                    DFAState *DFAEdgeMap::Table::findRange(int symbol) const {
+                        // first run that doesn't end before the symbol
+                        std::vector<Range>::const_iterator it = std::lower_bound(ranges.begin(), ranges.end(), symbol, [](const Range &range, int s) {
+                            return range.to < s;
+                        });
+                        if (it != ranges.end() && it->from <= symbol) {
+                            return it->target;
+                        }
+                        return nullptr;
+                    }
+
+                    void DFAEdgeMap::Table::toRanges() {
+                        std::vector<std::pair<int, DFAState*>> edges = entries();
+                        kind = RANGES;
+                        for (const std::pair<int, DFAState*> &edge : edges) {
+                            insertRange(edge.first, edge.second);
+                        }
+                        for (int i = 0; i < INLINE_EDGES; i++) {
+                            keys[i] = -1;
+                            targets[i] = nullptr;
+                        }
+                    }
+
+                    void DFAEdgeMap::Table::toDense() {
+                        std::vector<DFAState*> table(ranges.back().to + 1, nullptr);
+                        for (const Range &range : ranges) {
+                            std::fill(table.begin() + range.from, table.begin() + range.to + 1, range.target);
+                        }
+                        dense.swap(table);
+                        std::vector<Range>().swap(ranges);
+                        kind = DENSE;
+                    }
+
+                    void DFAEdgeMap::Table::insertRange(int symbol, DFAState *target) {
+                        std::vector<Range>::iterator it = std::lower_bound(ranges.begin(), ranges.end(), symbol, [](const Range &range, int s) {
+                            return range.to < s;
+                        });
+                        size_t i = it - ranges.begin();
+
+                        if (it != ranges.end() && it->from <= symbol) {
+                            if (it->target == target) {
+                                return;
+                            }
+
+                            // split the run around the symbol
+                            Range before = { it->from, symbol - 1, it->target };
+                            Range after = { symbol + 1, it->to, it->target };
+                            Range single = { symbol, symbol, target };
+                            ranges.erase(it);
+                            if (after.from <= after.to) {
+                                ranges.insert(ranges.begin() + i, after);
+                            }
+                            ranges.insert(ranges.begin() + i, single);
+                            if (before.from <= before.to) {
+                                ranges.insert(ranges.begin() + i, before);
+                                i++;
+                            }
+                        } else {
+                            Range single = { symbol, symbol, target };
+                            ranges.insert(it, single);
+                        }
+
+                        // join with the neighbouring runs if they continue it
+                        if (i + 1 < ranges.size() && ranges[i + 1].from == ranges[i].to + 1 && ranges[i + 1].target == ranges[i].target) {
+                            ranges[i].to = ranges[i + 1].to;
+                            ranges.erase(ranges.begin() + i + 1);
+                        }
+                        if (i > 0 && ranges[i - 1].to + 1 == ranges[i].from && ranges[i - 1].target == ranges[i].target) {
+                            ranges[i - 1].to = ranges[i].to;
+                            ranges.erase(ranges.begin() + i);
+                        }
+                    }
+
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,217 @@
+﻿#pragma once
+
+#include <atomic>
+#include <vector>
+#include <utility>
+#include <unordered_set>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace dfa {
+
+                    /// <summary>
+                    /// The outgoing edges of a <seealso cref="DFAState"/>, mapping non-negative
+                    /// symbols to target states. Most states have only a few edges, so the
+                    /// storage adapts to the fan-out instead of reserving a slot for every
+                    /// symbol of the vocabulary:
+                    /// <ul>
+                    /// <li>up to <seealso cref="#INLINE_EDGES"/> edges are kept inline and looked up
+                    /// by a short linear scan;</li>
+                    /// <li>beyond that, edges are kept as sorted runs of consecutive symbols
+                    /// with the same target, found by binary search;</li>
+                    /// <li>once there are more than <seealso cref="#DENSE_RANGE_LIMIT"/> runs, the
+                    /// state is wide enough that a dense array indexed by symbol pays for
+                    /// itself.</li>
+                    /// </ul>
+                    /// A map only ever moves down that list. The representation is fixed per
+                    /// state, so the branch taken in <seealso cref="#get"/> is the same every time a
+                    /// given state is visited. Lookups never write, so DFAs shared between
+                    /// parsers are not dirtied on the hot path.
+                    /// <p/>
+                    /// The edges are held in a <seealso cref="Table"/> that is never changed once
+                    /// published: an update copies the current table, changes the copy and
+                    /// swaps it in, so <seealso cref="#get"/> can run on other threads during an
+                    /// update and sees either the old edges or the new ones. Updates must not
+                    /// run concurrently with each other. The replaced table goes to a
+                    /// <seealso cref="Retirer"/>, which keeps it until no lookup can still be
+                    /// reading it.
+                    /// </summary>
+                    class DFAEdgeMap {
+                    public:
+                        static const int INLINE_EDGES = 4;
+                        static const int DENSE_RANGE_LIMIT = 16;
+
+                        /// <summary>
+                        /// Symbols {@code from..to}, inclusive, all lead to {@code target}. </summary>
+                        struct Range {
+                            int from;
+                            int to;
+                            DFAState *target;
+                        };
+
+                        /// <summary>
+                        /// One version of a map's edges. Only a map changes its tables, and
+                        ///  only before publishing them.
+                        /// </summary>
+                        struct Table {
+                            enum Kind {
+                                INLINE,
+                                RANGES,
+                                DENSE
+                            };
+
+                            Kind kind;
+
+                            /// <summary>
+                            /// Unused inline slots have key -1, which no symbol matches. </summary>
+                            int keys[INLINE_EDGES];
+                            DFAState *targets[INLINE_EDGES];
+
+                            std::vector<Range> ranges;
+                            std::vector<DFAState*> dense;
+
+                            Table();
+
+                            DFAState *get(int symbol) const {
+                                switch (kind) {
+                                    case INLINE:
+                                        for (int i = 0; i < INLINE_EDGES; i++) {
+                                            if (keys[i] == symbol) {
+                                                return targets[i];
+                                            }
+                                        }
+                                        return nullptr;
+
+                                    case RANGES:
+                                        return findRange(symbol);
+
+                                    default:
+                                        return symbol < (int)dense.size() ? dense[symbol] : nullptr;
+                                }
+                            }
+
+                            void set(int symbol, DFAState *target);
+
+                            std::vector<std::pair<int, DFAState*>> entries() const;
+
+                            bool leadsTo(const std::unordered_set<DFAState*> &states) const;
+
+                            void removeTargets(const std::unordered_set<DFAState*> &states);
+
+                        private:
+                            DFAState *findRange(int symbol) const;
+
+                            void toRanges();
+
+                            void toDense();
+
+                            void insertRange(int symbol, DFAState *target);
+                        };
+
+                        /// <summary>
+                        /// Takes the tables that updates replace. A lookup on another thread
+                        ///  may still be reading one, so it must be kept until every lookup
+                        ///  that started before the replacement is over; see
+                        ///  <seealso cref="DFAEvictionPolicy"/>. Without a retirer the old table is
+                        ///  deleted at once, which is only safe if no other thread reads the map.
+                        /// </summary>
+                        class Retirer {
+                        public:
+                            virtual ~Retirer() {}
+
+                            virtual void retire(const Table *table) = 0;
+                        };
+
+                    private:
+                        /// <summary>
+                        /// The published edges, or {@code null} while there are none. </summary>
+                        std::atomic<const Table*> table;
+
+                    public:
+                        DFAEdgeMap();
+
+                        ~DFAEdgeMap();
+
+                        DFAEdgeMap(const DFAEdgeMap &) = delete;
+                        DFAEdgeMap &operator=(const DFAEdgeMap &) = delete;
+
+                        /// <summary>
+                        /// Returns the target of the edge on {@code symbol}, or {@code null}
+                        ///  if there is none.
+                        /// </summary>
+                        DFAState *get(int symbol) const {
+                            if (symbol < 0) {
+                                return nullptr;
+                            }
+
+                            const Table *edges = table.load(std::memory_order_acquire);
+                            return edges != nullptr ? edges->get(symbol) : nullptr;
+                        }
+
+                        /// <summary>
+                        /// Adds or replaces the edge on {@code symbol}. Negative symbols are
+                        ///  ignored.
+                        /// </summary>
+                        void set(int symbol, DFAState *target, Retirer *retirer = nullptr);
+
+                        bool empty() const;
+
+                        /// <summary>
+                        /// Returns every edge as a (symbol, target) pair, by ascending symbol.
+                        /// </summary>
+                        std::vector<std::pair<int, DFAState*>> entries() const;
+
+                        void clear(Retirer *retirer = nullptr);
+
+                        /// <summary>
+                        /// Drops every edge that leads to one of {@code states}. The
+                        ///  representation is kept as it is, and nothing is replaced if no
+                        ///  edge leads there.
+                        /// </summary>
+                        void removeTargets(const std::unordered_set<DFAState*> &states, Retirer *retirer = nullptr);
+
+                        static void deleteTable(const Table *table);
+
+                    private:
+                        void publish(const Table *next, Retirer *retirer);
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,250 @@
+﻿#include "DFAEvictionPolicy.h"
+#include "DFA.h"
+#include "DFAState.h"
+#include "ATNConfigSet.h"
+
+#include <algorithm>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace dfa {
+
+                    DFAEvictionPolicy::ReadGuard::ReadGuard(DFAEvictionPolicy *policy) : policy(policy), epoch(0) {
+                        if (policy == nullptr) {
+                            return;
+                        }
+
+                        // if the epoch moved on before we were counted, the advance may not
+                        // have seen us; count again in the new one
+                        for (;;) {
+                            epoch = policy->epoch.load();
+                            policy->readers[epoch & 1].fetch_add(1);
+                            if (policy->epoch.load() == epoch) {
+                                break;
+                            }
+                            policy->readers[epoch & 1].fetch_sub(1);
+                        }
+                    }
+
+                    DFAEvictionPolicy::ReadGuard::~ReadGuard() {
+                        if (policy != nullptr) {
+                            policy->readers[epoch & 1].fetch_sub(1);
+                        }
+                    }
+
+                    DFAEvictionPolicy::DFAEvictionPolicy(size_t maxStates, size_t maxStatesPerDecision, bool deferRelease) : maxStates(maxStates), maxStatesPerDecision(maxStatesPerDecision), deferRelease(deferRelease), stateCount(0), evictedStateCount(0), evictionCount(0), pending(false), epoch(0), retiredStateCount(0) {
+                        readers[0] = 0;
+                        readers[1] = 0;
+                    }
+
+                    DFAEvictionPolicy::~DFAEvictionPolicy() {
+                        for (const Retired &entry : retired) {
+                            freeRetired(entry);
+                        }
+                    }
+
+                    std::unique_lock<std::recursive_mutex> DFAEvictionPolicy::lockUpdates(DFAEvictionPolicy *policy) {
+                        if (policy == nullptr) {
+                            return std::unique_lock<std::recursive_mutex>();
+                        }
+                        return std::unique_lock<std::recursive_mutex>(policy->updateLock);
+                    }
+
+                    void DFAEvictionPolicy::stateAdded(DFA *dfa) {
+                        if (dfas.insert(dfa).second) {
+                            // the DFA may already have had states before this policy saw it
+                            stateCount += dfa->states->size();
+                        } else {
+                            stateCount++;
+                        }
+
+                        if (maxStatesPerDecision > 0 && dfa->states->size() > maxStatesPerDecision && std::find(overQuota.begin(), overQuota.end(), dfa) == overQuota.end()) {
+                            overQuota.push_back(dfa);
+                            pending = true;
+                        }
+                        if (maxStates > 0 && stateCount > maxStates) {
+                            pending = true;
+                        }
+                    }
+
+                    void DFAEvictionPolicy::enforce() {
+                        if (!pending.load()) {
+                            return;
+                        }
+
+                        std::lock_guard<std::recursive_mutex> lock(updateLock);
+                        pending = false;
+
+                        for (DFA *dfa : overQuota) {
+                            size_t size = dfa->states->size();
+                            if (size > maxStatesPerDecision) {
+                                evict(dfa, size - lowWaterMark(maxStatesPerDecision));
+                            }
+                        }
+                        overQuota.clear();
+
+                        if (maxStates > 0 && stateCount > maxStates) {
+                            // take from every DFA in proportion to its size, so that a few
+                            // large decisions give up most of the states
+                            size_t target = stateCount - lowWaterMark(maxStates);
+                            size_t total = stateCount;
+                            for (DFA *dfa : dfas) {
+                                size_t size = dfa->states->size();
+                                size_t share = (size_t)((unsigned long long)size * target / total);
+                                if (share == 0 && size > 0) {
+                                    share = 1;
+                                }
+                                evict(dfa, share);
+                                if (stateCount <= lowWaterMark(maxStates)) {
+                                    break;
+                                }
+                            }
+                        }
+
+                        if (!deferRelease) {
+                            releaseRetired();
+                            // whatever a running prediction still holds is tried again later
+                            if (!retired.empty()) {
+                                pending = true;
+                            }
+                        }
+                    }
+
+                    void DFAEvictionPolicy::releaseEvictedStates() {
+                        std::lock_guard<std::recursive_mutex> lock(updateLock);
+                        releaseRetired();
+                    }
+
+                    void DFAEvictionPolicy::retire(const DFAEdgeMap::Table *table) {
+                        Retired entry = { epoch.load(), nullptr, table, nullptr };
+                        retired.push_back(entry);
+                        pending = true;
+                    }
+
+                    void DFAEvictionPolicy::retire(atn::ATNConfigSet *configs) {
+                        Retired entry = { epoch.load(), nullptr, nullptr, configs };
+                        retired.push_back(entry);
+                        pending = true;
+                    }
+
+                    size_t DFAEvictionPolicy::getStateCount() {
+                        std::lock_guard<std::recursive_mutex> lock(updateLock);
+                        return stateCount;
+                    }
+
+                    size_t DFAEvictionPolicy::getEvictedStateCount() {
+                        std::lock_guard<std::recursive_mutex> lock(updateLock);
+                        return evictedStateCount;
+                    }
+
+                    size_t DFAEvictionPolicy::getEvictionCount() {
+                        std::lock_guard<std::recursive_mutex> lock(updateLock);
+                        return evictionCount;
+                    }
+
+                    size_t DFAEvictionPolicy::getPendingReleaseCount() {
+                        std::lock_guard<std::recursive_mutex> lock(updateLock);
+                        return retiredStateCount;
+                    }
+
+                    size_t DFAEvictionPolicy::evict(DFA *dfa, size_t count) {
+                        std::vector<DFAState*> states = dfa->evictColdStates(count, this);
+                        if (states.empty()) {
+                            return 0;
+                        }
+
+                        uint64_t current = epoch.load();
+                        for (DFAState *state : states) {
+                            Retired entry = { current, state, nullptr, nullptr };
+                            retired.push_back(entry);
+                        }
+                        retiredStateCount += states.size();
+                        stateCount -= std::min(stateCount, states.size());
+                        evictedStateCount += states.size();
+                        evictionCount++;
+                        return states.size();
+                    }
+
+                    bool DFAEvictionPolicy::advanceEpoch() {
+                        uint64_t current = epoch.load();
+                        if (readers[(current - 1) & 1].load() != 0) {
+                            return false;
+                        }
+                        epoch = current + 1;
+                        return true;
+                    }
+
+                    void DFAEvictionPolicy::releaseRetired() {
+                        if (retired.empty()) {
+                            return;
+                        }
+
+                        // two steps, so that with no prediction running everything goes
+                        advanceEpoch();
+                        advanceEpoch();
+                        uint64_t current = epoch.load();
+
+                        size_t n = 0;
+                        while (n < retired.size() && retired[n].epoch + 2 <= current) {
+                            if (retired[n].state != nullptr) {
+                                retiredStateCount--;
+                            }
+                            freeRetired(retired[n]);
+                            n++;
+                        }
+                        retired.erase(retired.begin(), retired.begin() + n);
+                    }
+
+                    void DFAEvictionPolicy::freeRetired(const Retired &entry) {
+                        if (entry.state != nullptr) {
+                            for (DFAState::PredPrediction *prediction : entry.state->predicates) {
+                                delete prediction;
+                            }
+                            delete entry.state->configs;
+                            delete entry.state;
+                        }
+                        DFAEdgeMap::deleteTable(entry.table);
+                        delete entry.configs;
+                    }
+
+                    size_t DFAEvictionPolicy::lowWaterMark(size_t quota) {
+                        return quota - quota / 4;
+                    }
+
+                }
+            }
+        }
+    }
+}
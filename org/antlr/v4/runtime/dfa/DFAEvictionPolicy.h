@@ -0,0 +1,233 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <unordered_set>
+
+#include "Declarations.h"
+#include "DFAEdgeMap.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace dfa {
+
+                    /// <summary>
+                    /// Bounds the number of states kept in the DFAs of a parser, in total
+                    ///  and per decision, by evicting the states prediction hasn't reached
+                    ///  lately. See <seealso cref="DFA#evictColdStates"/>.
+                    /// <p/>
+                    /// A policy is set on a <seealso cref="atn.ParserATNSimulator"/> and should be
+                    ///  shared by every simulator sharing its DFAs. The simulator reports
+                    ///  each state it adds and calls <seealso cref="#enforce"/> once a prediction is
+                    ///  over; a single prediction may therefore go past a quota until it
+                    ///  finishes. When a quota is exceeded, states are evicted down to
+                    ///  three quarters of it so that the sweeps stay rare.
+                    /// <p/>
+                    /// Predictions read the DFAs without locking, so other threads may be
+                    ///  standing on a state while it is evicted. Each prediction therefore
+                    ///  runs inside a <seealso cref="ReadGuard"/> that records the epoch it started
+                    ///  in. Evicted states, and the edge tables and configurations that
+                    ///  updates replace, are retired with the current epoch and deleted
+                    ///  only once every prediction that started before then is over.
+                    ///  Updates themselves (new states, new edges and sweeps) hold the lock
+                    ///  from <seealso cref="#lockUpdates"/> and run one at a time.
+                    /// <p/>
+                    /// Retired memory is freed by <seealso cref="#releaseEvictedStates"/>, which
+                    ///  <seealso cref="#enforce"/> calls unless release is deferred. Defer it when
+                    ///  code outside prediction, such as a DFA dump or profiler, still holds
+                    ///  on to states of these DFAs.
+                    /// </summary>
+                    class DFAEvictionPolicy : public DFAEdgeMap::Retirer {
+                    public:
+                        /// <summary>
+                        /// Marks a prediction on the policy's DFAs for as long as it lives:
+                        ///  nothing the prediction can reach is deleted before the guard is.
+                        ///  A guard for a {@code null} policy does nothing.
+                        /// </summary>
+                        class ReadGuard {
+                        public:
+                            ReadGuard(DFAEvictionPolicy *policy);
+
+                            ~ReadGuard();
+
+                            ReadGuard(const ReadGuard &) = delete;
+                            ReadGuard &operator=(const ReadGuard &) = delete;
+
+                        private:
+                            DFAEvictionPolicy *const policy;
+                            uint64_t epoch;
+                        };
+
+                    protected:
+                        /// <summary>
+                        /// The quotas, in states; 0 for no limit. </summary>
+                        const size_t maxStates;
+                        const size_t maxStatesPerDecision;
+                        const bool deferRelease;
+
+                        size_t stateCount;
+                        size_t evictedStateCount;
+                        size_t evictionCount;
+
+                        /// <summary>
+                        /// Every DFA a state was added to, and those of them that went past
+                        ///  the per-decision quota since the last <seealso cref="#enforce"/>. </summary>
+                        std::unordered_set<DFA*> dfas;
+                        std::vector<DFA*> overQuota;
+
+                        /// <summary>
+                        /// Held by every update of the DFAs and of the fields above. Recursive
+                        ///  so that an update can be built from smaller ones. </summary>
+                        std::recursive_mutex updateLock;
+
+                        /// <summary>
+                        /// Set when a quota is exceeded or something is retired, so that
+                        ///  <seealso cref="#enforce"/> can skip the lock after most predictions. </summary>
+                        std::atomic<bool> pending;
+
+                        /// <summary>
+                        /// The current epoch, and the number of guarded predictions that
+                        ///  started in an even and in an odd epoch. The epoch only advances
+                        ///  once no prediction from the one before it is left, so nothing
+                        ///  retired two epochs ago can still be reached.
+                        /// </summary>
+                        std::atomic<uint64_t> epoch;
+                        std::atomic<size_t> readers[2];
+
+                        /// <summary>
+                        /// Something unlinked from the DFAs during {@code epoch}; exactly one
+                        ///  of the pointers is set. </summary>
+                        struct Retired {
+                            uint64_t epoch;
+                            DFAState *state;
+                            const DFAEdgeMap::Table *table;
+                            atn::ATNConfigSet *configs;
+                        };
+
+                        /// <summary>
+                        /// In the order they were retired, which is also by epoch. </summary>
+                        std::vector<Retired> retired;
+                        size_t retiredStateCount;
+
+                    public:
+                        DFAEvictionPolicy(size_t maxStates, size_t maxStatesPerDecision, bool deferRelease);
+
+                        /// <summary>
+                        /// Deletes everything retired; no prediction may be running. </summary>
+                        virtual ~DFAEvictionPolicy();
+
+                        /// <summary>
+                        /// Takes the lock every update of the policy's DFAs must hold, or
+                        ///  returns an empty lock for a {@code null} policy. </summary>
+                        static std::unique_lock<std::recursive_mutex> lockUpdates(DFAEvictionPolicy *policy);
+
+                        /// <summary>
+                        /// Called by the simulator, holding <seealso cref="#lockUpdates"/>, after
+                        ///  adding a state to {@code dfa}. </summary>
+                        virtual void stateAdded(DFA *dfa);
+
+                        /// <summary>
+                        /// Evicts states from every DFA over its quota, then from all DFAs if
+                        ///  there are more states than the total quota allows. Call it outside
+                        ///  any <seealso cref="ReadGuard"/>, or what the caller could still reach
+                        ///  is kept back.
+                        /// </summary>
+                        virtual void enforce();
+
+                        /// <summary>
+                        /// Deletes what was retired and can no longer be reached by any
+                        ///  guarded prediction.
+                        /// </summary>
+                        virtual void releaseEvictedStates();
+
+                        /// <summary>
+                        /// Keeps an edge table replaced under <seealso cref="#lockUpdates"/> until no
+                        ///  prediction can be reading it. </summary>
+                        virtual void retire(const DFAEdgeMap::Table *table) override;
+
+                        /// <summary>
+                        /// Keeps the configurations dropped from a state under
+                        ///  <seealso cref="#lockUpdates"/> until no prediction can be reading them;
+                        ///  see <seealso cref="atn.ParserATNSimulator#compactDFAState"/>. </summary>
+                        virtual void retire(atn::ATNConfigSet *configs);
+
+                        /// <summary>
+                        /// The number of states in the DFAs this policy has seen states added
+                        ///  to. </summary>
+                        virtual size_t getStateCount();
+
+                        /// <summary>
+                        /// The number of states evicted so far. </summary>
+                        virtual size_t getEvictedStateCount();
+
+                        /// <summary>
+                        /// The number of sweeps that evicted at least one state. </summary>
+                        virtual size_t getEvictionCount();
+
+                        /// <summary>
+                        /// The number of evicted states not deleted yet. </summary>
+                        virtual size_t getPendingReleaseCount();
+
+                    protected:
+                        /// <summary>
+                        /// Evicts up to {@code count} states from {@code dfa}. Returns the
+                        ///  number evicted, which may be more than asked for when compacted
+                        ///  states go along with their origin.
+                        /// </summary>
+                        virtual size_t evict(DFA *dfa, size_t count);
+
+                        /// <summary>
+                        /// Moves to the next epoch if no prediction from the previous one is
+                        ///  left. </summary>
+                        bool advanceEpoch();
+
+                        /// <summary>
+                        /// Deletes what was retired at least two epochs ago, after trying to
+                        ///  advance the epoch that far. Call it holding {@code updateLock}. </summary>
+                        void releaseRetired();
+
+                        void freeRetired(const Retired &entry);
+
+                        static size_t lowWaterMark(size_t quota);
+                    };
+
+                }
+            }
+        }
+    }
+}
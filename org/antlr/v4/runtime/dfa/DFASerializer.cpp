@@ -3,6 +3,7 @@
 #include "StringBuilder.h"
 #include "DFAState.h"
 #include <limits.h>
+#include <sstream>
 
 
 /*
@@ -46,30 +47,24 @@ namespace org {
                     }
 
                     std::wstring DFASerializer::toString() {
+                        std::wstringstream buf;
+                        toString(buf);
+                        return buf.str();
+                    }
+
+                    void DFASerializer::toString(std::wostream &out) {
                         if (dfa->s0 == nullptr) {
-                            return L"";
+                            return;
                         }
-                        StringBuilder *buf = new StringBuilder();
                         std::vector<DFAState*> states = dfa->getStates();
                         for (auto s : states) {
-                            int n = 0;
-                            n = (int)s->edges.size();
-                            for (int i = 0; i < n; i++) {
-                                DFAState *t = s->edges[i];
+                            for (const std::pair<int, DFAState*> &edge : s->edges.entries()) {
+                                DFAState *t = edge.second;
                                 if (t != nullptr && t->stateNumber != INT16_MAX) {
-                                    buf->append(getStateString(s));
-                                    std::wstring label = getEdgeLabel(i);
-                                    buf->append(L"-"); buf->append(label); buf->append(L"->"); buf->append(getStateString(t)); buf->append(L"\n");
+                                    out << getStateString(s) << L"-" << getEdgeLabel(edge.first) << L"->" << getStateString(t) << L"\n";
                                 }
                             }
                         }
-
-                        std::wstring output = buf->toString();
-                        if (output.length() == 0) {
-                            return L"";
-                        }
-                        //return Utils.sortLinesInString(output);
-                        return output;
                     }
 
                     std::wstring DFASerializer::getEdgeLabel(int i) {
@@ -2,6 +2,7 @@
 
 #include <string>
 #include <vector>
+#include <iostream>
 #include "stringconverter.h"
 
 #include "Declarations.h"
@@ -52,6 +53,12 @@ namespace org {
 
                         virtual std::wstring toString();
 
+                        /// <summary>
+                        /// Write each edge to out as it is visited rather than building the
+                        ///  whole listing in memory.
+                        /// </summary>
+                        virtual void toString(std::wostream &out);
+
                     protected:
                         virtual std::wstring getEdgeLabel(int i);
 
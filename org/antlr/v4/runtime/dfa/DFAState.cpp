@@ -54,18 +54,17 @@ namespace org {
                         alt = 0;
                     }
 
-                    DFAState::DFAState() {
+                    DFAState::DFAState() : configs(new atn::ATNConfigSet()) {
                         InitializeInstanceFields();
                     }
 
-                    DFAState::DFAState(int stateNumber) {
+                    DFAState::DFAState(int stateNumber) : configs(new atn::ATNConfigSet()) {
                         InitializeInstanceFields();
                         this->stateNumber = stateNumber;
                     }
 
-                    DFAState::DFAState(atn::ATNConfigSet *configs) {
+                    DFAState::DFAState(atn::ATNConfigSet *configs) : configs(configs) {
                         InitializeInstanceFields();
-                        this->configs = configs;
                     }
 
                     std::set<int> *DFAState::getAltSet() {
@@ -81,9 +80,13 @@ namespace org {
                         return alts;
                     }
 
+                    bool DFAState::isCompacted() {
+                        return configs == nullptr;
+                    }
+
                     int DFAState::hashCode() {
                         int hash = misc::MurmurHash::initialize(7);
-                        hash = misc::MurmurHash::update(hash, configs->hashCode());
+                        hash = misc::MurmurHash::update(hash, configs != nullptr ? configs->hashCode() : configsHash);
                         hash = misc::MurmurHash::finish(hash, 1);
                         return hash;
                     }
@@ -99,7 +102,19 @@ namespace org {
                         }
 
                         DFAState *other = static_cast<DFAState*>(o);
-                        // TODO (sam): what to do when configs==null?
+                        if (this->isCompacted() || other->isCompacted()) {
+                            if (this->hashCode() != other->hashCode() || this->isAcceptState != other->isAcceptState || this->requiresFullContext != other->requiresFullContext || this->prediction != other->prediction || this->predicates.size() != other->predicates.size()) {
+                                return false;
+                            }
+                            for (std::vector<PredPrediction*>::size_type i = 0; i < predicates.size(); i++) {
+                                // semantic contexts are interned
+                                if (this->predicates[i]->pred != other->predicates[i]->pred || this->predicates[i]->alt != other->predicates[i]->alt) {
+                                    return false;
+                                }
+                            }
+                            return true;
+                        }
+
                         bool sameSet = this->configs->equals(other->configs);
                                         //		System.out.println("DFAState.equals: "+configs+(sameSet?"==":"!=")+other.configs);
                         return sameSet;
@@ -107,7 +122,7 @@ namespace org {
 
                     std::wstring DFAState::toString() {
                         StringBuilder *buf = new StringBuilder();
-                        buf->append(std::to_wstring(stateNumber)); buf->append(L":"); buf->append(configs->toString());
+                        buf->append(std::to_wstring(stateNumber)); buf->append(L":"); buf->append(configs != nullptr ? configs->toString() : L"{...}");
                         if (isAcceptState) {
                             buf->append(L"=>");
                             if (predicates.size() != 0) {
@@ -125,12 +140,16 @@ namespace org {
 
                     void DFAState::InitializeInstanceFields() {
                         stateNumber = -1;
-                        configs = new org::antlr::v4::runtime::atn::ATNConfigSet();
                         isAcceptState = false;
                         prediction = 0;
                         lexerRuleIndex = -1;
                         lexerActionIndex = -1;
+                        lexerActionExecutor = nullptr;
                         requiresFullContext = false;
+                        configsHash = 0;
+                        origin = nullptr;
+                        originSymbol = 0;
+                        referenced = false;
                     }
                 }
             }
@@ -1,10 +1,12 @@
 ﻿#pragma once
 
+#include <atomic>
 #include <string>
 #include <set>
 #include <vector>
 
 #include "Declarations.h"
+#include "DFAEdgeMap.h"
 
 /*
  * [The "BSD license"]
@@ -73,6 +75,7 @@ namespace org {
                             atn::SemanticContext *pred; // never null; at least SemanticContext.NONE
                             int alt;
                             PredPrediction(atn::SemanticContext *pred, int alt);
+                            virtual ~PredPrediction() {}
                             virtual std::wstring toString();
 
                         private:
@@ -85,12 +88,10 @@ namespace org {
                         atn::ATNConfigSet *configs;
 
                         /// <summary>
-                        /// {@code edges[symbol]} points to target of symbol. Shift up by 1 so (-1)
-                        ///  <seealso cref="Token#EOF"/> maps to {@code edges[0]}.
+                        /// {@code edges.get(symbol)} points to target of symbol. Shift up by 1 so (-1)
+                        ///  <seealso cref="Token#EOF"/> maps to {@code edges.get(0)}.
                         /// </summary>
-//JAVA TO C++ CONVERTER WARNING: Since the array size is not known in this declaration, Java to C++ Converter has converted this array to a pointer.  You will need to call 'delete[]' where appropriate:
-//ORIGINAL LINE: @Nullable public DFAState[] edges;
-                        std::vector<DFAState*> edges;
+                        DFAEdgeMap edges;
 
                         bool isAcceptState;
 
@@ -104,6 +105,12 @@ namespace org {
                         int lexerRuleIndex; // if accept, exec action in what rule?
                         int lexerActionIndex; // if accept, exec what action?
 
+                        /// <summary>
+                        /// If accept, the commands registered for {@code lexerActionIndex}, or
+                        ///  {@code null} if there are none and the action runs as embedded code.
+                        /// </summary>
+                        atn::LexerActionExecutor *lexerActionExecutor;
+
                         /// <summary>
                         /// Indicates that this state was created during SLL prediction that
                         /// discovered a conflict between the configurations in the state. Future
@@ -129,6 +136,27 @@ namespace org {
 //ORIGINAL LINE: @Nullable public PredPrediction[] predicates;
                         std::vector<PredPrediction *> predicates;
 
+                        /// <summary>
+                        /// Hash of <seealso cref="#configs"/>, kept when a lean DFA compacts this state
+                        ///  and drops the set. See <seealso cref="ParserATNSimulator#compactDFAState"/>.
+                        /// </summary>
+                        int configsHash;
+
+                        /// <summary>
+                        /// The state and symbol this state was first reached from, so that the
+                        ///  configurations of a compacted state can be computed again. The
+                        ///  origin is {@code null} for start states.
+                        /// </summary>
+                        DFAState *origin;
+                        int originSymbol;
+
+                        /// <summary>
+                        /// Set whenever prediction reaches this state, and cleared by an
+                        ///  eviction sweep that spares it. See <seealso cref="DFA#evictColdStates"/>.
+                        ///  Predictions on other threads set it while a sweep runs.
+                        /// </summary>
+                        std::atomic<bool> referenced;
+
                         /// <summary>
                         /// Map a predicate to a predicted alternative. </summary>
                         DFAState();
@@ -137,12 +165,19 @@ namespace org {
 
                         DFAState(atn::ATNConfigSet *configs);
 
+                        virtual ~DFAState() {}
+
                         /// <summary>
                         /// Get the set of all alts mentioned by all ATN configurations in this
                         ///  DFA state.
                         /// </summary>
                         virtual std::set<int> *getAltSet();
 
+                        /// <summary>
+                        /// Returns {@code true} if <seealso cref="#configs"/> was dropped by a lean DFA.
+                        /// </summary>
+                        virtual bool isCompacted();
+
                         virtual int hashCode() ;
 
                         /// <summary>
@@ -157,11 +192,31 @@ namespace org {
                         /// <seealso cref="ParserATNSimulator#addDFAState"/> we need to know if any other state
                         /// exists that has this exact set of ATN configurations. The
                         /// <seealso cref="#stateNumber"/> is irrelevant.
+                        /// <p/>
+                        /// A compacted state no longer has its configurations. It is equal to
+                        /// another state with the same configuration hash that predicts the same
+                        /// way, which is all the DFA simulation can tell apart.
                         /// </summary>
                         virtual bool equals(void *o);
 
                         virtual std::wstring toString();
 
+                        /// <summary>
+                        /// Hashes and compares states the way <seealso cref="#hashCode"/> and
+                        ///  <seealso cref="#equals"/> do, for keeping them in unordered containers.
+                        /// </summary>
+                        struct Hasher {
+                            size_t operator()(DFAState *state) const {
+                                return (size_t)state->hashCode();
+                            }
+                        };
+
+                        struct Comparer {
+                            bool operator()(DFAState *a, DFAState *b) const {
+                                return a->equals(b);
+                            }
+                        };
+
                     private:
                         void InitializeInstanceFields();
                     };
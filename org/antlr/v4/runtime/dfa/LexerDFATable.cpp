@@ -0,0 +1,225 @@
+﻿#include "LexerDFATable.h"
+#include "ATN.h"
+#include "ATNState.h"
+#include "Transition.h"
+#include "IntervalSet.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LEXER_DFA_TABLE_SSE2 1
+#endif
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace dfa {
+
+                    const int LexerDFATable::ERROR_ROW;
+                    const int LexerDFATable::FALLBACK_ROW;
+                    const int LexerDFATable::MAX_CHAR;
+                    const int LexerDFATable::DENSE_CLASS_LIMIT;
+                    const size_t LexerDFATable::DEFAULT_MAX_STATES;
+                    const int LexerDFATable::MAX_LOOP_RANGES;
+
+                    static void addBoundary(std::vector<int> &bounds, int c) {
+                        if (c > 0 && c <= LexerDFATable::MAX_CHAR) {
+                            bounds.push_back(c);
+                        }
+                    }
+
+                    LexerDFATable::LexerDFATable(atn::ATN *atn) {
+                        // every symbol interval [a, b] on a transition starts a class at a
+                        // and another one at b + 1; wildcards match everything alike
+                        std::vector<int> bounds;
+                        bounds.push_back(0);
+                        for (atn::ATNState *state : atn->states) {
+                            if (state == nullptr) {
+                                continue;
+                            }
+                            for (atn::Transition *t : state->transitions) {
+                                if (t->epsilon || t->serializationType == atn::Transition::WILDCARD) {
+                                    continue;
+                                }
+                                misc::IntervalSet *label = t->label();
+                                if (label == nullptr) {
+                                    continue;
+                                }
+                                for (const misc::Interval &I : label->getIntervals()) {
+                                    addBoundary(bounds, I.a);
+                                    if (I.b < MAX_CHAR) {
+                                        addBoundary(bounds, I.b + 1);
+                                    }
+                                }
+                            }
+                        }
+                        std::sort(bounds.begin(), bounds.end());
+                        bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+                        lower = bounds;
+
+                        denseClass.resize(DENSE_CLASS_LIMIT);
+                        int cls = 0;
+                        for (int c = 0; c < DENSE_CLASS_LIMIT; c++) {
+                            while (cls + 1 < (int)lower.size() && lower[cls + 1] <= c) {
+                                cls++;
+                            }
+                            denseClass[c] = cls;
+                        }
+                    }
+
+                    int LexerDFATable::addRow(DFAState *state) {
+                        rows.push_back(state);
+                        transitions.resize(transitions.size() + lower.size(), FALLBACK_ROW);
+                        return (int)rows.size() - 1;
+                    }
+
+                    void LexerDFATable::computeLoops() {
+                        size_t nclasses = lower.size();
+                        loops.assign(rows.size(), Loop());
+                        for (size_t row = 0; row < rows.size(); row++) {
+                            Loop &loop = loops[row];
+                            loop.nranges = 0;
+                            loop.wide = false;
+                            loop.newlines = false;
+                            const int *entries = &transitions[row * nclasses];
+                            for (size_t cls = 0; cls < nclasses; cls++) {
+                                if (entries[cls] != (int)row) {
+                                    continue;
+                                }
+                                int from = lower[cls];
+                                int to = cls + 1 < nclasses ? lower[cls + 1] - 1 : MAX_CHAR;
+                                if (loop.nranges > 0 && loop.to[loop.nranges - 1] == from - 1) {
+                                    loop.to[loop.nranges - 1] = to; // adjacent classes
+                                    continue;
+                                }
+                                if (loop.nranges == MAX_LOOP_RANGES) {
+                                    loop.wide = true;
+                                    break;
+                                }
+                                loop.from[loop.nranges] = from;
+                                loop.to[loop.nranges] = to;
+                                loop.nranges++;
+                            }
+                            if (loop.wide) {
+                                loop.nranges = 0;
+                                loop.newlines = next((int)row, L'\n') == (int)row;
+                            } else {
+                                loop.newlines = loop.contains(L'\n');
+                            }
+                        }
+                    }
+
+#ifdef LEXER_DFA_TABLE_SSE2
+                    /// <summary>
+                    /// Lanes of {@code c} that fall in one of the first N ranges; c is in
+                    ///  [from, to] iff from - 1 < c < to + 1, and characters are at most
+                    ///  MAX_CHAR so the signed 32-bit compares can't overflow.
+                    /// </summary>
+                    template<int N>
+                    static inline __m128i inRanges(__m128i c, const __m128i *below, const __m128i *above) {
+                        __m128i in = _mm_and_si128(_mm_cmpgt_epi32(c, below[0]), _mm_cmplt_epi32(c, above[0]));
+                        for (int k = 1; k < N; k++) {
+                            in = _mm_or_si128(in, _mm_and_si128(_mm_cmpgt_epi32(c, below[k]), _mm_cmplt_epi32(c, above[k])));
+                        }
+                        return in;
+                    }
+
+                    template<int N>
+                    static size_t scanRanges(const LexerDFATable::Loop &loop, const wchar_t *s, size_t n) {
+                        __m128i below[N];
+                        __m128i above[N];
+                        for (int k = 0; k < N; k++) {
+                            below[k] = _mm_set1_epi32(loop.from[k] - 1);
+                            above[k] = _mm_set1_epi32(loop.to[k] + 1);
+                        }
+
+                        size_t i = 0;
+                        for (; i + 8 <= n; i += 8) {
+                            __m128i lo = inRanges<N>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), below, above);
+                            __m128i hi = inRanges<N>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 4)), below, above);
+                            int mask = _mm_movemask_ps(_mm_castsi128_ps(lo)) | (_mm_movemask_ps(_mm_castsi128_ps(hi)) << 4);
+                            if (mask != 0xFF) {
+                                while (mask & 1) {
+                                    mask >>= 1;
+                                    i++;
+                                }
+                                return i;
+                            }
+                        }
+                        while (i < n && loop.contains(s[i])) {
+                            i++;
+                        }
+                        return i;
+                    }
+#endif
+
+                    size_t LexerDFATable::scanLoop(int row, const wchar_t *s, size_t n) const {
+                        const Loop &loop = loops[row];
+                        if (loop.wide) {
+                            const int *entries = &transitions[(size_t)row * lower.size()];
+                            size_t i = 0;
+                            for (; i < n; i++) {
+                                int c = (int)s[i];
+                                if (!inAlphabet(c) || entries[classOf(c)] != row) {
+                                    break;
+                                }
+                            }
+                            return i;
+                        }
+#ifdef LEXER_DFA_TABLE_SSE2
+                        if (sizeof(wchar_t) == 4) {
+                            switch (loop.nranges) {
+                                case 1:
+                                    return scanRanges<1>(loop, s, n);
+                                case 2:
+                                    return scanRanges<2>(loop, s, n);
+                                case 3:
+                                    return scanRanges<3>(loop, s, n);
+                                case 4:
+                                    return scanRanges<4>(loop, s, n);
+                            }
+                        }
+#endif
+                        size_t i = 0;
+                        while (i < n && loop.contains(s[i])) {
+                            i++;
+                        }
+                        return i;
+                    }
+
+                }
+            }
+        }
+    }
+}
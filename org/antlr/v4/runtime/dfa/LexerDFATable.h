@@ -0,0 +1,197 @@
+﻿#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace dfa {
+
+                    /// <summary>
+                    /// A lexer mode's DFA, determinized ahead of time into a flat transition
+                    /// table, see <seealso cref="atn.LexerATNSimulator#compileDFATable"/>.
+                    /// <p/>
+                    /// The input alphabet is compressed into equivalence classes: two characters
+                    /// share a class when no transition of the ATN tells them apart, so a row
+                    /// holds one entry per class instead of one per character. Classes of the
+                    /// first <seealso cref="#DENSE_CLASS_LIMIT"/> characters are looked up
+                    /// directly; above that, by binary search over the class boundaries.
+                    /// <p/>
+                    /// Each row stands for a <seealso cref="DFAState"/> of the mode's
+                    /// <seealso cref="DFA"/>. An entry is the row of the target state,
+                    /// <seealso cref="#ERROR_ROW"/> if no token can continue with that class, or
+                    /// <seealso cref="#FALLBACK_ROW"/> if the target depends on a semantic
+                    /// predicate and must be computed by the ATN simulator at match time.
+                    /// </summary>
+                    class LexerDFATable {
+                    public:
+                        static const int ERROR_ROW = -1;
+                        static const int FALLBACK_ROW = -2;
+
+                        /// <summary>
+                        /// Characters above this are outside the table's alphabet. </summary>
+                        static const int MAX_CHAR = 0x10FFFF;
+
+                        static const int DENSE_CLASS_LIMIT = 256;
+
+                        static const size_t DEFAULT_MAX_STATES = 4096;
+                        /// <summary>
+                        /// Rows whose self-loop needs more character ranges than this are
+                        ///  scanned a character at a time through the class table instead of
+                        ///  with range compares, see <seealso cref="#scanLoop"/>. </summary>
+                        static const int MAX_LOOP_RANGES = 4;
+
+                        /// <summary>
+                        /// The characters on which a row goes back to itself, as a few
+                        ///  ranges. {@code nranges} is 0 for rows without a self-loop and for
+                        ///  {@code wide} rows, whose loop needs more than MAX_LOOP_RANGES.
+                        /// </summary>
+                        struct Loop {
+                            int nranges;
+                            int from[MAX_LOOP_RANGES];
+                            int to[MAX_LOOP_RANGES];
+                            bool wide;
+                            bool newlines;
+
+                            bool contains(int c) const {
+                                for (int i = 0; i < nranges; i++) {
+                                    if (c >= from[i] && c <= to[i]) {
+                                        return true;
+                                    }
+                                }
+                                return false;
+                            }
+                        };
+
+                    private:
+                        /// <summary>
+                        /// Sorted lower bounds of the character classes; class i covers
+                        ///  lower[i]..lower[i + 1] - 1. lower[0] is always 0.
+                        /// </summary>
+                        std::vector<int> lower;
+                        std::vector<int> denseClass;
+                        std::vector<int> transitions;
+                        std::vector<DFAState*> rows;
+                        std::vector<Loop> loops;
+
+                    public:
+                        /// <summary>
+                        /// Creates an empty table whose alphabet classes are computed from the
+                        ///  symbols on all transitions of {@code atn}.
+                        /// </summary>
+                        LexerDFATable(atn::ATN *atn);
+
+                        int getNumberOfClasses() const {
+                            return (int)lower.size();
+                        }
+
+                        int getNumberOfRows() const {
+                            return (int)rows.size();
+                        }
+
+                        /// <summary>
+                        /// The smallest character of class {@code cls}. </summary>
+                        int representative(int cls) const {
+                            return lower[cls];
+                        }
+
+                        /// <summary>
+                        /// The class of {@code c}, which must be in 0..<seealso cref="#MAX_CHAR"/>. </summary>
+                        int classOf(int c) const {
+                            if (c < DENSE_CLASS_LIMIT) {
+                                return denseClass[c];
+                            }
+                            return (int)(std::upper_bound(lower.begin(), lower.end(), c) - lower.begin()) - 1;
+                        }
+
+                        static bool inAlphabet(int c) {
+                            return c >= 0 && c <= MAX_CHAR;
+                        }
+
+                        /// <summary>
+                        /// The row reached from {@code row} on {@code c}, or one of
+                        ///  <seealso cref="#ERROR_ROW"/> and <seealso cref="#FALLBACK_ROW"/>.
+                        /// </summary>
+                        int next(int row, int c) const {
+                            return transitions[(size_t)row * lower.size() + classOf(c)];
+                        }
+
+                        DFAState *stateAt(int row) const {
+                            return rows[row];
+                        }
+
+                        /// <summary>
+                        /// Appends a row for {@code state} with every entry set to
+                        ///  <seealso cref="#FALLBACK_ROW"/> and returns its index.
+                        /// </summary>
+                        int addRow(DFAState *state);
+
+                        void setNext(int row, int cls, int target) {
+                            transitions[(size_t)row * lower.size() + cls] = target;
+                        }
+
+                        /// <summary>
+                        /// Finds the self-loops of all rows. Call once all entries are set.
+                        /// </summary>
+                        void computeLoops();
+
+                        bool hasLoop(int row) const {
+                            return loops[row].nranges != 0 || loops[row].wide;
+                        }
+
+                        /// <summary>
+                        /// Whether the self-loop of {@code row} can consume a newline, i.e.
+                        ///  whether a scanned run needs line counting. </summary>
+                        bool loopHasNewlines(int row) const {
+                            return loops[row].newlines;
+                        }
+
+                        /// <summary>
+                        /// The length of the longest prefix of {@code s[0..n)} on which
+                        ///  {@code row} loops back to itself. Uses SIMD compares where available,
+                        ///  and the class table for wide loops.
+                        /// </summary>
+                        size_t scanLoop(int row, const wchar_t *s, size_t n) const;
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -38,94 +38,98 @@ namespace org {
                 namespace misc {
 
                     /// <summary>
-                    /// An immutable inclusive interval a..b </summary>
+                    /// An inclusive interval a..b.  This is a plain 8-byte value type:
+                    ///  pass it by value and compare with ==; there is no sharing or pooling.
+                    /// </summary>
                     class Interval {
                     public:
-                        static const int INTERVAL_POOL_MAX_VALUE = 1000;
-
-                        static Interval *const INVALID;
-
-                        static Interval *cache[INTERVAL_POOL_MAX_VALUE+1];
+                        static const Interval INVALID;
 
                         int a;
                         int b;
 
-                        static int creates;
-                        static int misses;
-                        static int hits;
-                        static int outOfRange;
+                        Interval() : a(0), b(0) {
+                        }
 
-                        Interval(int a, int b);
+                        Interval(int a, int b) : a(a), b(b) {
+                        }
 
                         /// <summary>
-                        /// Interval objects are used readonly so share all with the
-                        ///  same single value a==b up to some max size.  Use an array as a perfect hash.
-                        ///  Return shared object for 0..INTERVAL_POOL_MAX_VALUE or a new
-                        ///  Interval object with a..a in it.  On Java.g4, 218623 IntervalSets
-                        ///  have a..a (set with 1 element).
+                        /// Kept for source compatibility with the Java runtime; equivalent to
+                        ///  Interval(a, b).
                         /// </summary>
-                        static Interval *of(int a, int b);
+                        static Interval of(int a, int b) {
+                            return Interval(a, b);
+                        }
 
                         /// <summary>
                         /// return number of elements between a and b inclusively. x..x is length 1.
                         ///  if b < a, then length is 0.  9..10 has length 2.
                         /// </summary>
-                        virtual int length();
+                        int length() const;
+
+                        bool equals(Interval other) const {
+                            return a == other.a && b == other.b;
+                        }
 
-                        virtual bool equals(void *o);
+                        bool operator == (Interval other) const {
+                            return equals(other);
+                        }
 
-                        virtual int hashCode();
+                        bool operator != (Interval other) const {
+                            return !equals(other);
+                        }
+
+                        int hashCode() const;
 
                         /// <summary>
                         /// Does this start completely before other? Disjoint </summary>
-                        virtual bool startsBeforeDisjoint(Interval *other);
+                        bool startsBeforeDisjoint(Interval other) const;
 
                         /// <summary>
                         /// Does this start at or before other? Nondisjoint </summary>
-                        virtual bool startsBeforeNonDisjoint(Interval *other);
+                        bool startsBeforeNonDisjoint(Interval other) const;
 
                         /// <summary>
                         /// Does this.a start after other.b? May or may not be disjoint </summary>
-                        virtual bool startsAfter(Interval *other);
+                        bool startsAfter(Interval other) const;
 
                         /// <summary>
                         /// Does this start completely after other? Disjoint </summary>
-                        virtual bool startsAfterDisjoint(Interval *other);
+                        bool startsAfterDisjoint(Interval other) const;
 
                         /// <summary>
                         /// Does this start after other? NonDisjoint </summary>
-                        virtual bool startsAfterNonDisjoint(Interval *other);
+                        bool startsAfterNonDisjoint(Interval other) const;
 
                         /// <summary>
                         /// Are both ranges disjoint? I.e., no overlap? </summary>
-                        virtual bool disjoint(Interval *other);
+                        bool disjoint(Interval other) const;
 
                         /// <summary>
                         /// Are two intervals adjacent such as 0..41 and 42..42? </summary>
-                        virtual bool adjacent(Interval *other);
+                        bool adjacent(Interval other) const;
 
-                        virtual bool properlyContains(Interval *other);
+                        bool properlyContains(Interval other) const;
 
                         /// <summary>
                         /// Return the interval computed from combining this and other </summary>
-                        virtual Interval *union_Renamed(Interval *other);
+                        Interval union_Renamed(Interval other) const;
 
                         /// <summary>
                         /// Return the interval in common between this and o </summary>
-                        virtual Interval *intersection(Interval *other);
+                        Interval intersection(Interval other) const;
 
                         /// <summary>
                         /// Return the interval with elements from this not in other;
                         ///  other must not be totally enclosed (properly contained)
                         ///  within this, which would result in two disjoint intervals
                         ///  instead of the single one returned by this method.
+                        ///  Returns INVALID if other does not overlap the start or end of this.
                         /// </summary>
-                        virtual Interval *differenceNotProperlyContained(Interval *other);
-
-                        virtual std::wstring toString();
+                        Interval differenceNotProperlyContained(Interval other) const;
 
-                    private:
-                        void InitializeInstanceFields();
+                        std::wstring toString() const;
                     };
 
                 }
@@ -2,11 +2,12 @@
 #include "Token.h"
 #include "MurmurHash.h"
 #include "Exceptions.h"
-#include "interval.h"
+#include "Interval.h"
 #include "Lexer.h"
 #include "StringBuilder.h"
 
 #include <algorithm>
+#include <cstdarg>
 #include <vector>
 
 /*
@@ -48,12 +49,15 @@ namespace org {
                     IntervalSet *const IntervalSet::COMPLETE_CHAR_SET = IntervalSet::of(0, runtime::Lexer::MAX_CHAR_VALUE);
                     IntervalSet *const IntervalSet::EMPTY_SET = new IntervalSet(0);
 
-                    IntervalSet::IntervalSet(std::vector<Interval*> &intervals) {
+                    IntervalSet::IntervalSet(const std::vector<Interval> &intervals) {
                         InitializeInstanceFields();
-                        this->intervals = intervals;
+                        for (auto &I : intervals) {
+                            add(I);
+                        }
                     }
 
                     IntervalSet::IntervalSet(IntervalSet *set) {
+                        InitializeInstanceFields();
                         addAll(set);
                     }
 
@@ -65,6 +69,7 @@ namespace org {
                         for (int i = 0; i < n; i++) {
                             add(va_arg(vlist, int));
                         }
+                        va_end(vlist);
                     }
 
                     org::antlr::v4::runtime::misc::IntervalSet *IntervalSet::of(int a) {
@@ -73,7 +78,8 @@ namespace org {
                     }
 
                     org::antlr::v4::runtime::misc::IntervalSet *IntervalSet::of(int a, int b) {
-                        IntervalSet *s = new IntervalSet(2, a, b);
+                        IntervalSet *s = new IntervalSet(0);
+                        s->add(a, b);
                         return s;
                     }
 
@@ -82,71 +88,74 @@ namespace org {
                             throw new IllegalStateException(L"can't alter readonly IntervalSet");
                         }
                         intervals.clear();
+                        bitmap.clear();
                     }
 
                     void IntervalSet::add(int el) {
                         if (readonly) {
                             throw new IllegalStateException(L"can't alter readonly IntervalSet");
                         }
-                        add(1,el);
+                        add(el, el);
                     }
 
                     void IntervalSet::add(int a, int b) {
-                        add(Interval::of(a, b));
+                        add(Interval(a, b));
                     }
 
-                    void IntervalSet::add(Interval *addition) {
+                    void IntervalSet::add(const Interval &addition) {
                         if (readonly) {
                             throw new IllegalStateException(L"can't alter readonly IntervalSet");
                         }
-                        //System.out.println("add "+addition+" to "+intervals.toString());
-                        if (addition->b < addition->a) {
+                        if (addition.b < addition.a) {
                             return;
                         }
-                        // find position in list
-                        // Use iterators as we modify list in place
-//                        for (std::vector<Interval*>::const_iterator iter = intervals.begin(); iter != intervals.end(); ++iter) {
-                        for (std::vector<Interval*>::iterator iter = intervals.begin(); iter != intervals.end(); ++iter) {
-                            Interval *r = *iter;
-                            if (addition->equals(r)) {
-                                return;
-                            }
-                            if (addition->adjacent(r) || !addition->disjoint(r)) {
-                                // next to each other, make a single larger interval
-                                Interval *bigger = addition->union_Renamed(r);
-//                                (*iter)->set(bigger);
-                                (*iter) = bigger;
-                                // make sure we didn't just create an interval that
-                                // should be merged with next interval in list
-                                
-                                
-                                while ( iter++ != intervals.end()) {
-                                    Interval *next = *iter;
-                                    if (!bigger->adjacent(next) && bigger->disjoint(next)) {
-                                        break;
-                                    }
+                        setBits(addition.a, addition.b, true);
 
-                                    // if we bump up against or overlap next, merge
-                                    intervals.erase(iter);// remove this one
-                                    iter--; // move backwards to what we just set
-                                    r = *iter;
-                                    
-                                    intervals.insert(iter, bigger->union_Renamed(next));//(*iter)->set(bigger->union_Renamed(next)); // set to 3 merged ones
-                                    //*iter; // first call to next after previous duplicates the result
-                                }
-                                return;
+                        // find the first interval that ends at or after addition.a-1; anything
+                        // before it is disjoint and not adjacent, so it is left alone
+                        std::vector<Interval>::iterator iter = std::lower_bound(intervals.begin(), intervals.end(), addition,
+                            [](const Interval &r, const Interval &x) { return (long long)r.b + 1 < x.a; });
+                        if (iter == intervals.end() || (long long)addition.b + 1 < iter->a) {
+                            // disjoint from everything; insert in sorted position
+                            intervals.insert(iter, addition);
+                            return;
+                        }
+
+                        // overlapping or adjacent: grow *iter and swallow any following
+                        // intervals that the bigger one now bumps up against
+                        Interval bigger(std::min(addition.a, iter->a), std::max(addition.b, iter->b));
+                        std::vector<Interval>::iterator next = iter + 1;
+                        while (next != intervals.end() && (long long)next->a <= (long long)bigger.b + 1) {
+                            bigger.b = std::max(bigger.b, next->b);
+                            ++next;
+                        }
+                        *iter = bigger;
+                        intervals.erase(iter + 1, next);
+                    }
+
+                    void IntervalSet::setBits(int a, int b, bool value) {
+                        if (b < 0 || a >= BITMAP_LIMIT) {
+                            return;
+                        }
+                        a = std::max(a, 0);
+                        b = std::min(b, BITMAP_LIMIT - 1);
+                        if (value) {
+                            size_t words = (static_cast<size_t>(b) >> 6) + 1;
+                            if (words > bitmap.size()) {
+                                bitmap.resize(words, 0);
                             }
-                            if (addition->startsBeforeDisjoint(r)) {
-                                // insert before r
-                                iter--; //(*iter)->previous();
-                                intervals.insert(iter, addition);//(*iter)->add(addition);
-                                return;
+                        } else {
+                            // bits past the end are already clear
+                            b = std::min(b, static_cast<int>(bitmap.size() * 64) - 1);
+                        }
+                        for (int v = a; v <= b; v++) {
+                            uint64_t mask = uint64_t(1) << (v & 63);
+                            if (value) {
+                                bitmap[v >> 6] |= mask;
+                            } else {
+                                bitmap[v >> 6] &= ~mask;
                             }
-                            // if disjoint and after r, a future iteration will handle it
                         }
-                        // ok, must be after last interval (and disjoint from last interval)
-                        // just add it
-                        intervals.push_back(addition);
                     }
 
                     IntervalSet *IntervalSet::Or(std::vector<IntervalSet*> sets) {
@@ -166,10 +175,8 @@ namespace org {
                         }
                         IntervalSet *other = static_cast<IntervalSet*>(set);
                         // walk set and add each interval
-                        int n = (int)other->intervals.size();
-                        for (int i = 0; i < n; i++) {
-                            Interval *I = other->intervals[i];
-                            this->add(I->a,I->b);
+                        for (auto &I : other->intervals) {
+                            this->add(I);
                         }
                         return this;
                     }
@@ -193,24 +200,24 @@ namespace org {
                         if (n == 0) {
                             return compliment;
                         }
-                        Interval *first = intervals[0];
+                        const Interval &first = intervals[0];
                         // add a range from 0 to first.a constrained to vocab
-                        if (first->a > 0) {
-                            IntervalSet *s = IntervalSet::of(0, first->a - 1);
+                        if (first.a > 0) {
+                            IntervalSet *s = IntervalSet::of(0, first.a - 1);
                             IntervalSet *a = s->And(vocabularyIS);
                             compliment->addAll(a);
                         }
                         for (int i = 1; i < n; i++) { // from 2nd interval .. nth
-                            Interval *previous = intervals[i - 1];
-                            Interval *current = intervals[i];
-                            IntervalSet *s = IntervalSet::of(previous->b + 1, current->a - 1);
+                            const Interval &previous = intervals[i - 1];
+                            const Interval &current = intervals[i];
+                            IntervalSet *s = IntervalSet::of(previous.b + 1, current.a - 1);
                             IntervalSet *a = s->And(vocabularyIS);
                             compliment->addAll(a);
                         }
-                        Interval *last = intervals[n - 1];
+                        const Interval &last = intervals[n - 1];
                         // add a range from last.b to maxElement constrained to vocab
-                        if (last->b < maxElement) {
-                            IntervalSet *s = IntervalSet::of(last->b + 1, maxElement);
+                        if (last.b < maxElement) {
+                            IntervalSet *s = IntervalSet::of(last.b + 1, maxElement);
                             IntervalSet *a = s->And(vocabularyIS);
                             compliment->addAll(a);
                         }
@@ -239,56 +246,33 @@ namespace org {
                             return nullptr; // nothing in common with null set
                         }
 
-                        std::vector<Interval*> myIntervals = this->intervals;
-                        std::vector<Interval*> theirIntervals = (static_cast<IntervalSet*>(other))->intervals;
+                        const std::vector<Interval> &myIntervals = this->intervals;
+                        const std::vector<Interval> &theirIntervals = (static_cast<IntervalSet*>(other))->intervals;
                         IntervalSet *intersection = nullptr;
-                        int mySize = myIntervals.size();
-                        int theirSize = theirIntervals.size();
-                        int i = 0;
-                        int j = 0;
-                        // iterate down both interval lists looking for nondisjoint intervals
+                        size_t mySize = myIntervals.size();
+                        size_t theirSize = theirIntervals.size();
+                        size_t i = 0;
+                        size_t j = 0;
+                        // iterate down both interval lists looking for nondisjoint intervals;
+                        // the overlap of two sorted disjoint lists is itself sorted and
+                        // disjoint, so each piece can simply be appended
                         while (i < mySize && j < theirSize) {
-                            Interval *mine = myIntervals[i];
-                            Interval *theirs = theirIntervals[j];
-                            //System.out.println("mine="+mine+" and theirs="+theirs);
-                            if (mine->startsBeforeDisjoint(theirs)) {
-                                // move this iterator looking for interval that might overlap
-                                i++;
-                            } else if (theirs->startsBeforeDisjoint(mine)) {
-                                // move other iterator looking for interval that might overlap
-                                j++;
-                            } else if (mine->properlyContains(theirs)) {
-                                // overlap, add intersection, get next theirs
-                                if (intersection == nullptr) {
-                                    intersection = new IntervalSet(0);
-                                }
-                                intersection->add(mine->intersection(theirs));
-                                j++;
-                            } else if (theirs->properlyContains(mine)) {
-                                // overlap, add intersection, get next mine
+                            const Interval &mine = myIntervals[i];
+                            const Interval &theirs = theirIntervals[j];
+                            int a = std::max(mine.a, theirs.a);
+                            int b = std::min(mine.b, theirs.b);
+                            if (a <= b) {
                                 if (intersection == nullptr) {
                                     intersection = new IntervalSet(0);
                                 }
-                                intersection->add(mine->intersection(theirs));
+                                intersection->add(a, b);
+                            }
+                            // advance whichever range ends first; the other may still
+                            // overlap the next range in the opposite list
+                            if (mine.b < theirs.b) {
                                 i++;
-                            } else if (!mine->disjoint(theirs)) {
-                                // overlap, add intersection
-                                if (intersection == nullptr) {
-                                    intersection = new IntervalSet(0);
-                                }
-                                intersection->add(mine->intersection(theirs));
-                                // Move the iterator of lower range [a..b], but not
-                                // the upper range as it may contain elements that will collide
-                                // with the next iterator. So, if mine=[0..115] and
-                                // theirs=[115..200], then intersection is 115 and move mine
-                                // but not theirs as theirs may collide with the next range
-                                // in thisIter.
-                                // move both iterators to next ranges
-                                if (mine->startsAfterNonDisjoint(theirs)) {
-                                    j++;
-                                } else if (theirs->startsAfterNonDisjoint(mine)) {
-                                    i++;
-                                }
+                            } else {
+                                j++;
                             }
                         }
                         if (intersection == nullptr) {
@@ -298,31 +282,18 @@ namespace org {
                     }
 
                     bool IntervalSet::contains(int el) {
-                        int n = intervals.size();
-                        for (int i = 0; i < n; i++) {
-                            Interval *I = intervals[i];
-                            int a = I->a;
-                            int b = I->b;
-                            if (el < a) {
-                                break; // list is sorted and el is before this interval; not here
-                            }
-                            if (el >= a && el <= b) {
-                                return true; // found in this interval
-                            }
+                        if (static_cast<unsigned>(el) < static_cast<unsigned>(BITMAP_LIMIT)) {
+                            size_t word = static_cast<size_t>(el) >> 6;
+                            return word < bitmap.size() && ((bitmap[word] >> (el & 63)) & 1) != 0;
+                        }
+                        // binary search for the last interval starting at or before el
+                        std::vector<Interval>::const_iterator iter = std::upper_bound(intervals.begin(), intervals.end(), el,
+                            [](int v, const Interval &I) { return v < I.a; });
+                        if (iter == intervals.begin()) {
+                            return false;
                         }
-                        return false;
-                                        /*
-                                        		for (ListIterator iter = intervals.listIterator(); iter.hasNext();) {
-                                                    Interval I = (Interval) iter.next();
-                                                    if ( el<I.a ) {
-                                                        break; // list is sorted and el is before this interval; not here
-                                                    }
-                                                    if ( el>=I.a && el<=I.b ) {
-                                                        return true; // found in this interval
-                                                    }
-                                                }
-                                                return false;
-                                                */
+                        --iter;
+                        return el <= iter->b;
                     }
 
                     bool IntervalSet::isNil() {
@@ -330,10 +301,10 @@ namespace org {
                     }
 
                     int IntervalSet::getSingleElement() {
-                        if (intervals.size() > 0 && intervals.size() == 1) {
-                            Interval *I = intervals[0];
-                            if (I->a == I->b) {
-                                return I->a;
+                        if (intervals.size() == 1) {
+                            const Interval &I = intervals[0];
+                            if (I.a == I.b) {
+                                return I.a;
                             }
                         }
                         return Token::INVALID_TYPE;
@@ -343,37 +314,30 @@ namespace org {
                         if (isNil()) {
                             return Token::INVALID_TYPE;
                         }
-                        Interval *last = intervals[intervals.size() - 1];
-                        return last->b;
+                        return intervals.back().b;
                     }
 
                     int IntervalSet::getMinElement() {
                         if (isNil()) {
                             return Token::INVALID_TYPE;
                         }
-                        int n = intervals.size();
-                        for (int i = 0; i < n; i++) {
-                            Interval *I = intervals[i];
-                            int a = I->a;
-                            int b = I->b;
-                            for (int v = a; v <= b; v++) {
-                                if (v >= 0) {
-                                    return v;
-                                }
+                        for (auto &I : intervals) {
+                            if (I.b >= 0) {
+                                return std::max(I.a, 0);
                             }
                         }
                         return Token::INVALID_TYPE;
                     }
 
-                    std::vector<Interval*> IntervalSet::getIntervals() {
+                    const std::vector<Interval> &IntervalSet::getIntervals() {
                         return intervals;
                     }
 
                     int IntervalSet::hashCode() {
                         int hash = MurmurHash::initialize();
-                        for (auto I : intervals) {
-                            hash = MurmurHash::update(hash, I->a);
-                            hash = MurmurHash::update(hash, I->b);
+                        for (auto &I : intervals) {
+                            hash = MurmurHash::update(hash, I.a);
+                            hash = MurmurHash::update(hash, I.b);
                         }
 
                         hash = MurmurHash::finish(hash, intervals.size() * 2);
@@ -385,7 +349,9 @@ namespace org {
                             return false;
                         }
                         IntervalSet *other = static_cast<IntervalSet*>(obj);
-                        return std::equal(this->intervals.begin(), this->intervals.end(), other->intervals.begin());
+                        return this->intervals.size() == other->intervals.size() &&
+                            std::equal(this->intervals.begin(), this->intervals.end(), other->intervals.begin(),
+                                       [](const Interval &x, const Interval &y) { return x.a == y.a && x.b == y.b; });
                     }
 
                     std::wstring IntervalSet::toString() {
@@ -400,11 +366,10 @@ namespace org {
                         if (this->size() > 1) {
                             buf->append(L"{");
                         }
-                        std::vector<Interval*>::const_iterator iter = this->intervals.begin();
+                        std::vector<Interval>::const_iterator iter = this->intervals.begin();
                         while (iter != this->intervals.end()) {
-                            Interval *I = *iter;
-                            int a = I->a;
-                            int b = I->b;
+                            int a = iter->a;
+                            int b = iter->b;
                             if (a == b) {
                                 if (a == -1) {
                                     buf->append(L"<EOF>");
@@ -439,11 +404,10 @@ namespace org {
                         if (this->size() > 1) {
                             buf->append(L"{");
                         }
-                        std::vector<Interval*>::const_iterator iter = this->intervals.begin();
+                        std::vector<Interval>::const_iterator iter = this->intervals.begin();
                         while (iter != this->intervals.end()) {
-                            Interval *I = *iter;
-                            int a = I->a;
-                            int b = I->b;
+                            int a = iter->a;
+                            int b = iter->b;
                             if (a == b) {
                                 buf->append(elementName(tokenNames, a));
                             } else {
@@ -473,11 +437,10 @@ namespace org {
                         if (this->size() > 1) {
                             buf->append(L"{");
                         }
-                        std::vector<Interval*>::const_iterator iter = this->intervals.begin();
+                        std::vector<Interval>::const_iterator iter = this->intervals.begin();
                         while (iter != this->intervals.end()) {
-                            Interval *I = *iter;
-                            int a = I->a;
-                            int b = I->b;
+                            int a = iter->a;
+                            int b = iter->b;
                             if (a == b) {
                                 buf->append(elementName(tokenNames, a));
                             } else {
@@ -525,24 +488,19 @@ namespace org {
                         int n = 0;
                         int numIntervals = intervals.size();
                         if (numIntervals == 1) {
-                            Interval *firstInterval = this->intervals[0];
-                            return firstInterval->b - firstInterval->a + 1;
+                            const Interval &firstInterval = this->intervals[0];
+                            return firstInterval.b - firstInterval.a + 1;
                         }
-                        for (int i = 0; i < numIntervals; i++) {
-                            Interval *I = intervals[i];
-                            n += (I->b - I->a + 1);
+                        for (auto &I : intervals) {
+                            n += (I.b - I.a + 1);
                         }
                         return n;
                     }
 
                     std::vector<int> IntervalSet::toList() {
                         std::vector<int> values = std::vector<int>();
-                        int n = intervals.size();
-                        for (int i = 0; i < n; i++) {
-                            Interval *I = intervals[i];
-                            int a = I->a;
-                            int b = I->b;
-                            for (int v = a; v <= b; v++) {
+                        for (auto &I : intervals) {
+                            for (int v = I.a; v <= I.b; v++) {
                                 values.push_back(v);
                             }
                         }
@@ -551,10 +509,8 @@ namespace org {
 
                     std::set<int> *IntervalSet::toSet() {
                         std::set<int> *s = new std::set<int>();
-                        for (auto I : intervals) {
-                            int a = I->a;
-                            int b = I->b;
-                            for (int v = a; v <= b; v++) {
+                        for (auto &I : intervals) {
+                            for (int v = I.a; v <= I.b; v++) {
                                 s->insert(v);
                             }
                         }
@@ -562,13 +518,9 @@ namespace org {
                     }
 
                     int IntervalSet::get(int i) {
-                        int n = intervals.size();
                         int index = 0;
-                        for (int j = 0; j < n; j++) {
-                            Interval *I = intervals[j];
-                            int a = I->a;
-                            int b = I->b;
-                            for (int v = a; v <= b; v++) {
+                        for (auto &I : intervals) {
+                            for (int v = I.a; v <= I.b; v++) {
                                 if (index == i) {
                                     return v;
                                 }
@@ -582,35 +534,34 @@ namespace org {
                         if (readonly) {
                             throw IllegalStateException(L"can't alter readonly IntervalSet");
                         }
-                        int n = intervals.size();
-                        for (int i = 0; i < n; i++) {
-                            Interval *I = intervals[i];
-                            int a = I->a;
-                            int b = I->b;
-                            if (el < a) {
-                                break; // list is sorted and el is before this interval; not here
-                            }
-                            // if whole interval x..x, rm
-                            if (el == a && el == b) {
-                                intervals.erase(intervals.begin() + i);
-                                break;
-                            }
-                            // if on left edge x..b, adjust left
-                            if (el == a) {
-                                I->a++;
-                                break;
-                            }
-                            // if on right edge a..x, adjust right
-                            if (el == b) {
-                                I->b--;
-                                break;
-                            }
-                            // if in middle a..x..b, split interval
-                            if (el > a && el < b) { // found in this interval
-                                int oldb = I->b;
-                                I->b = el - 1; // [a..x-1]
-                                add(el + 1, oldb); // add [x+1..b]
-                            }
+                        std::vector<Interval>::iterator iter = std::upper_bound(intervals.begin(), intervals.end(), el,
+                            [](int v, const Interval &I) { return v < I.a; });
+                        if (iter == intervals.begin()) {
+                            return; // list is sorted and el is before every interval; not here
+                        }
+                        --iter;
+                        Interval &I = *iter;
+                        if (el > I.b) {
+                            return;
+                        }
+                        setBits(el, el, false);
+                        // if whole interval x..x, rm
+                        if (el == I.a && el == I.b) {
+                            intervals.erase(iter);
+                        }
+                        // if on left edge x..b, adjust left
+                        else if (el == I.a) {
+                            I.a++;
+                        }
+                        // if on right edge a..x, adjust right
+                        else if (el == I.b) {
+                            I.b--;
+                        }
+                        // if in middle a..x..b, split interval into [a..x-1] and [x+1..b]
+                        else {
+                            int oldb = I.b;
+                            I.b = el - 1;
+                            intervals.insert(iter + 1, Interval(el + 1, oldb));
                         }
                     }
 
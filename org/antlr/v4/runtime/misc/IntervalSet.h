@@ -1,12 +1,14 @@
 ﻿#pragma once
 
 #include "IntSet.h"
+#include "Interval.h"
 #include "vectorhelper.h"
 #include "Declarations.h"
 
 #include <string>
 #include <vector>
 #include <set>
+#include <cstdint>
 
 
 /*
@@ -66,15 +68,29 @@ namespace org {
                         static IntervalSet *const COMPLETE_CHAR_SET;
                         static IntervalSet *const EMPTY_SET;
 
+                        /// <summary>
+                        /// Elements 0..BITMAP_LIMIT-1 are mirrored in a dense bitmap so that
+                        ///  membership tests for ASCII chars and ordinary token vocabularies
+                        ///  are a single word lookup.  Anything outside that range falls back
+                        ///  to a binary search over the interval list.
+                        /// </summary>
+                        static const int BITMAP_LIMIT = 1024;
+
                         /// <summary>
                         /// The list of sorted, disjoint intervals. </summary>
                     protected:
-                        std::vector<Interval*> intervals;
+                        std::vector<Interval> intervals;
+
+                        /// <summary>
+                        /// One bit per element in 0..BITMAP_LIMIT-1; only grown as far as the
+                        ///  largest such element, so words past the end are implicitly zero.
+                        /// </summary>
+                        std::vector<uint64_t> bitmap;
 
                         bool readonly;
 
                     public:
-                        IntervalSet(std::vector<Interval*> &intervals);
+                        IntervalSet(const std::vector<Interval> &intervals);
 
 //JAVA TO C++ CONVERTER TODO TASK: Calls to same-class constructors are not supported in C++ prior to C++11:
                         IntervalSet(IntervalSet *set); //this();
@@ -107,9 +123,8 @@ namespace org {
                         /// </summary>
                         virtual void add(int a, int b);
 
-                        // copy on write so we can cache a..a intervals and sets of that
                     protected:
-                        virtual void add(Interval *addition);
+                        virtual void add(const Interval &addition);
 
                         /// <summary>
                         /// combine all sets in the array returned the or'd value </summary>
@@ -166,8 +181,8 @@ namespace org {
                         virtual int getMinElement();
 
                         /// <summary>
-                        /// Return a list of Interval objects. </summary>
-                        virtual std::vector<Interval*> getIntervals();
+                        /// Return the sorted list of Interval values. </summary>
+                        virtual const std::vector<Interval> &getIntervals();
 
                         virtual int hashCode();
 
@@ -215,6 +230,8 @@ namespace org {
                         virtual void setReadonly(bool readonly);
 
                     private:
+                        void setBits(int a, int b, bool value);
+
                         void InitializeInstanceFields();
                     };
 
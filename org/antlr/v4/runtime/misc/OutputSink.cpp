@@ -0,0 +1,162 @@
+﻿#include "OutputSink.h"
+#include "Exceptions.h"
+
+#include <codecvt>
+#include <locale>
+#include <cerrno>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace misc {
+
+                    // Where wchar_t is 16 bits wide the text is UTF-16, and codecvt_utf8
+                    // would encode each half of a surrogate pair on its own.
+                    typedef std::conditional<sizeof(wchar_t) == 2, std::codecvt_utf8_utf16<wchar_t>, std::codecvt_utf8<wchar_t>>::type Utf8Codecvt;
+
+                    static bool isHighSurrogate(wchar_t c) {
+                        return sizeof(wchar_t) == 2 && c >= 0xD800 && c <= 0xDBFF;
+                    }
+
+                    OutputSink::OutputSink(Callback callback, size_t bufferSize) : callback(callback), buffer(bufferSize > 0 ? bufferSize : 1) {
+                        setp(buffer.data(), buffer.data() + buffer.size());
+                    }
+
+                    OutputSink::~OutputSink() {
+                        try {
+                            flushBuffer();
+                        } catch (...) {
+                            // an exception must not escape a destructor
+                        }
+                    }
+
+                    void OutputSink::flush() {
+                        flushBuffer();
+                    }
+
+                    OutputSink::int_type OutputSink::overflow(int_type c) {
+                        flushBuffer(false);
+                        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+                            *pptr() = traits_type::to_char_type(c);
+                            pbump(1);
+                        }
+                        return traits_type::not_eof(c);
+                    }
+
+                    std::streamsize OutputSink::xsputn(const wchar_t *s, std::streamsize n) {
+                        std::streamsize written = 0;
+                        while (written < n) {
+                            std::streamsize room = epptr() - pptr();
+                            if (room == 0) {
+                                flushBuffer(false);
+                                room = epptr() - pptr();
+                            }
+                            std::streamsize chunk = std::min(room, n - written);
+                            traits_type::copy(pptr(), s + written, (size_t)chunk);
+                            pbump((int)chunk);
+                            written += chunk;
+                        }
+                        return written;
+                    }
+
+                    int OutputSink::sync() {
+                        flushBuffer();
+                        return 0;
+                    }
+
+                    void OutputSink::flushBuffer(bool complete) {
+                        size_t length = pptr() - pbase();
+                        size_t held = 0;
+                        if (!complete && length > 1 && isHighSurrogate(pbase()[length - 1])) {
+                            // keep a pair that straddles the buffer boundary in one chunk
+                            held = 1;
+                        }
+                        if (length > held) {
+                            callback(pbase(), length - held);
+                        }
+                        wchar_t last = held > 0 ? pbase()[length - 1] : 0;
+                        setp(buffer.data(), buffer.data() + buffer.size());
+                        if (held > 0) {
+                            *pptr() = last;
+                            pbump(1);
+                        }
+                    }
+
+                    static std::string toUtf8(const wchar_t *data, size_t length) {
+                        std::wstring_convert<Utf8Codecvt, wchar_t> converter;
+                        return converter.to_bytes(data, data + length);
+                    }
+
+                    OutputSink::Callback OutputSink::utf8(std::ostream &out) {
+                        return [&out](const wchar_t *data, size_t length) {
+                            std::string bytes = toUtf8(data, length);
+                            out.write(bytes.data(), (std::streamsize)bytes.size());
+                        };
+                    }
+
+                    OutputSink::Callback OutputSink::utf8(int fd) {
+                        return [fd](const wchar_t *data, size_t length) {
+                            std::string bytes = toUtf8(data, length);
+                            const char *p = bytes.data();
+                            size_t remaining = bytes.size();
+                            while (remaining > 0) {
+#ifdef _WIN32
+                                int n = _write(fd, p, (unsigned int)remaining);
+#else
+                                ssize_t n = ::write(fd, p, remaining);
+#endif
+                                if (n < 0) {
+                                    if (errno == EINTR) {
+                                        continue;
+                                    }
+                                    throw IOException(L"write to output file descriptor failed");
+                                }
+                                p += n;
+                                remaining -= (size_t)n;
+                            }
+                        };
+                    }
+
+                }
+            }
+        }
+    }
+}
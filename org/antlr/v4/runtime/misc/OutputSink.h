@@ -0,0 +1,111 @@
+﻿#pragma once
+
+#include <functional>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace misc {
+
+                    /// <summary>
+                    /// A wide stream buffer that collects text in a fixed-size buffer and
+                    ///  hands each full buffer to a callback.  Wrap it in a std::wostream and
+                    ///  pass that to the toString/getText overloads that take a stream, and
+                    ///  large outputs are written out as they are produced instead of being
+                    ///  materialized in a single std::wstring.
+                    /// 
+                    ///   misc::OutputSink sink(misc::OutputSink::utf8(fd));
+                    ///   std::wostream out(&sink);
+                    ///   tree::Trees::toStringTree(tree, ruleNames, out);
+                    /// 
+                    ///  Pending text is flushed on std::flush/sync, by <seealso cref="#flush"/> and
+                    ///  when the sink is destroyed.  The destructor cannot report a failed
+                    ///  write, so call flush() first where write errors matter.
+                    /// </summary>
+                    class OutputSink : public std::wstreambuf {
+                    public:
+                        typedef std::function<void(const wchar_t *data, size_t length)> Callback;
+
+                        static const size_t DEFAULT_BUFFER_SIZE = 4096;
+
+                        OutputSink(Callback callback, size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+                        /// <summary>
+                        /// Discards any text still pending if its write fails; see <seealso cref="#flush"/>. </summary>
+                        virtual ~OutputSink();
+
+                        /// <summary>
+                        /// Hands any pending text to the callback.  Whatever the callback
+                        ///  throws, such as the IOException from <seealso cref="#utf8(int)"/>,
+                        ///  propagates to the caller.
+                        /// </summary>
+                        virtual void flush();
+
+                        /// <summary>
+                        /// A callback that encodes each chunk as UTF-8 and writes it to out. </summary>
+                        static Callback utf8(std::ostream &out);
+
+                        /// <summary>
+                        /// A callback that encodes each chunk as UTF-8 and writes it to the
+                        ///  file descriptor fd, retrying short writes.  Write errors are
+                        ///  reported by throwing IOException.
+                        /// </summary>
+                        static Callback utf8(int fd);
+
+                    protected:
+                        virtual int_type overflow(int_type c) override;
+
+                        virtual std::streamsize xsputn(const wchar_t *s, std::streamsize n) override;
+
+                        virtual int sync() override;
+
+                    private:
+                        Callback callback;
+                        std::vector<wchar_t> buffer;
+
+                        /// <summary>
+                        /// Hands the buffer to the callback.  Unless complete, a trailing high
+                        ///  surrogate is kept back so the pair is encoded together. </summary>
+                        void flushBuffer(bool complete = true);
+                    };
+
+                }
+            }
+        }
+    }
+}
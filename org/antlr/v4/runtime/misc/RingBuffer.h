@@ -0,0 +1,195 @@
+﻿#pragma once
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace misc {
+
+                    /// <summary>
+                    /// A bounded single-producer, single-consumer queue. Pushing and popping
+                    ///  are lock-free; only a thread that finds the buffer full (producer) or
+                    ///  empty (consumer) and has spun for a while goes to sleep on a
+                    ///  condition variable, to be woken by the other side.
+                    /// <p/>
+                    /// Either side may <seealso cref="#close"/> the buffer: a closed buffer accepts
+                    ///  no more items, and <seealso cref="#pop"/> fails once it is drained.
+                    /// </summary>
+                    template<typename T>
+                    class RingBuffer {
+                    private:
+                        static const int SPIN_LIMIT = 128;
+
+                        std::vector<T> slots;
+                        const size_t mask;
+
+                        /// <summary>
+                        /// Next slot to pop; only the consumer writes it. The consumer also keeps
+                        ///  the last value of tail it saw, so it only reads the producer's line
+                        ///  when it seems to have run out. </summary>
+                        alignas(64) std::atomic<size_t> head;
+                        size_t knownTail;
+
+                        /// <summary>
+                        /// Next slot to push; only the producer writes it. </summary>
+                        alignas(64) std::atomic<size_t> tail;
+                        size_t knownHead;
+
+                        alignas(64) std::atomic<bool> closed;
+                        std::atomic<int> sleepers;
+                        std::mutex mutex;
+                        std::condition_variable wakeup;
+
+                        static size_t roundUp(size_t capacity) {
+                            size_t size = 2;
+                            while (size < capacity) {
+                                size <<= 1;
+                            }
+                            return size;
+                        }
+
+                        template<typename Ready>
+                        void await(Ready ready) {
+                            for (int i = 0; i < SPIN_LIMIT; i++) {
+                                if (ready()) {
+                                    return;
+                                }
+                            }
+
+                            std::unique_lock<std::mutex> lock(mutex);
+                            sleepers++;
+                            wakeup.wait(lock, ready);
+                            sleepers--;
+                        }
+
+                        void notify() {
+                            if (sleepers.load() > 0) {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                wakeup.notify_all();
+                            }
+                        }
+
+                    public:
+                        /// <summary>
+                        /// Creates a buffer for at least {@code capacity} items. </summary>
+                        RingBuffer(size_t capacity) : slots(roundUp(capacity)), mask(roundUp(capacity) - 1), head(0), knownTail(0), tail(0), knownHead(0), closed(false), sleepers(0) {
+                        }
+
+                        size_t capacity() const {
+                            return slots.size();
+                        }
+
+                        bool tryPush(const T &item) {
+                            size_t t = tail.load(std::memory_order_relaxed);
+                            if (t - knownHead == slots.size()) {
+                                knownHead = head.load(std::memory_order_acquire);
+                                if (t - knownHead == slots.size()) {
+                                    return false;
+                                }
+                            }
+                            if (closed.load(std::memory_order_relaxed)) {
+                                return false;
+                            }
+                            slots[t & mask] = item;
+                            tail.store(t + 1);
+                            notify();
+                            return true;
+                        }
+
+                        bool tryPop(T &item) {
+                            size_t h = head.load(std::memory_order_relaxed);
+                            if (knownTail == h) {
+                                knownTail = tail.load(std::memory_order_acquire);
+                                if (knownTail == h) {
+                                    return false;
+                                }
+                            }
+                            item = slots[h & mask];
+                            head.store(h + 1);
+                            notify();
+                            return true;
+                        }
+
+                        /// <summary>
+                        /// Adds {@code item}, waiting while the buffer is full. Returns
+                        ///  {@code false} if the buffer was closed. </summary>
+                        bool push(const T &item) {
+                            while (!tryPush(item)) {
+                                if (closed.load()) {
+                                    return false;
+                                }
+                                await([this] {
+                                    return closed.load() || tail.load() - head.load() < slots.size();
+                                });
+                            }
+                            return true;
+                        }
+
+                        /// <summary>
+                        /// Removes the oldest item into {@code item}, waiting while the buffer
+                        ///  is empty. Returns {@code false} if the buffer is closed and empty.
+                        /// </summary>
+                        bool pop(T &item) {
+                            while (!tryPop(item)) {
+                                if (closed.load() && tail.load() == head.load()) {
+                                    return false;
+                                }
+                                await([this] {
+                                    return closed.load() || tail.load() != head.load();
+                                });
+                            }
+                            return true;
+                        }
+
+                        void close() {
+                            closed.store(true);
+                            std::lock_guard<std::mutex> lock(mutex);
+                            wakeup.notify_all();
+                        }
+
+                        bool isClosed() const {
+                            return closed.load();
+                        }
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -58,7 +58,7 @@ namespace org {
                     std::wstring toStringTree(Parser *parser);
                     
                     // From SyntaxTree
-                    misc::Interval *getSourceInterval();
+                    misc::Interval getSourceInterval();
                     
                     // From Tree
                     //Tree *getParent();
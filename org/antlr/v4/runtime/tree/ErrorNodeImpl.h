@@ -76,7 +76,7 @@ namespace org {
                         
                         // From SyntaxTree
                     public:
-                        misc::Interval *getSourceInterval() override;
+                        misc::Interval getSourceInterval() override;
                         
                         // From Tree
                     public:
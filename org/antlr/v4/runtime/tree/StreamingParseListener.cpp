@@ -0,0 +1,102 @@
+﻿#include "StreamingParseListener.h"
+#include "ParserRuleContext.h"
+#include "ParseTree.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace tree {
+
+                    StreamingParseListener::StreamingParseListener(RecordCallback callback, int recordDepth) : callback(callback), recordDepth(recordDepth) {
+                    }
+
+                    StreamingParseListener::~StreamingParseListener() {
+                        releasePending();
+                    }
+
+                    void StreamingParseListener::visitTerminal(TerminalNode *node) {
+                        releasePending();
+                    }
+
+                    void StreamingParseListener::visitErrorNode(ErrorNode *node) {
+                        releasePending();
+                    }
+
+                    void StreamingParseListener::enterEveryRule(ParserRuleContext *ctx) {
+                        releasePending();
+                    }
+
+                    void StreamingParseListener::exitEveryRule(ParserRuleContext *ctx) {
+                        int depth = ctx->depth();
+                        if (depth < recordDepth) {
+                            releasePending();
+                            return;
+                        }
+                        if (depth > recordDepth) {
+                            return;
+                        }
+
+                        callback(ctx);
+
+                        // the rule that just ended is the last child of its parent
+                        ParserRuleContext *parent = ctx->getParent();
+                        if (parent != nullptr && !parent->children.empty() && parent->children.back() == ctx) {
+                            parent->removeLastChild();
+                        }
+                        pending.push_back(ctx);
+                    }
+
+                    void StreamingParseListener::releasePending() {
+                        for (ParserRuleContext *record : pending) {
+                            release(record);
+                        }
+                        pending.clear();
+                    }
+
+                    void StreamingParseListener::release(ParseTree *t) {
+                        ParserRuleContext *ctx = dynamic_cast<ParserRuleContext*>(t);
+                        if (ctx != nullptr) {
+                            for (ParseTree *child : ctx->children) {
+                                release(child);
+                            }
+                        }
+                        delete t;
+                    }
+
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <vector>
+#include <functional>
+
+#include "ParseTreeListener.h"
+#include "Declarations.h"
+
+/*
+ * [The "BSD license"]
+ *  Copyright (c) 2013 Terence Parr
+ *  Copyright (c) 2013 Dan McLaughlin
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  3. The name of the author may not be used to endorse or promote products
+ *     derived from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ *  IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ *  OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ *  IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ *  THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+namespace org {
+    namespace antlr {
+        namespace v4 {
+            namespace runtime {
+                namespace tree {
+
+                    /// <summary>
+                    /// A parse listener for record-oriented grammars (log lines, CSV rows and
+                    /// the like) that keeps memory proportional to one record instead of the
+                    /// whole input. Each rule context completed at {@code recordDepth} (by
+                    /// default the children of the start rule) is handed to the callback,
+                    /// then detached from its parent and deleted with its subtree.
+                    /// <p/>
+                    /// Install it with <seealso cref="Parser#addParseListener"/> while building parse
+                    /// trees, and read from an <seealso cref="UnbufferedTokenStream"/> so the tokens
+                    /// don't accumulate either. Tokens themselves are not deleted; they belong to
+                    /// the token factory.
+                    /// <p/>
+                    /// A record is deleted only once the parser has moved on (the next rule is
+                    /// entered, a token is matched, or an enclosing rule exits), so the
+                    /// generated code of the enclosing rule can still see the returned context.
+                    /// Enclosing rules must not keep labels on record contexts, as those
+                    /// would dangle. Record rules may be left-recursive: the parser adds a
+                    /// recursion context to its parent before its exit event, as it does for
+                    /// every other rule.
+                    /// </summary>
+                    class StreamingParseListener : public ParseTreeListener {
+                    public:
+                        typedef std::function<void(ParserRuleContext *record)> RecordCallback;
+
+                    protected:
+                        const RecordCallback callback;
+
+                        /// <summary>
+                        /// Depth of record contexts, counting the start rule's context as 1. </summary>
+                        const int recordDepth;
+
+                        /// <summary>
+                        /// Records handed to the callback and detached, but not yet deleted. </summary>
+                        std::vector<ParserRuleContext*> pending;
+
+                    public:
+                        StreamingParseListener(RecordCallback callback, int recordDepth = 2);
+
+                        /// <summary>
+                        /// Deletes any record still pending. </summary>
+                        virtual ~StreamingParseListener();
+
+                        virtual void visitTerminal(TerminalNode *node) override;
+                        virtual void visitErrorNode(ErrorNode *node) override;
+                        virtual void enterEveryRule(ParserRuleContext *ctx) override;
+                        virtual void exitEveryRule(ParserRuleContext *ctx) override;
+
+                        /// <summary>
+                        /// Deletes the records that were already handed to the callback. </summary>
+                        virtual void releasePending();
+
+                        /// <summary>
+                        /// Deletes {@code t} and everything below it. </summary>
+                        static void release(ParseTree *t);
+                    };
+
+                }
+            }
+        }
+    }
+}
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "Tree.h"
+#include "Interval.h"
 #include "Declarations.h"
 
 /*
@@ -37,10 +38,6 @@ namespace org {
     namespace antlr {
         namespace v4 {
             namespace runtime {
-                namespace misc {
-                    class Interval;
-                }
-                
                 namespace tree {
                     /// <summary>
                     /// A tree that knows about an interval in a token stream
@@ -57,7 +54,7 @@ namespace org {
                         /// If source interval is unknown, this returns <seealso cref="Interval#INVALID"/>.
                         /// </summary>
                     public:
-                        virtual misc::Interval *getSourceInterval() = 0;
+                        virtual misc::Interval getSourceInterval() = 0;
                     };
 
                 }
@@ -1,5 +1,5 @@
 ﻿#include "TerminalNodeImpl.h"
-#include "interval.h"
+#include "Interval.h"
 #include "Token.h"
 /*
  * [The "BSD license"]
@@ -58,13 +58,13 @@ namespace org {
                         return symbol;
                     }
 
-                    misc::Interval *TerminalNodeImpl::getSourceInterval() {
+                    misc::Interval TerminalNodeImpl::getSourceInterval() {
                         if (symbol == nullptr) {
                             return misc::Interval::INVALID;
                         }
 
                         int tokenIndex = symbol->getTokenIndex();
-                        return new misc::Interval(tokenIndex, tokenIndex);
+                        return misc::Interval(tokenIndex, tokenIndex);
                     }
 
                     int TerminalNodeImpl::getChildCount() {
@@ -53,7 +53,7 @@ namespace org {
                         virtual Token *getSymbol() override;
                         virtual ParseTree *getParent() override;
                         virtual void *getPayload() override; // returns "Token *"
-                        virtual misc::Interval *getSourceInterval() override;
+                        virtual misc::Interval getSourceInterval() override;
 
                         virtual int getChildCount() override;
                         
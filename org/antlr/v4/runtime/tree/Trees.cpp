@@ -8,6 +8,8 @@
 #include "Utils.h"
 #include "Tree.h"
 
+#include <sstream>
+
 /*
 * [The "BSD license"]
 *  Copyright (c) 2013 Terence Parr
@@ -79,23 +81,33 @@ namespace org {
                     }
 
                     std::wstring Trees::toStringTree(Tree *t, std::vector<std::wstring> &ruleNames) {
+                        std::wstringstream buf;
+                        toStringTree(t, ruleNames, buf);
+                        return buf.str();
+                    }
+
+                    void Trees::toStringTree(Tree *t, Parser *recog, std::wostream &out) {
+                        std::vector<std::wstring> ruleNames;
+                        if (recog != nullptr) {
+                            ruleNames = recog->getRuleNames();
+                        }
+                        toStringTree(t, ruleNames, out);
+                    }
+
+                    void Trees::toStringTree(Tree *t, std::vector<std::wstring> &ruleNames, std::wostream &out) {
                         std::wstring s = Utils::escapeWhitespace(getNodeText(t, ruleNames), false);
                         if (t->getChildCount() == 0) {
-                            return s;
+                            out << s;
+                            return;
                         }
-                        StringBuilder *buf = new StringBuilder();
-                        buf->append(L"(");
-                        s = Utils::escapeWhitespace(getNodeText(t, ruleNames), false);
-                        buf->append(s);
-                        buf->append(L' ');
+                        out << L"(" << s << L' ';
                         for (int i = 0; i < t->getChildCount(); i++) {
                             if (i > 0) {
-                                buf->append(L' ');
+                                out << L' ';
                             }
-                            buf->append(toStringTree(t->getChild(i), ruleNames));
+                            toStringTree(t->getChild(i), ruleNames, out);
                         }
-                        buf->append(L")");
-                        return buf->toString();
+                        out << L")";
                     }
                     
                     std::wstring Trees::getNodeText(Tree *t, Parser *recog) {
@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <iostream>
 #include "Declarations.h"
 
 /*
@@ -74,6 +75,15 @@ namespace org {
                         /// </summary>
                         static std::wstring toStringTree(Tree *t, std::vector<std::wstring> &ruleNames);
 
+                        /// <summary>
+                        /// Write a whole tree in LISP form to out as it is walked, without
+                        ///  building the string in memory.  A null recog prints payload text
+                        ///  only, like toStringTree(t).
+                        /// </summary>
+                        static void toStringTree(Tree *t, Parser *recog, std::wostream &out);
+
+                        static void toStringTree(Tree *t, std::vector<std::wstring> &ruleNames, std::wostream &out);
+
                         static std::wstring getNodeText(Tree *t, Parser *recog);
 
                         static std::wstring getNodeText(Tree *t, std::vector<std::wstring> &ruleNames);